@@ -19,70 +19,7 @@ layout (set = 1, binding = 1) uniform texture2D normalsBuffer;
 layout (set = 1, binding = 2) uniform texture2D metallicRoughnessBuffer;
 layout (set = 1, binding = 3) uniform texture2D depthBuffer; // For reconstructing world space positions
 
-vec3 calculateDirectionalLightContribution(vec3 diffuseTexColor, vec2 metallicRoughnessColor, vec3 sampledNormal, vec3 fragWorldPos)
-{
-    vec3 lightColor = vec3(pushConstants.sceneData.directionalLight.power); // TODO: Directional light color?
-
-    // Ambient
-    float ambientStrength = 0.1;
-    vec3 ambient = diffuseTexColor * ambientStrength * lightColor;
-
-    // Diffuse
-    vec3 fragToLightDir = normalize(-pushConstants.sceneData.directionalLight.direction);
-    vec3 norm = normalize(sampledNormal);
-    float difference = max(dot(fragToLightDir, norm), 0.0);
-    vec3 diffuse = diffuseTexColor * difference * lightColor;
-
-
-    // Specular
-    float specularStrength = 0.5;
-    vec3 viewDir = normalize(pushConstants.sceneData.cameraWorldPosition.xyz - fragWorldPos);
-    vec3 reflectDir = reflect(-fragToLightDir, norm);
-    float specularDifference = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-    vec3 specular = specularStrength * specularDifference * lightColor;
-
-    vec3 result = (ambient + diffuse + specular);
-    return result;
-}
-
-vec3 calculatePointLightsContribution(int pointLightIndex, vec3 diffuseTexColor, vec2 metallicRoughnessColor, vec3 sampledNormal, vec3 fragWorldPos)
-{
-    vec3 lightColor = pushConstants.sceneData.pointLights.data[pointLightIndex].color;
-
-    // Ambient
-    float ambientStrength = 0.1;
-    vec3 ambient = diffuseTexColor * ambientStrength * lightColor;
-
-    // Diffuse
-    vec3 fragToLightDir = normalize(pushConstants.sceneData.pointLights.data[pointLightIndex].worldSpacePosition - fragWorldPos);
-    vec3 norm = normalize(sampledNormal);
-    float difference = max(dot(fragToLightDir, norm), 0.0);
-    vec3 diffuse = diffuseTexColor * difference * lightColor;
-
-
-    // Specular
-    float specularStrength = 0.5;
-    vec3 viewDir = normalize(pushConstants.sceneData.cameraWorldPosition.xyz - fragWorldPos);
-    vec3 reflectDir = reflect(-fragToLightDir, norm);
-    float specularDifference = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-    vec3 specular = specularStrength * specularDifference * lightColor;
-
-    float distance = length(pushConstants.sceneData.pointLights.data[pointLightIndex].worldSpacePosition - fragWorldPos);
-
-    float attenuation = 1.0 / (
-        pushConstants.sceneData.pointLights.data[pointLightIndex].constantAttenuation + 
-        pushConstants.sceneData.pointLights.data[pointLightIndex].linearAttenuation * distance + 
-        pushConstants.sceneData.pointLights.data[pointLightIndex].quadraticAttenuation * distance * distance
-    );
-
-    ambient  *= attenuation;
-    diffuse  *= attenuation;
-    specular *= attenuation;
-
-    vec3 result = (ambient + diffuse + specular);
-    return result;
-}
-
+#include "blinn_phong.glsl"
 
 void main() {
     // Sample GBuffer
@@ -99,11 +36,12 @@ void main() {
 
     vec3 result = vec3(0.0);
 
-    result += calculateDirectionalLightContribution(sampledColor, sampledMetallicRoughness, sampledNormal, fragWorldPos.xyz);
+    vec3 cameraWorldPosition = pushConstants.sceneData.cameraWorldPosition;
+    result += calculateDirectionalLightContribution(pushConstants.sceneData.directionalLight, cameraWorldPosition, sampledColor, sampledMetallicRoughness, sampledNormal, fragWorldPos.xyz);
 
     for (int i = 0; i < pushConstants.sceneData.numPointLights; i++)
     {
-        result += calculatePointLightsContribution(i, sampledColor, sampledMetallicRoughness, sampledNormal, fragWorldPos.xyz);
+        result += calculatePointLightContribution(pushConstants.sceneData.pointLights.data[i], cameraWorldPosition, sampledColor, sampledMetallicRoughness, sampledNormal, fragWorldPos.xyz);
     }
 
     outColor = vec4(result, 1.0);
@@ -0,0 +1,72 @@
+#ifndef BLINN_PHONG_GLSL
+#define BLINN_PHONG_GLSL
+
+#include "scene_data.glsl"
+
+// Shared by the fullscreen (blinn-phong.frag) and tiled compute (tiled_lighting.comp) lighting paths
+
+vec3 calculateDirectionalLightContribution(DirectionalLight directionalLight, vec3 cameraWorldPosition, vec3 diffuseTexColor, vec2 metallicRoughnessColor, vec3 sampledNormal, vec3 fragWorldPos)
+{
+    vec3 lightColor = vec3(directionalLight.power); // TODO: Directional light color?
+
+    // Ambient
+    float ambientStrength = 0.1;
+    vec3 ambient = diffuseTexColor * ambientStrength * lightColor;
+
+    // Diffuse
+    vec3 fragToLightDir = normalize(-directionalLight.direction);
+    vec3 norm = normalize(sampledNormal);
+    float difference = max(dot(fragToLightDir, norm), 0.0);
+    vec3 diffuse = diffuseTexColor * difference * lightColor;
+
+
+    // Specular
+    float specularStrength = 0.5;
+    vec3 viewDir = normalize(cameraWorldPosition - fragWorldPos);
+    vec3 reflectDir = reflect(-fragToLightDir, norm);
+    float specularDifference = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+    vec3 specular = specularStrength * specularDifference * lightColor;
+
+    vec3 result = (ambient + diffuse + specular);
+    return result;
+}
+
+vec3 calculatePointLightContribution(PointLight pointLight, vec3 cameraWorldPosition, vec3 diffuseTexColor, vec2 metallicRoughnessColor, vec3 sampledNormal, vec3 fragWorldPos)
+{
+    vec3 lightColor = pointLight.color;
+
+    // Ambient
+    float ambientStrength = 0.1;
+    vec3 ambient = diffuseTexColor * ambientStrength * lightColor;
+
+    // Diffuse
+    vec3 fragToLightDir = normalize(pointLight.worldSpacePosition - fragWorldPos);
+    vec3 norm = normalize(sampledNormal);
+    float difference = max(dot(fragToLightDir, norm), 0.0);
+    vec3 diffuse = diffuseTexColor * difference * lightColor;
+
+
+    // Specular
+    float specularStrength = 0.5;
+    vec3 viewDir = normalize(cameraWorldPosition - fragWorldPos);
+    vec3 reflectDir = reflect(-fragToLightDir, norm);
+    float specularDifference = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+    vec3 specular = specularStrength * specularDifference * lightColor;
+
+    float distance = length(pointLight.worldSpacePosition - fragWorldPos);
+
+    float attenuation = 1.0 / (
+        pointLight.constantAttenuation + 
+        pointLight.linearAttenuation * distance + 
+        pointLight.quadraticAttenuation * distance * distance
+    );
+
+    ambient  *= attenuation;
+    diffuse  *= attenuation;
+    specular *= attenuation;
+
+    vec3 result = (ambient + diffuse + specular);
+    return result;
+}
+
+#endif // BLINN_PHONG_GLSL
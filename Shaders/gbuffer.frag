@@ -8,6 +8,7 @@ layout(location = 0) in vec3 fragWorldPos;
 layout(location = 1) in vec3 fragWorldNormal;
 layout(location = 2) in vec2 textureCoords;
 layout(location = 3) in vec4 fragColor;
+layout(location = 4) flat in uint fragMaterialId;
 
 layout(location = 0) out vec4 outColor;
 layout(location = 1) out vec3 outNormal;
@@ -23,7 +24,7 @@ layout (set = 0, binding = 1) uniform texture2D textures[];
 
 void main() {
     // Sample texture(s)
-    MaterialData materialData = pushConstants.sceneData.materials.data[pushConstants.materialId];
+    MaterialData materialData = pushConstants.sceneData.materials.data[fragMaterialId];
 #if DEBUG_VERTEX_COLORS
     vec3 diffuseTexColor = fragColor.rgb;
 #else
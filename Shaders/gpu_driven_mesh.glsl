@@ -0,0 +1,31 @@
+#ifndef GPU_DRIVEN_MESH_GLSL
+#define GPU_DRIVEN_MESH_GLSL
+
+// Shared by gpu_driven_mesh.vert and gpu_driven_mesh_compact.vert
+
+#include "scene_data.glsl"
+#include "object_data.glsl"
+#include "vertex_input.glsl"
+
+layout (location = 0) out vec3 fragWorldPos;
+layout (location = 1) out vec3 fragWorldNormal;
+layout (location = 2) out vec2 textureCoords;
+layout (location = 3) out vec4 fragColor;
+layout (location = 4) flat out uint fragMaterialId;
+
+#include "mesh_push_constants.glsl"
+
+void main() {
+    // Culling puts the object index in firstInstance
+    ObjectData object = pushConstants.objects.data[gl_InstanceIndex];
+    // The object's bounds are the mesh's, which compact positions are quantized across
+    vec3 position = vertex_position(object.boundsMin, object.boundsMax - object.boundsMin);
+    fragWorldPos = vec3(object.model * vec4(position, 1.0));
+    fragWorldNormal = mat3(transpose(inverse(object.model))) * vertex_normal();
+    textureCoords = vertex_uv();
+    fragColor = vertex_color();
+    fragMaterialId = object.materialId;
+    gl_Position = pushConstants.sceneData.projection * pushConstants.sceneData.view * vec4(fragWorldPos, 1.0);
+}
+
+#endif // GPU_DRIVEN_MESH_GLSL
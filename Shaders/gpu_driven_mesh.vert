@@ -0,0 +1,5 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+#include "gpu_driven_mesh.glsl"
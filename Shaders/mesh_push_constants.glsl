@@ -2,13 +2,21 @@
 #define MESH_PUSH_CONSTANTS_GLSL
 
 #include "scene_data.glsl"
+#include "object_data.glsl"
+
+layout (buffer_reference, scalar) readonly buffer InstanceTransformBuffer {
+    mat4 transforms[];
+};
 
 // Push constants block
 layout (push_constant) uniform PushConstants
 {
-    mat4 modelMatrix;
     SceneDataBuffer sceneData;
     uint materialId;
+    ObjectDataBuffer objects; // GPU driven draws only, which take the model matrix and materialId from here instead
+    InstanceTransformBuffer instances; // CPU driven draws only, one model matrix per instance
+    vec4 positionDequantOffset; // Compact vertices only, position = offset + unorm * scale
+    vec4 positionDequantScale;
 } pushConstants;
 
 
@@ -0,0 +1,26 @@
+#ifndef OBJECT_DATA_GLSL
+#define OBJECT_DATA_GLSL
+
+#extension GL_EXT_scalar_block_layout: require
+#extension GL_EXT_buffer_reference : require
+
+// Matches GPUObjectData in GPUScene.h
+struct ObjectData {
+    mat4 model;
+    vec3 boundsMin;
+    uint firstIndex;
+    vec3 boundsMax;
+    uint indexCount;
+    int vertexOffset;
+    uint materialId;
+    uint pageIndex;
+    uint pageFirstDraw;
+    uint drawSlot;
+    uint padding[3];
+};
+
+layout (buffer_reference, scalar) readonly buffer ObjectDataBuffer {
+    ObjectData data[];
+};
+
+#endif // OBJECT_DATA_GLSL
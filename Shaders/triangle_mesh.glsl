@@ -0,0 +1,29 @@
+#ifndef TRIANGLE_MESH_GLSL
+#define TRIANGLE_MESH_GLSL
+
+// Shared by triangle_mesh.vert and triangle_mesh_compact.vert
+
+#include "scene_data.glsl"
+#include "vertex_input.glsl"
+
+layout (location = 0) out vec3 fragWorldPos;
+layout (location = 1) out vec3 fragWorldNormal;
+layout (location = 2) out vec2 textureCoords;
+layout (location = 3) out vec4 fragColor;
+layout (location = 4) flat out uint fragMaterialId;
+
+#include "mesh_push_constants.glsl"
+
+void main() {
+    vec3 position = vertex_position(pushConstants.positionDequantOffset.xyz, pushConstants.positionDequantScale.xyz);
+    // firstInstance of each draw points at its batch's first transform
+    mat4 model = pushConstants.instances.transforms[gl_InstanceIndex];
+    fragWorldPos = vec3(model * vec4(position, 1.0));
+    fragWorldNormal = mat3(transpose(inverse(model))) * vertex_normal();
+    textureCoords = vertex_uv();
+    fragColor = vertex_color();
+    fragMaterialId = pushConstants.materialId;
+    gl_Position = pushConstants.sceneData.projection * pushConstants.sceneData.view * vec4(fragWorldPos, 1.0);
+}
+
+#endif // TRIANGLE_MESH_GLSL
@@ -0,0 +1,63 @@
+#ifndef VERTEX_INPUT_GLSL
+#define VERTEX_INPUT_GLSL
+
+// Vertex attributes for either vertex format, define COMPACT_VERTEX before including for CompactVertex (see Vertex.h)
+#if COMPACT_VERTEX
+
+layout (location = 0) in vec4 vPosition; // unorm16 across the mesh's AABB
+layout (location = 1) in vec2 vNormal; // Octahedral
+layout (location = 2) in vec4 vTangent; // xy octahedral, w bitangent sign
+layout (location = 3) in vec2 vUV;
+
+vec3 octahedral_decode(vec2 encoded) {
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.0);
+    direction.x += direction.x >= 0.0 ? -fold : fold;
+    direction.y += direction.y >= 0.0 ? -fold : fold;
+    return normalize(direction);
+}
+
+vec3 vertex_position(vec3 dequantOffset, vec3 dequantScale) {
+    return dequantOffset + vPosition.xyz * dequantScale;
+}
+
+vec3 vertex_normal() {
+    return octahedral_decode(vNormal);
+}
+
+vec2 vertex_uv() {
+    return vUV;
+}
+
+vec4 vertex_color() {
+    return vec4(1.0);
+}
+
+#else
+
+layout (location = 0) in vec3 vPosition;
+layout (location = 1) in float uv_x;
+layout (location = 2) in vec3 vNormal;
+layout (location = 3) in float uv_y;
+layout (location = 4) in vec3 vTangent;
+layout (location = 5) in vec4 vColor;
+
+vec3 vertex_position(vec3 dequantOffset, vec3 dequantScale) {
+    return vPosition;
+}
+
+vec3 vertex_normal() {
+    return vNormal;
+}
+
+vec2 vertex_uv() {
+    return vec2(uv_x, uv_y);
+}
+
+vec4 vertex_color() {
+    return vColor;
+}
+
+#endif // COMPACT_VERTEX
+
+#endif // VERTEX_INPUT_GLSL
@@ -104,6 +104,14 @@ void Camera::unfreeze_camera()
     m_bAllowMovement = true;
 }
 
+void Camera::set_pose(glm::vec3 position, float yaw, float pitch)
+{
+    m_position = position;
+    m_yaw = yaw;
+    m_pitch = pitch;
+    update_camera_vectors();
+}
+
 
 void Camera::update_camera_vectors()
 {
@@ -41,6 +41,9 @@ public:
 
 	void unfreeze_camera();
 
+	/* Places the camera directly, ignoring freeze_camera(), for scripted paths */
+	void set_pose(glm::vec3 position, float yaw, float pitch);
+
 private:
 	void update_camera_vectors();
 };
\ No newline at end of file
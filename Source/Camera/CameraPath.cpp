@@ -0,0 +1,52 @@
+#include "CameraPath.h"
+#include <algorithm>
+#include <utility>
+
+// Uniform Catmull-Rom between p1 (t = 0) and p2 (t = 1)
+static glm::vec3 catmull_rom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t) {
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1)
+        + (p2 - p0) * t
+        + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2
+        + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+CameraPath::CameraPath(std::vector<CameraKeyframe> _keyframes) : m_keyframes(std::move(_keyframes)) {}
+
+[[nodiscard]] CameraKeyframe CameraPath::sample(float timeSeconds) const {
+    if (m_keyframes.empty())
+    {
+        return {timeSeconds, glm::vec3(0.0f), 0.0f, 0.0f};
+    }
+    if (timeSeconds <= m_keyframes.front().timeSeconds)
+    {
+        return m_keyframes.front();
+    }
+    if (timeSeconds >= m_keyframes.back().timeSeconds)
+    {
+        return m_keyframes.back();
+    }
+
+    // First keyframe after timeSeconds, the two checks above keep it in [1, size - 1]
+    const auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), timeSeconds,
+        [](float time, const CameraKeyframe& keyframe) { return time < keyframe.timeSeconds; });
+    const size_t i2 = static_cast<size_t>(next - m_keyframes.begin());
+    const size_t i1 = i2 - 1;
+    const size_t i0 = i1 > 0 ? i1 - 1 : i1;
+    const size_t i3 = std::min(i2 + 1, m_keyframes.size() - 1);
+
+    const CameraKeyframe& k1 = m_keyframes[i1];
+    const CameraKeyframe& k2 = m_keyframes[i2];
+    const float t = (timeSeconds - k1.timeSeconds) / (k2.timeSeconds - k1.timeSeconds);
+    return {
+        .timeSeconds = timeSeconds,
+        .position = catmull_rom(m_keyframes[i0].position, k1.position, k2.position, m_keyframes[i3].position, t),
+        .yaw = k1.yaw + (k2.yaw - k1.yaw) * t,
+        .pitch = k1.pitch + (k2.pitch - k1.pitch) * t
+    };
+}
+
+[[nodiscard]] float CameraPath::get_duration() const {
+    return m_keyframes.empty() ? 0.0f : m_keyframes.back().timeSeconds - m_keyframes.front().timeSeconds;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+/* Yaw and pitch in degrees like Camera, yaw isn't wrapped so consecutive keyframes can turn past 360 */
+struct CameraKeyframe {
+    float timeSeconds;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+/*
+ * Scripted camera motion through keyframes sorted by time. Positions follow a Catmull-Rom spline through every keyframe
+ * (the end keyframes are repeated as their own neighbours), yaw and pitch are interpolated linearly.
+ * Sampling only depends on the time passed in, so replaying the same times gives the same views.
+ */
+class CameraPath
+{
+public:
+    explicit CameraPath(std::vector<CameraKeyframe> _keyframes);
+
+    /* Clamped to the first and last keyframes outside the path's duration */
+    [[nodiscard]] CameraKeyframe sample(float timeSeconds) const;
+    [[nodiscard]] float get_duration() const;
+
+private:
+    std::vector<CameraKeyframe> m_keyframes;
+};
@@ -0,0 +1,18 @@
+#include "Frustum.h"
+
+[[nodiscard]] Frustum extract_frustum(const glm::mat4& viewProjection) {
+    // glm is column major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const glm::mat4 rows = glm::transpose(viewProjection);
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0];
+    frustum.planes[1] = rows[3] - rows[0];
+    frustum.planes[2] = rows[3] + rows[1];
+    frustum.planes[3] = rows[3] - rows[1];
+    frustum.planes[4] = rows[2]; // Depth is [0, 1] rather than [-1, 1], so near is just the third row
+    frustum.planes[5] = rows[3] - rows[2];
+    for (glm::vec4& plane : frustum.planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
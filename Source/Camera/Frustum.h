@@ -0,0 +1,12 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <array>
+
+/* Six inward facing planes (xyz = normal, w = distance), a point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0 */
+struct Frustum {
+    std::array<glm::vec4, 6> planes; // Left, right, bottom, top, near, far
+};
+
+/* Gribb/Hartmann plane extraction from a view projection matrix with a [0, 1] depth range, the planes are in world space */
+[[nodiscard]] Frustum extract_frustum(const glm::mat4& viewProjection);
+
@@ -0,0 +1,83 @@
+#include "FrustumCull.h"
+#include <Camera/Frustum.h>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MR_FRUSTUM_CULL_SSE 1
+#include <emmintrin.h>
+#endif
+
+void CullBounds::resize(uint32_t boxCount) {
+    const size_t paddedCount = (boxCount + FRUSTUM_CULL_BATCH_SIZE - 1) / FRUSTUM_CULL_BATCH_SIZE * FRUSTUM_CULL_BATCH_SIZE;
+    centerX.resize(paddedCount, 0.0f);
+    centerY.resize(paddedCount, 0.0f);
+    centerZ.resize(paddedCount, 0.0f);
+    extentX.resize(paddedCount, 0.0f);
+    extentY.resize(paddedCount, 0.0f);
+    extentZ.resize(paddedCount, 0.0f);
+    count = boxCount;
+}
+
+void CullBounds::set(uint32_t index, const glm::mat4& transform, const glm::vec3& localBoundsMin, const glm::vec3& localBoundsMax) {
+    const glm::vec3 localCenter = (localBoundsMin + localBoundsMax) * 0.5f;
+    const glm::vec3 localExtents = (localBoundsMax - localBoundsMin) * 0.5f;
+    const glm::vec3 center = glm::vec3(transform * glm::vec4(localCenter, 1.0f));
+    const glm::mat3 absolute(glm::abs(glm::vec3(transform[0])), glm::abs(glm::vec3(transform[1])), glm::abs(glm::vec3(transform[2])));
+    const glm::vec3 extents = absolute * localExtents;
+
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    extentX[index] = extents.x;
+    extentY[index] = extents.y;
+    extentZ[index] = extents.z;
+}
+
+void frustum_cull(const Frustum& frustum, const CullBounds& bounds, std::vector<uint32_t>& visibleIndices) {
+    visibleIndices.clear();
+    for (uint32_t first = 0; first < bounds.count; first += FRUSTUM_CULL_BATCH_SIZE)
+    {
+        // Bit i set when box first + i is inside or intersecting every plane
+        uint32_t insideMask = 0;
+#ifdef MR_FRUSTUM_CULL_SSE
+        const __m128 centerX = _mm_loadu_ps(&bounds.centerX[first]);
+        const __m128 centerY = _mm_loadu_ps(&bounds.centerY[first]);
+        const __m128 centerZ = _mm_loadu_ps(&bounds.centerZ[first]);
+        const __m128 extentX = _mm_loadu_ps(&bounds.extentX[first]);
+        const __m128 extentY = _mm_loadu_ps(&bounds.extentY[first]);
+        const __m128 extentZ = _mm_loadu_ps(&bounds.extentZ[first]);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& plane : frustum.planes)
+        {
+            __m128 planeDistance = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+            planeDistance = _mm_add_ps(planeDistance, _mm_mul_ps(centerY, _mm_set1_ps(plane.y)));
+            planeDistance = _mm_add_ps(planeDistance, _mm_mul_ps(centerZ, _mm_set1_ps(plane.z)));
+            __m128 radius = _mm_mul_ps(extentX, _mm_set1_ps(std::abs(plane.x)));
+            radius = _mm_add_ps(radius, _mm_mul_ps(extentY, _mm_set1_ps(std::abs(plane.y))));
+            radius = _mm_add_ps(radius, _mm_mul_ps(extentZ, _mm_set1_ps(std::abs(plane.z))));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(planeDistance, radius), _mm_setzero_ps()));
+        }
+        insideMask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+#else
+        for (uint32_t lane = 0; lane < FRUSTUM_CULL_BATCH_SIZE; lane++)
+        {
+            const uint32_t i = first + lane;
+            bool bInside = true;
+            for (const glm::vec4& plane : frustum.planes)
+            {
+                const float planeDistance = plane.x * bounds.centerX[i] + plane.y * bounds.centerY[i] + plane.z * bounds.centerZ[i] + plane.w;
+                const float radius = std::abs(plane.x) * bounds.extentX[i] + std::abs(plane.y) * bounds.extentY[i] + std::abs(plane.z) * bounds.extentZ[i];
+                bInside = bInside && (planeDistance + radius >= 0.0f);
+            }
+            insideMask |= bInside ? (1u << lane) : 0u;
+        }
+#endif
+        for (uint32_t lane = 0; lane < FRUSTUM_CULL_BATCH_SIZE && first + lane < bounds.count; lane++)
+        {
+            if (insideMask & (1u << lane))
+            {
+                visibleIndices.push_back(first + lane);
+            }
+        }
+    }
+}
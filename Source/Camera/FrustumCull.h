@@ -0,0 +1,29 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+struct Frustum;
+
+inline constexpr size_t FRUSTUM_CULL_BATCH_SIZE = 4; // Boxes tested per SSE iteration
+
+/*
+ * World space AABBs as centers and half extents in structure of arrays form, so frustum_cull() can test 4 boxes at a time with SSE (scalar elsewhere).
+ * Each array is padded with empty boxes to a multiple of FRUSTUM_CULL_BATCH_SIZE.
+ */
+struct CullBounds {
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+    uint32_t count{0};
+
+    void resize(uint32_t boxCount);
+    /* Transform a local space AABB into world space, exact for the center and conservative for the extents (Arvo) */
+    void set(uint32_t index, const glm::mat4& transform, const glm::vec3& localBoundsMin, const glm::vec3& localBoundsMax);
+};
+
+/* Replaces the contents of visibleIndices with the index of every box inside or intersecting all six planes */
+void frustum_cull(const Frustum& frustum, const CullBounds& bounds, std::vector<uint32_t>& visibleIndices);
@@ -0,0 +1,58 @@
+#include "ChunkedLinearAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+ChunkedLinearAllocator::ChunkedLinearAllocator(uint64_t _chunkSize) : m_chunkSize(_chunkSize) {
+    m_chunkSizes.push_back(m_chunkSize);
+}
+
+void ChunkedLinearAllocator::reset() {
+    m_currentChunk = 0;
+    m_head = 0;
+    m_bytesUsed = 0;
+}
+
+[[nodiscard]] ChunkedAllocation ChunkedLinearAllocator::allocate(uint64_t size, uint64_t alignment) {
+    assert(size > 0);
+    assert((alignment & (alignment - 1)) == 0);
+
+    uint64_t offset = (m_head + alignment - 1) & ~(alignment - 1);
+    while (m_currentChunk == m_chunkSizes.size() || offset + size > m_chunkSizes[m_currentChunk])
+    {
+        // Move on to the next chunk, growing the list if nothing has needed this much before
+        if (m_currentChunk < m_chunkSizes.size())
+        {
+            m_currentChunk++;
+        }
+        if (m_currentChunk == m_chunkSizes.size())
+        {
+            m_chunkSizes.push_back(std::max(m_chunkSize, size));
+        }
+        offset = 0;
+    }
+
+    m_head = offset + size;
+    m_bytesUsed += size;
+    return {m_currentChunk, offset};
+}
+
+[[nodiscard]] uint32_t ChunkedLinearAllocator::get_chunk_count() const {
+    return static_cast<uint32_t>(m_chunkSizes.size());
+}
+
+[[nodiscard]] uint64_t ChunkedLinearAllocator::get_chunk_size(uint32_t chunkIndex) const {
+    return m_chunkSizes[chunkIndex];
+}
+
+[[nodiscard]] uint64_t ChunkedLinearAllocator::get_bytes_used() const {
+    return m_bytesUsed;
+}
+
+[[nodiscard]] uint64_t ChunkedLinearAllocator::get_bytes_reserved() const {
+    uint64_t total = 0;
+    for (const uint64_t chunkSize : m_chunkSizes)
+    {
+        total += chunkSize;
+    }
+    return total;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct ChunkedAllocation {
+    uint32_t chunkIndex;
+    uint64_t offset; // In bytes from the start of the chunk
+};
+
+/*
+ * Bump allocates from a list of chunks, moving on to the next chunk when the current one is full and appending a new one when the list runs out.
+ * reset() rewinds to the first chunk but keeps them all, so the list grows to the high water mark and then stays put.
+ * Like RangeAllocator no memory is owned here, the caller backs each chunk (e.g. FrameAllocator with a mapped buffer per chunk).
+ */
+class ChunkedLinearAllocator
+{
+public:
+    ChunkedLinearAllocator() = default;
+    /* Starts out with a single chunk of chunkSize bytes */
+    explicit ChunkedLinearAllocator(uint64_t _chunkSize);
+
+    void reset();
+    /* Requests larger than the chunk size get a chunk of their own, alignment must be a power of two */
+    [[nodiscard]] ChunkedAllocation allocate(uint64_t size, uint64_t alignment);
+
+    [[nodiscard]] uint32_t get_chunk_count() const;
+    [[nodiscard]] uint64_t get_chunk_size(uint32_t chunkIndex) const;
+    [[nodiscard]] uint64_t get_bytes_used() const;
+    [[nodiscard]] uint64_t get_bytes_reserved() const;
+
+private:
+    std::vector<uint64_t> m_chunkSizes;
+    uint64_t m_chunkSize{0};
+    uint32_t m_currentChunk{0};
+    uint64_t m_head{0};
+    uint64_t m_bytesUsed{0};
+};
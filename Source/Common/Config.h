@@ -9,4 +9,6 @@ inline constexpr uint32_t WINDOW_HEIGHT = 1200;
 inline constexpr uint32_t WINDOW_WIDTH = 1500;
 inline constexpr uint32_t WINDOW_HEIGHT = 800;
 #endif
-inline constexpr int MAX_FRAMES_IN_FLIGHT = 2;
\ No newline at end of file
+inline constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+inline constexpr size_t UPLOAD_STAGING_BUFFER_SIZE = 64 * 1024 * 1024; // Bytes, uploads larger than this get a dedicated staging buffer
+inline constexpr size_t FRAME_ALLOCATOR_CHUNK_SIZE = 4 * 1024 * 1024; // Bytes per frame in flight, grows by more chunks if exceeded
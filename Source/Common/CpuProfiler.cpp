@@ -0,0 +1,182 @@
+#include "CpuProfiler.h"
+#include <Common/Log.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+// Names are literals or pass names, but a stray quote or backslash would still break the whole file
+static std::string escape_json(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+// Complete ("X") event, Chrome traces are in microseconds
+static void write_trace_event(std::ofstream& file, bool& bFirstEvent, const std::string& name, uint32_t pid, uint32_t tid, int64_t startNs, int64_t endNs, int64_t baseNs) {
+    file << (bFirstEvent ? "\n" : ",\n");
+    bFirstEvent = false;
+    file << "{\"name\":\"" << escape_json(name) << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+        << ",\"ts\":" << static_cast<double>(startNs - baseNs) / 1000.0
+        << ",\"dur\":" << static_cast<double>(endNs - startNs) / 1000.0 << "}";
+}
+
+// Metadata ("M") event naming a process or thread track
+static void write_name_event(std::ofstream& file, bool& bFirstEvent, const char* metadataName, const std::string& name, uint32_t pid, uint32_t tid) {
+    file << (bFirstEvent ? "\n" : ",\n");
+    bFirstEvent = false;
+    file << "{\"name\":\"" << metadataName << "\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid
+        << ",\"args\":{\"name\":\"" << escape_json(name) << "\"}}";
+}
+
+[[nodiscard]] CpuProfiler& CpuProfiler::get() {
+    static CpuProfiler profiler;
+    return profiler;
+}
+
+[[nodiscard]] int64_t CpuProfiler::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CpuProfiler::begin_capture(double durationSeconds) {
+    {
+        std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+        for (std::unique_ptr<ThreadBuffer>& threadBuffer : m_threadBuffers)
+        {
+            threadBuffer->eventCount.store(0, std::memory_order_relaxed);
+        }
+    }
+    m_captureStartNs = now_ns();
+    m_captureDurationNs = static_cast<int64_t>(durationSeconds * 1e9);
+    m_bCapturing.store(true, std::memory_order_release);
+    if (durationSeconds > 0.0)
+    {
+        MRLOG("Capturing a " << durationSeconds << "s profiler trace");
+    }
+}
+
+[[nodiscard]] bool CpuProfiler::is_capturing() const {
+    return m_bCapturing.load(std::memory_order_relaxed);
+}
+
+[[nodiscard]] bool CpuProfiler::is_capture_due() const {
+    return is_capturing() && m_captureDurationNs > 0 && now_ns() - m_captureStartNs >= m_captureDurationNs;
+}
+
+[[nodiscard]] bool CpuProfiler::end_capture(const std::filesystem::path& path, std::span<const ProfilerTrack> extraTracks) {
+    m_bCapturing.store(false, std::memory_order_relaxed);
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        MRWARN("Failed to open " << path.string() << " for writing");
+        return false;
+    }
+
+    constexpr uint32_t CPU_PID = 1;
+    size_t eventCount = 0;
+    bool bFirstEvent = true;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    write_name_event(file, bFirstEvent, "process_name", "CPU", CPU_PID, 0);
+    {
+        std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+        for (std::unique_ptr<ThreadBuffer>& threadBuffer : m_threadBuffers)
+        {
+            write_name_event(file, bFirstEvent, "thread_name", threadBuffer->threadName, CPU_PID, threadBuffer->threadIndex);
+            const uint32_t threadEventCount = threadBuffer->eventCount.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < threadEventCount; i++)
+            {
+                const Event& event = threadBuffer->events[i];
+                write_trace_event(file, bFirstEvent, event.name, CPU_PID, threadBuffer->threadIndex, event.startNs, event.endNs, m_captureStartNs);
+            }
+            eventCount += threadEventCount;
+            if (threadEventCount == CPU_PROFILER_EVENTS_PER_THREAD)
+            {
+                MRWARN("Profiler thread \"" << threadBuffer->threadName << "\" ran out of room, later zones were dropped");
+            }
+            threadBuffer->eventCount.store(0, std::memory_order_relaxed);
+        }
+    }
+    for (size_t i = 0; i < extraTracks.size(); i++)
+    {
+        const uint32_t pid = CPU_PID + 1 + static_cast<uint32_t>(i);
+        write_name_event(file, bFirstEvent, "process_name", extraTracks[i].name, pid, 0);
+        for (const ProfilerTrackEvent& event : extraTracks[i].events)
+        {
+            if (event.startNs < m_captureStartNs)
+            {
+                continue;
+            }
+            write_trace_event(file, bFirstEvent, event.name, pid, 0, event.startNs, event.endNs, m_captureStartNs);
+        }
+        eventCount += extraTracks[i].events.size();
+    }
+    file << "\n]}\n";
+
+    MRLOG("Wrote " << eventCount << " profiler events to " << path.string());
+    return file.good();
+}
+
+void CpuProfiler::set_thread_name(const std::string& name) {
+    ThreadBuffer& threadBuffer = get_thread_buffer();
+    std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+    threadBuffer.threadName = name;
+}
+
+void CpuProfiler::record(const char* name, int64_t startNs, int64_t endNs) {
+    if (!m_bCapturing.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    ThreadBuffer& threadBuffer = get_thread_buffer();
+    // Only this thread writes its buffer, the release store publishes the event to end_capture()
+    const uint32_t eventIndex = threadBuffer.eventCount.load(std::memory_order_relaxed);
+    if (eventIndex >= CPU_PROFILER_EVENTS_PER_THREAD)
+    {
+        return;
+    }
+    if (!threadBuffer.events)
+    {
+        // Allocated on first use, threads that never record during a capture cost nothing
+        threadBuffer.events = std::make_unique<Event[]>(CPU_PROFILER_EVENTS_PER_THREAD);
+    }
+    threadBuffer.events[eventIndex] = {name, startNs, endNs};
+    threadBuffer.eventCount.store(eventIndex + 1, std::memory_order_release);
+}
+
+[[nodiscard]] CpuProfiler::ThreadBuffer& CpuProfiler::get_thread_buffer() {
+    thread_local ThreadBuffer* t_pThreadBuffer = nullptr;
+    if (!t_pThreadBuffer)
+    {
+        std::lock_guard<std::mutex> lock(m_threadBuffersMutex);
+        std::unique_ptr<ThreadBuffer>& threadBuffer = m_threadBuffers.emplace_back(std::make_unique<ThreadBuffer>());
+        threadBuffer->threadIndex = static_cast<uint32_t>(m_threadBuffers.size());
+        threadBuffer->threadName = "Thread " + std::to_string(threadBuffer->threadIndex);
+        t_pThreadBuffer = threadBuffer.get();
+    }
+    return *t_pThreadBuffer;
+}
+
+CpuProfileZone::CpuProfileZone(const char* name)
+    : m_name(name)
+    , m_bActive(CpuProfiler::get().is_capturing())
+    {
+        if (m_bActive)
+        {
+            m_startNs = CpuProfiler::now_ns();
+        }
+    }
+
+CpuProfileZone::~CpuProfileZone() {
+    if (m_bActive)
+    {
+        CpuProfiler::get().record(m_name, m_startNs, CpuProfiler::now_ns());
+    }
+}
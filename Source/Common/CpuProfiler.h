@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#define MR_PROFILE_CONCAT_INNER(a, b) a##b
+#define MR_PROFILE_CONCAT(a, b) MR_PROFILE_CONCAT_INNER(a, b)
+/* Times the rest of the enclosing scope on this thread's track, name must outlive the capture (a string literal) since only the pointer is kept */
+#define MR_PROFILE_ZONE(name) CpuProfileZone MR_PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+inline constexpr uint32_t CPU_PROFILER_EVENTS_PER_THREAD = 64 * 1024; // Later zones are dropped until the next capture
+
+/* Zone on a timeline recorded elsewhere (e.g. GPU timestamps), already converted to CpuProfiler::now_ns() time */
+struct ProfilerTrackEvent {
+    std::string name;
+    int64_t startNs;
+    int64_t endNs;
+};
+
+struct ProfilerTrack {
+    std::string name;
+    std::vector<ProfilerTrackEvent> events;
+};
+
+/*
+ * Records MR_PROFILE_ZONE scopes from every thread and writes them as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+ * Each thread appends to its own fixed size buffer and publishes the new count with a release store, so recording never locks,
+ * a mutex is only taken the first time a thread records and while writing the trace.
+ * Zones cost one atomic load unless a capture is running.
+ */
+class CpuProfiler
+{
+public:
+    CpuProfiler(const CpuProfiler&) = delete;
+    CpuProfiler& operator=(const CpuProfiler&) = delete;
+    CpuProfiler(CpuProfiler&&) = delete;
+    CpuProfiler& operator=(CpuProfiler&&) = delete;
+
+    [[nodiscard]] static CpuProfiler& get();
+    /* steady_clock, the host clock VK_EXT_calibrated_timestamps pairs GPU timestamps with */
+    [[nodiscard]] static int64_t now_ns();
+
+    /* durationSeconds of 0 keeps capturing until end_capture() */
+    void begin_capture(double durationSeconds = 0.0);
+    [[nodiscard]] bool is_capturing() const;
+    /* Whether a capture with a duration has run for that long */
+    [[nodiscard]] bool is_capture_due() const;
+    /* Stops capturing and writes every zone since begin_capture() plus the extra tracks (each becomes its own process in the trace).
+     * Only call while no other thread is inside a zone, e.g. between frames */
+    [[nodiscard]] bool end_capture(const std::filesystem::path& path, std::span<const ProfilerTrack> extraTracks);
+
+    /* Label for the calling thread's track */
+    void set_thread_name(const std::string& name);
+    void record(const char* name, int64_t startNs, int64_t endNs);
+
+private:
+    CpuProfiler() = default;
+    ~CpuProfiler() = default;
+
+    struct Event {
+        const char* name;
+        int64_t startNs;
+        int64_t endNs;
+    };
+    struct ThreadBuffer {
+        uint32_t threadIndex;
+        std::string threadName;
+        std::unique_ptr<Event[]> events; // Only touched by the owning thread until eventCount publishes it
+        std::atomic<uint32_t> eventCount{0};
+    };
+
+    [[nodiscard]] ThreadBuffer& get_thread_buffer();
+
+    std::atomic<bool> m_bCapturing{false};
+    int64_t m_captureStartNs{0};
+    int64_t m_captureDurationNs{0}; // 0 when the capture has no set duration
+    std::mutex m_threadBuffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+};
+
+/* What MR_PROFILE_ZONE expands to */
+class CpuProfileZone
+{
+public:
+    explicit CpuProfileZone(const char* name);
+    ~CpuProfileZone();
+    CpuProfileZone(const CpuProfileZone&) = delete;
+    CpuProfileZone& operator=(const CpuProfileZone&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_startNs{0};
+    bool m_bActive; // Whether a capture was running when the zone started
+};
@@ -0,0 +1,307 @@
+#include "JobSystem.h"
+#include <Common/Platform.h>
+#include <Common/CpuProfiler.h>
+#include <Common/Log.h>
+#include <cassert>
+#include <string>
+
+#if PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif !PLATFORM_MACOS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static constexpr uint32_t IDLE_SPIN_COUNT = 64; // find_job() attempts (with a yield in between) before a worker goes to sleep
+
+// Which JobSystem thread the calling thread is, set for the creating thread in the constructor and for workers when they start
+static thread_local const JobSystem* currentJobSystem = nullptr;
+static thread_local uint32_t currentThreadIndex = 0;
+
+[[nodiscard]] bool WorkStealingQueue::push(Job* job) {
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    const int64_t top = m_top.load(std::memory_order_acquire);
+    if (bottom - top >= static_cast<int64_t>(JOB_QUEUE_CAPACITY))
+    {
+        return false;
+    }
+    m_jobs[bottom & MASK].store(job, std::memory_order_relaxed);
+    m_bottom.store(bottom + 1, std::memory_order_release); // Publishes the job to thieves
+    return true;
+}
+
+[[nodiscard]] Job* WorkStealingQueue::pop() {
+    // Reserving the bottom slot has to be visible before top is read, or a thief and the owner could both take the last job
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_seq_cst);
+    if (top > bottom)
+    {
+        // Empty
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Job* job = m_jobs[bottom & MASK].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // Last job, race thieves for it
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            job = nullptr;
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+[[nodiscard]] Job* WorkStealingQueue::steal() {
+    int64_t top = m_top.load(std::memory_order_seq_cst);
+    const int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+    if (top >= bottom)
+    {
+        return nullptr;
+    }
+    Job* job = m_jobs[top & MASK].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr; // Lost to the owner or another thief
+    }
+    return job;
+}
+
+static void pin_thread_to_core(std::thread& thread, uint32_t core) {
+#if PLATFORM_WINDOWS
+    if (SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << core) == 0)
+    {
+        MRWARN("Failed to pin job worker to core " << core);
+    }
+#elif PLATFORM_MACOS
+    (void)thread;
+    (void)core;
+    MRWARN("Pinning job workers to cores is not supported on macOS");
+#else
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(core, &cpuSet);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuSet) != 0)
+    {
+        MRWARN("Failed to pin job worker to core " << core);
+    }
+#endif
+}
+
+JobSystem::JobSystem(uint32_t _workerCount, bool _bPinThreads) {
+    const uint32_t threadCount = _workerCount + 1;
+    m_threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        std::unique_ptr<ThreadState>& thread = m_threads.emplace_back(std::make_unique<ThreadState>());
+        thread->jobPool = std::make_unique<Job[]>(JOB_QUEUE_CAPACITY);
+        thread->randomState = 0x9E3779B9u * (i + 1);
+    }
+    currentJobSystem = this;
+    currentThreadIndex = 0;
+
+    const uint32_t coreCount = std::max(std::thread::hardware_concurrency(), 1u);
+    m_workers.reserve(_workerCount);
+    for (uint32_t i = 1; i < threadCount; i++)
+    {
+        std::thread& worker = m_workers.emplace_back([this, i]() {
+            CpuProfiler::get().set_thread_name("Job worker " + std::to_string(i));
+            worker_loop(i);
+        });
+        if (_bPinThreads)
+        {
+            pin_thread_to_core(worker, i % coreCount);
+        }
+    }
+}
+
+JobSystem::~JobSystem() {
+    m_bStopping.store(true);
+    m_jobSignal.fetch_add(1);
+    m_jobSignal.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+    if (currentJobSystem == this)
+    {
+        currentJobSystem = nullptr;
+    }
+}
+
+void JobSystem::wait(const JobCounter& counter) {
+    const uint32_t threadIndex = current_thread_index();
+    while (!counter.is_done())
+    {
+        if (Job* job = find_job(threadIndex))
+        {
+            execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+[[nodiscard]] uint32_t JobSystem::get_thread_count() const {
+    return static_cast<uint32_t>(m_threads.size());
+}
+
+[[nodiscard]] Job* JobSystem::allocate_job() {
+    const uint32_t threadIndex = current_thread_index();
+    ThreadState& thread = *m_threads[threadIndex];
+    Job* job = &thread.jobPool[thread.nextJob % JOB_QUEUE_CAPACITY];
+    thread.nextJob++;
+    if (!job->bFinished.load(std::memory_order_acquire))
+    {
+        // The ring wrapped onto a job that is still queued, waiting on a dependency or running, help out until it is done
+        MR_PROFILE_ZONE("Wait for job slot");
+        while (!job->bFinished.load(std::memory_order_acquire))
+        {
+            // If this thread is running the job itself (it created JOB_QUEUE_CAPACITY jobs that are all still unfinished) it can never finish
+            if (job->executingThread.load(std::memory_order_relaxed) == threadIndex)
+            {
+                MRCERR("A job system thread created more than " << JOB_QUEUE_CAPACITY << " jobs from inside one of its own unfinished jobs!");
+                exit(1);
+            }
+            if (Job* other = find_job(threadIndex))
+            {
+                execute(other);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    job->bFinished.store(false, std::memory_order_relaxed);
+    job->executingThread.store(Job::NOT_EXECUTING, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::submit(Job* job) {
+    ThreadState& thread = *m_threads[current_thread_index()];
+    if (!thread.queue.push(job))
+    {
+        execute(job); // Deque is full, running it here is slower but never loses the job
+        return;
+    }
+    m_jobSignal.fetch_add(1);
+    if (m_sleepingWorkerCount.load() > 0)
+    {
+        m_jobSignal.notify_one();
+    }
+}
+
+void JobSystem::add_continuation(JobCounter& dependency, Job* job) {
+    Job* head = dependency.m_continuations.load();
+    do
+    {
+        job->nextContinuation = head;
+    } while (!dependency.m_continuations.compare_exchange_weak(head, job));
+
+    // The dependency may have finished before the job was linked in, in which case nobody else will release it
+    if (dependency.m_pending.load() == 0)
+    {
+        release_continuations(dependency);
+    }
+}
+
+void JobSystem::release_continuations(JobCounter& counter) {
+    Job* job = counter.m_continuations.exchange(nullptr);
+    while (job)
+    {
+        Job* next = job->nextContinuation; // submit() may run the job right away
+        submit(job);
+        job = next;
+    }
+}
+
+void JobSystem::execute(Job* job) {
+    JobCounter* counter = job->counter;
+    job->executingThread.store(current_thread_index(), std::memory_order_relaxed);
+    job->invoke(*job);
+    job->bFinished.store(true, std::memory_order_release); // The slot can be reused from here on, so job isn't touched again
+    if (counter)
+    {
+        counter->m_finishing.fetch_add(1);
+        if (counter->m_pending.fetch_sub(1) == 1)
+        {
+            release_continuations(*counter);
+        }
+        counter->m_finishing.fetch_sub(1);
+    }
+}
+
+[[nodiscard]] Job* JobSystem::find_job(uint32_t threadIndex) {
+    ThreadState& thread = *m_threads[threadIndex];
+    if (Job* job = thread.queue.pop())
+    {
+        return job;
+    }
+
+    // xorshift32
+    uint32_t random = thread.randomState;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    thread.randomState = random;
+
+    const uint32_t threadCount = static_cast<uint32_t>(m_threads.size());
+    const uint32_t firstVictim = random % threadCount;
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        const uint32_t victim = (firstVictim + i) % threadCount;
+        if (victim == threadIndex)
+        {
+            continue;
+        }
+        if (Job* job = m_threads[victim]->queue.steal())
+        {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::worker_loop(uint32_t threadIndex) {
+    currentJobSystem = this;
+    currentThreadIndex = threadIndex;
+    while (!m_bStopping.load())
+    {
+        Job* job = nullptr;
+        for (uint32_t spin = 0; spin < IDLE_SPIN_COUNT && !job; spin++)
+        {
+            job = find_job(threadIndex);
+            if (!job)
+            {
+                std::this_thread::yield();
+            }
+        }
+        if (!job)
+        {
+            // Read the signal before the last look for work, a submit after that changes it and wait() returns straight away
+            m_sleepingWorkerCount.fetch_add(1);
+            const uint32_t signal = m_jobSignal.load();
+            job = find_job(threadIndex);
+            if (!job && !m_bStopping.load())
+            {
+                m_jobSignal.wait(signal);
+            }
+            m_sleepingWorkerCount.fetch_sub(1);
+        }
+        if (job)
+        {
+            execute(job);
+        }
+    }
+}
+
+[[nodiscard]] uint32_t JobSystem::current_thread_index() const {
+    assert(currentJobSystem == this && "Only the thread that created the JobSystem and its workers can use it");
+    return currentThreadIndex;
+}
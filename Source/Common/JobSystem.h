@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+inline constexpr size_t JOB_STORAGE_SIZE = 64; // Bytes a job's callable may capture, checked at compile time
+inline constexpr uint32_t JOB_QUEUE_CAPACITY = 4096; // Per thread, also the size of each thread's job ring
+inline constexpr uint32_t PARALLEL_FOR_RANGES_PER_THREAD = 4; // Automatic grain size splits into this many ranges per thread, so uneven ranges still balance
+
+class JobCounter;
+
+struct Job {
+    static constexpr uint32_t NOT_EXECUTING = ~0u;
+
+    void (*invoke)(Job& job){nullptr}; // Runs and then destroys the callable in storage
+    JobCounter* counter{nullptr}; // Decremented once the job has run
+    Job* nextContinuation{nullptr}; // Links jobs waiting on the same JobCounter
+    std::atomic<bool> bFinished{true}; // Set once invoke has returned, only then may allocate_job() hand the slot out again
+    std::atomic<uint32_t> executingThread{NOT_EXECUTING}; // Thread index running the job, lets allocate_job() spot a wrap onto a job further up its own stack
+    alignas(16) unsigned char storage[JOB_STORAGE_SIZE];
+};
+
+/*
+ * Counts unfinished jobs. Pass one to JobSystem::run() to wait on a batch of jobs, or to run_after() to start jobs once a batch is done.
+ * Must outlive every job counted on it and anything waiting on it.
+ */
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+    JobCounter(JobCounter&&) = delete;
+    JobCounter& operator=(JobCounter&&) = delete;
+
+    [[nodiscard]] bool is_done() const {
+        return m_pending.load(std::memory_order_seq_cst) == 0 && m_finishing.load(std::memory_order_seq_cst) == 0;
+    }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> m_pending{0};
+    std::atomic<uint32_t> m_finishing{0}; // Jobs between decrementing m_pending and releasing their continuations, the counter can't be destroyed yet
+    std::atomic<Job*> m_continuations{nullptr}; // Intrusive list of jobs started by run_after() once m_pending reaches zero
+};
+
+/*
+ * Chase-Lev work stealing deque (Le et al. 2013, "Correct and Efficient Work-Stealing for Weak Memory Models"), with seq_cst operations in place of the fences.
+ * The owning thread pushes and pops at the bottom, any other thread steals from the top. Fixed capacity, push() fails when full.
+ */
+class WorkStealingQueue
+{
+public:
+    [[nodiscard]] bool push(Job* job);
+    [[nodiscard]] Job* pop();
+    [[nodiscard]] Job* steal();
+
+private:
+    static constexpr int64_t MASK = JOB_QUEUE_CAPACITY - 1;
+    static_assert((JOB_QUEUE_CAPACITY & (JOB_QUEUE_CAPACITY - 1)) == 0, "Capacity has to be a power of two");
+
+    alignas(64) std::atomic<int64_t> m_top{0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+    alignas(64) std::array<std::atomic<Job*>, JOB_QUEUE_CAPACITY> m_jobs{};
+};
+
+/*
+ * Work stealing job scheduler. Every worker thread, and the thread that created the JobSystem, owns a lock free deque.
+ * New jobs go onto the submitting thread's deque, idle threads steal from a random other deque and sleep once there is nothing left anywhere.
+ * wait() runs jobs on the calling thread until the counter is done instead of blocking, so the main thread helps out.
+ *
+ * Only the creating thread and the workers may submit or wait. Jobs come out of a per thread ring of JOB_QUEUE_CAPACITY, once a thread
+ * has that many of its jobs unfinished, creating another runs queued jobs until the oldest one has finished and its slot is free.
+ */
+class JobSystem
+{
+public:
+    /* workerCount excludes the calling thread. With bPinThreads each worker is locked to its own core (worker i to core i + 1, core 0 left to the main thread) */
+    explicit JobSystem(uint32_t _workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1, bool _bPinThreads = false);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    template<typename F>
+    void run(F&& function, JobCounter* counter = nullptr) {
+        Job* job = create_job(std::forward<F>(function), counter);
+        submit(job);
+    }
+
+    /* Like run(), but the job is only queued once dependency is done (immediately if it already is) */
+    template<typename F>
+    void run_after(JobCounter& dependency, F&& function, JobCounter* counter = nullptr) {
+        Job* job = create_job(std::forward<F>(function), counter);
+        add_continuation(dependency, job);
+    }
+
+    /* Runs queued jobs on the calling thread until counter is done */
+    void wait(const JobCounter& counter);
+
+    /*
+     * Calls function(i) for every i in [0, count) and returns once all are done. The range is split into jobs of grainSize indices,
+     * 0 picks PARALLEL_FOR_RANGES_PER_THREAD ranges per thread. The first range runs on the calling thread.
+     */
+    template<typename F>
+    void parallel_for(size_t count, const F& function, size_t grainSize = 0) {
+        if (count == 0)
+        {
+            return;
+        }
+        if (grainSize == 0)
+        {
+            grainSize = std::max<size_t>(count / (static_cast<size_t>(get_thread_count()) * PARALLEL_FOR_RANGES_PER_THREAD), 1);
+        }
+        JobCounter counter;
+        for (size_t begin = grainSize; begin < count; begin += grainSize)
+        {
+            const size_t end = std::min(begin + grainSize, count);
+            run([&function, begin, end]() {
+                for (size_t i = begin; i < end; i++)
+                {
+                    function(i);
+                }
+            }, &counter);
+        }
+        for (size_t i = 0; i < std::min(grainSize, count); i++)
+        {
+            function(i);
+        }
+        wait(counter);
+    }
+
+    /* Workers plus the creating thread */
+    [[nodiscard]] uint32_t get_thread_count() const;
+
+private:
+    template<typename F>
+    [[nodiscard]] Job* create_job(F&& function, JobCounter* counter) {
+        using Callable = std::decay_t<F>;
+        static_assert(sizeof(Callable) <= JOB_STORAGE_SIZE, "Job captures too much, capture a pointer to the data instead");
+        static_assert(alignof(Callable) <= 16, "Job callable is over aligned");
+
+        Job* job = allocate_job();
+        new (job->storage) Callable(std::forward<F>(function));
+        job->invoke = [](Job& self) {
+            Callable* callable = std::launder(reinterpret_cast<Callable*>(self.storage));
+            (*callable)();
+            callable->~Callable();
+        };
+        job->counter = counter;
+        job->nextContinuation = nullptr;
+        if (counter)
+        {
+            counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    struct alignas(64) ThreadState {
+        WorkStealingQueue queue;
+        std::unique_ptr<Job[]> jobPool; // Ring of JOB_QUEUE_CAPACITY jobs
+        uint32_t nextJob{0};
+        uint32_t randomState{0}; // xorshift state for picking steal victims
+    };
+
+    [[nodiscard]] Job* allocate_job();
+    void submit(Job* job);
+    void add_continuation(JobCounter& dependency, Job* job);
+    void release_continuations(JobCounter& counter);
+    void execute(Job* job);
+    /* Pops from the calling thread's own deque first, then tries to steal from every other one starting at a random thread */
+    [[nodiscard]] Job* find_job(uint32_t threadIndex);
+    void worker_loop(uint32_t threadIndex);
+    [[nodiscard]] uint32_t current_thread_index() const;
+
+    std::vector<std::unique_ptr<ThreadState>> m_threads; // Index 0 is the creating thread
+    std::vector<std::thread> m_workers;
+    std::atomic<uint32_t> m_jobSignal{0}; // Bumped on every submit, idle workers wait on it changing
+    std::atomic<uint32_t> m_sleepingWorkerCount{0};
+    std::atomic<bool> m_bStopping{false};
+};
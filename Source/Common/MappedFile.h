@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <Common/Platform.h>
+
+/*
+ * Read only memory mapping of a whole file, unmapped on destruction.
+ * Lets loaders hand pointers into the file straight to the upload path without reading it into a buffer first.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    [[nodiscard]] bool open(const std::filesystem::path& path);
+    void close();
+
+    [[nodiscard]] const unsigned char* data() const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool is_open() const;
+
+private:
+    const unsigned char* m_data{nullptr};
+    size_t m_size{0};
+#if PLATFORM_WINDOWS
+    void* m_fileHandle{nullptr};
+    void* m_mappingHandle{nullptr};
+#endif
+};
@@ -0,0 +1,3 @@
+#pragma once
+#define PLATFORM_WINDOWS 
+#define PLATFORM_MACOS 
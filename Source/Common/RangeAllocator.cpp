@@ -0,0 +1,61 @@
+#include "RangeAllocator.h"
+#include <cassert>
+
+RangeAllocator::RangeAllocator(uint32_t _capacity) : m_capacity(_capacity) {
+    if (m_capacity > 0) {
+        m_freeRanges.emplace(0, m_capacity);
+    }
+}
+
+[[nodiscard]] std::optional<uint32_t> RangeAllocator::allocate(uint32_t count) {
+    assert(count > 0);
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); it++) {
+        if (it->second < count) {
+            continue;
+        }
+        const uint32_t offset = it->first;
+        const uint32_t remaining = it->second - count;
+        m_freeRanges.erase(it);
+        if (remaining > 0) {
+            m_freeRanges.emplace(offset + count, remaining);
+        }
+        m_used += count;
+        return offset;
+    }
+    return std::nullopt;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t count) {
+    assert(count > 0 && offset + count <= m_capacity);
+    m_used -= count;
+
+    auto next = m_freeRanges.lower_bound(offset);
+    assert(next == m_freeRanges.end() || next->first >= offset + count); // Double free / overlapping ranges
+
+    // Merge with the following free range
+    if (next != m_freeRanges.end() && next->first == offset + count) {
+        count += next->second;
+        next = m_freeRanges.erase(next);
+    }
+    // Merge with the preceding free range
+    if (next != m_freeRanges.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            prev->second += count;
+            return;
+        }
+    }
+    m_freeRanges.emplace_hint(next, offset, count);
+}
+
+[[nodiscard]] uint32_t RangeAllocator::get_capacity() const {
+    return m_capacity;
+}
+
+[[nodiscard]] uint32_t RangeAllocator::get_used() const {
+    return m_used;
+}
+
+[[nodiscard]] uint32_t RangeAllocator::get_free_range_count() const {
+    return static_cast<uint32_t>(m_freeRanges.size());
+}
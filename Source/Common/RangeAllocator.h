@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <optional>
+
+/*
+ * Hands out [offset, offset + count) ranges from a fixed capacity using a first fit free list.
+ * Freed ranges are merged with their neighbours so the space can be reused by larger requests.
+ * Units are up to the caller (e.g. vertices or indices), no memory is owned here.
+ */
+class RangeAllocator
+{
+public:
+    RangeAllocator() = default;
+    explicit RangeAllocator(uint32_t _capacity);
+
+    [[nodiscard]] std::optional<uint32_t> allocate(uint32_t count);
+    void free(uint32_t offset, uint32_t count);
+
+    [[nodiscard]] uint32_t get_capacity() const;
+    [[nodiscard]] uint32_t get_used() const;
+    [[nodiscard]] uint32_t get_free_range_count() const;
+
+private:
+    std::map<uint32_t, uint32_t> m_freeRanges; // offset -> count, ordered by offset so neighbours can be found for coalescing
+    uint32_t m_capacity{0};
+    uint32_t m_used{0};
+};
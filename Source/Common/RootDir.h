@@ -0,0 +1,2 @@
+#pragma once
+#define ROOT_DIR "/root/repo/"
@@ -0,0 +1,101 @@
+#include "ThreadPool.h"
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <Common/CpuProfiler.h>
+
+ThreadPool::ThreadPool(uint32_t _threadCount) {
+    const uint32_t threadCount = std::max(_threadCount, 1u);
+    m_workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        m_workers.emplace_back([this, i]() {
+            CpuProfiler::get().set_thread_name("Worker " + std::to_string(i));
+            worker_loop();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStopping = true;
+    }
+    m_taskAvailable.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()>&& task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::wait_idle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_tasks.empty() && m_activeTaskCount == 0; });
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& function) {
+    if (count == 0) {
+        return;
+    }
+    // Helpers can start after this call has returned (every worker busy, or this is itself a task), so they only share this heap state.
+    // Once every index is claimed a late helper finds nothing left and never touches function
+    struct ParallelForState {
+        std::atomic<size_t> nextIndex{0};
+        std::atomic<size_t> finishedCount{0};
+    };
+    std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+    const std::function<void(size_t)>* pFunction = &function;
+    // Workers grab indices one at a time, so uneven work (e.g. a 4k texture next to a 64x64 one) balances itself out
+    auto drain = [state, pFunction, count]() {
+        for (size_t i = state->nextIndex.fetch_add(1); i < count; i = state->nextIndex.fetch_add(1)) {
+            (*pFunction)(i);
+            if (state->finishedCount.fetch_add(1) + 1 == count) {
+                state->finishedCount.notify_all();
+            }
+        }
+    };
+    const size_t helperCount = std::min(count - 1, m_workers.size());
+    for (size_t i = 0; i < helperCount; i++) {
+        submit(drain);
+    }
+    drain(); // Calling thread participates instead of sleeping
+    // Wait for indices other threads claimed but haven't finished yet, not for the whole pool
+    for (size_t finishedCount = state->finishedCount.load(); finishedCount < count; finishedCount = state->finishedCount.load()) {
+        state->finishedCount.wait(finishedCount);
+    }
+}
+
+uint32_t ThreadPool::get_thread_count() const {
+    return static_cast<uint32_t>(m_workers.size());
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [this]() { return m_bStopping || !m_tasks.empty(); });
+            if (m_bStopping && m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            m_activeTaskCount++;
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeTaskCount--;
+            if (m_tasks.empty() && m_activeTaskCount == 0) {
+                m_idle.notify_all();
+            }
+        }
+    }
+}
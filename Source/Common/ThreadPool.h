@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/*
+ * Fixed set of worker threads pulling tasks from a shared queue.
+ * Used for CPU heavy work that can run off the main thread (e.g. texture decoding during import)
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(uint32_t _threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    void submit(std::function<void()>&& task);
+    /* Block until the queue is drained and every worker is idle */
+    void wait_idle();
+    /*
+     * Run function(i) for every i in [0, count) across the workers and the calling thread, returns once all are done.
+     * Only waits on its own indices, so it can be called from a task and doesn't stall on unrelated work in the pool.
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)>& function);
+    [[nodiscard]] uint32_t get_thread_count() const;
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_idle;
+    size_t m_activeTaskCount = 0;
+    bool m_bStopping = false;
+};
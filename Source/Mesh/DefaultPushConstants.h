@@ -5,11 +5,15 @@
 #include <Common/IdTypes.h>
 
 struct DefaultPushConstants {
-    glm::mat4 model;
     VkDeviceAddress sceneDataBufferAddress;
     MaterialId materialId;
+    VkDeviceAddress objectBufferAddress{0}; // GPUScene objects, GPU driven draws read model and materialId from here instead
+    VkDeviceAddress instanceTransformBufferAddress{0}; // InstanceBatcher's mat4s, CPU driven draws index it with gl_InstanceIndex
+    alignas(16) glm::vec4 positionDequantOffset{0.0f}; // CompactVertex position = offset + unorm * scale, w unused
+    alignas(16) glm::vec4 positionDequantScale{1.0f};
 
     static constexpr VkPushConstantRange range() {
+        static_assert(sizeof(DefaultPushConstants) <= 128, "128 bytes is all Vulkan guarantees for push constants");
         VkPushConstantRange defaultPushConstantRange = {
             .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
             .offset = 0,
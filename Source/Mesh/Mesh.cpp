@@ -1,6 +0,0 @@
-#include <Mesh/Mesh.h>
-
-void GPUMesh::cleanup(VmaAllocator allocator) {
-    vertexBuffer.cleanup(allocator);
-    indexBuffer.cleanup(allocator);
-}
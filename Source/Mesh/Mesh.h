@@ -1,23 +1,44 @@
 #pragma once
 #include <Vertex/Vertex.h>
-#include <Wrappers/Buffer.h>
 #include <Common/IdTypes.h>
 #include <vector>
+#include <span>
 #include <unordered_map>
 #include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
 
+/* Non-owning view of a mesh's data on the CPU, the storage belongs to whoever produced it (e.g. a CPUModel's cooked file mapping) */
 struct CPUMesh {
-    std::vector<Vertex> m_vertices;
-    std::vector<uint32_t> m_indices;
+    std::span<const Vertex> m_vertices; // VertexFormat::Full
+    std::span<const CompactVertex> m_compactVertices; // VertexFormat::Compact, only one of the two is set
+    std::span<const uint32_t> m_indices;
     MaterialId m_materialId{NULL_MATERIAL_ID};
-    glm::mat4x4 m_transform{0.0};
+    glm::vec3 m_boundsMin{0.0f}; // Local space AABB, CPUMeshInstance transforms place the mesh in the model
+    glm::vec3 m_boundsMax{0.0f};
+
+    [[nodiscard]] VertexFormat get_vertex_format() const {
+        return m_compactVertices.empty() ? VertexFormat::Full : VertexFormat::Compact;
+    }
+    [[nodiscard]] size_t get_vertex_count() const {
+        return m_vertices.size() + m_compactVertices.size();
+    }
+};
+
+/* A placement of a CPUMesh, meshes the source model reuses are uploaded once and placed many times */
+struct CPUMeshInstance {
+    uint32_t m_meshIndex{0}; // Into the owning CPUModel's m_cpuMeshes
+    glm::mat4x4 m_transform{1.0f}; // Mesh local to model space
 };
 
+/* A mesh is a range of vertices and indices inside one of the MeshCache's shared buffer pages */
 struct GPUMesh {
-    AllocatedBuffer vertexBuffer;
-    AllocatedBuffer  indexBuffer;
-    uint32_t indexCount;
+    uint32_t pageIndex{0};
+    uint32_t vertexOffset{0};
+    uint32_t vertexCount{0};
+    uint32_t firstIndex{0};
+    uint32_t indexCount{0};
     MaterialId m_materialId{NULL_MATERIAL_ID};
-
-    void cleanup(VmaAllocator allocator);
+    VertexFormat vertexFormat{VertexFormat::Full}; // Same as its page's
+    glm::vec3 boundsMin{0.0f}; // Same space as the vertices, the RenderMeshComponent transform still applies. Also dequantizes CompactVertex positions
+    glm::vec3 boundsMax{0.0f};
 };
\ No newline at end of file
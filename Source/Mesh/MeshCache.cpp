@@ -1,10 +1,20 @@
 #include "MeshCache.h"
 #include <Rendering/GfxDevice.h>
+#include <algorithm>
+#include <cassert>
+
+// Default page size, meshes bigger than this get a page of their own
+static constexpr uint32_t MESH_PAGE_VERTEX_CAPACITY = 1 << 20; // 64MB of Vertex, 20MB of CompactVertex
+static constexpr uint32_t MESH_PAGE_INDEX_CAPACITY = 1 << 22; // 16MB of uint32_t, 8MB of uint16_t
+
+[[nodiscard]] static uint32_t index_size(VkIndexType indexType) {
+    return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
 
 
 [[nodiscard]] GPUMeshId MeshCache::add_mesh(const GfxDevice& gfxDevice, const CPUMesh& mesh) {
     const GPUMeshId meshId = m_meshes.size();
-    upload_mesh(mesh, gfxDevice.m_vmaAllocator);
+    upload_mesh(gfxDevice, mesh);
     return meshId;
 }
 
@@ -12,23 +22,137 @@
     return m_meshes[id];
 }
 
+void MeshCache::remove_mesh(GPUMeshId id) {
+    GPUMesh& gpuMesh = m_meshes[id];
+    // Frames still in flight may read the ranges, so hand them back once this frame's fence has signalled
+    m_removedMeshes[m_frameIndex].push_back(gpuMesh);
+    // Keep the slot so other ids stay valid, it just draws nothing now
+    gpuMesh.vertexCount = 0;
+    gpuMesh.indexCount = 0;
+}
+
+void MeshCache::begin_frame(uint32_t frameInFlightIndex) {
+    // Fences signal in submission order, so every frame that could have drawn these meshes is done with them
+    m_frameIndex = frameInFlightIndex;
+    for (const GPUMesh& removedMesh : m_removedMeshes[m_frameIndex])
+    {
+        MeshBufferPage& page = m_pages[removedMesh.pageIndex];
+        if (removedMesh.vertexCount > 0) {
+            page.vertexRanges.free(removedMesh.vertexOffset, removedMesh.vertexCount);
+        }
+        if (removedMesh.indexCount > 0) {
+            page.indexRanges.free(removedMesh.firstIndex, removedMesh.indexCount);
+        }
+    }
+    m_removedMeshes[m_frameIndex].clear();
+}
+
+void MeshCache::bind_page(VkCommandBuffer cmd, uint32_t pageIndex) const {
+    const MeshBufferPage& page = m_pages[pageIndex];
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(cmd, 0, 1, &page.vertexBuffer.buffer, &offset);
+    vkCmdBindIndexBuffer(cmd, page.indexBuffer.buffer, 0, page.indexType);
+}
+
+[[nodiscard]] uint32_t MeshCache::get_page_count() const {
+    return static_cast<uint32_t>(m_pages.size());
+}
+
+[[nodiscard]] VertexFormat MeshCache::get_page_vertex_format(uint32_t pageIndex) const {
+    return m_pages[pageIndex].vertexFormat;
+}
+
+[[nodiscard]] uint64_t MeshCache::get_vertex_memory_size() const {
+    return m_vertexMemorySize;
+}
+
+[[nodiscard]] uint64_t MeshCache::get_index_memory_size() const {
+    return m_indexMemorySize;
+}
+
 void MeshCache::cleanup(const GfxDevice& gfxDevice) {
-    for (auto &mesh : m_meshes)
+    for (auto &page : m_pages)
     {
-        mesh.cleanup(gfxDevice.m_vmaAllocator);
+        page.vertexBuffer.cleanup(gfxDevice.m_vmaAllocator);
+        page.indexBuffer.cleanup(gfxDevice.m_vmaAllocator);
     }
 }
 
-void MeshCache::upload_mesh(const CPUMesh& mesh, VmaAllocator allocator) {
+void MeshCache::upload_mesh(const GfxDevice& gfxDevice, const CPUMesh& mesh) {
 
     GPUMesh gpuMesh;
+    gpuMesh.vertexFormat = mesh.get_vertex_format();
+    gpuMesh.vertexCount = static_cast<uint32_t>(mesh.get_vertex_count());
     gpuMesh.indexCount = static_cast<uint32_t>(mesh.m_indices.size());
+    // Half the index bandwidth and memory for every mesh small enough, which is most of them
+    const VkIndexType indexType = gpuMesh.vertexCount <= MAX_16_BIT_INDEXED_VERTICES ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    gpuMesh.pageIndex = allocate_mesh_ranges(gfxDevice, gpuMesh, indexType);
 
-    upload_buffer(gpuMesh.vertexBuffer, mesh.m_vertices.size() * sizeof(Vertex), mesh.m_vertices.data(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, allocator);
-
-    if (mesh.m_indices.size() > 0) {
-        upload_buffer(gpuMesh.indexBuffer, mesh.m_indices.size() * sizeof(uint32_t), mesh.m_indices.data(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, allocator);
+    MeshBufferPage& page = m_pages[gpuMesh.pageIndex];
+    if (gpuMesh.vertexCount > 0) {
+        const uint32_t stride = vertex_stride(gpuMesh.vertexFormat);
+        const void* vertexData = gpuMesh.vertexFormat == VertexFormat::Compact ? static_cast<const void*>(mesh.m_compactVertices.data()) : static_cast<const void*>(mesh.m_vertices.data());
+        write_static_buffer(page.vertexBuffer, gpuMesh.vertexOffset * stride, gpuMesh.vertexCount * stride, vertexData, gfxDevice);
+        m_vertexMemorySize += static_cast<uint64_t>(gpuMesh.vertexCount) * stride;
+    }
+    if (gpuMesh.indexCount > 0) {
+        const void* indexData = mesh.m_indices.data();
+        if (indexType == VK_INDEX_TYPE_UINT16) {
+            m_narrowedIndices.resize(mesh.m_indices.size());
+            std::transform(mesh.m_indices.begin(), mesh.m_indices.end(), m_narrowedIndices.begin(), [](uint32_t index) { return static_cast<uint16_t>(index); });
+            indexData = m_narrowedIndices.data();
+        }
+        const uint32_t indexStride = index_size(indexType);
+        write_static_buffer(page.indexBuffer, static_cast<size_t>(gpuMesh.firstIndex) * indexStride, static_cast<size_t>(gpuMesh.indexCount) * indexStride, indexData, gfxDevice);
+        m_indexMemorySize += static_cast<uint64_t>(gpuMesh.indexCount) * indexStride;
     }
     gpuMesh.m_materialId = mesh.m_materialId;
+    gpuMesh.boundsMin = mesh.m_boundsMin;
+    gpuMesh.boundsMax = mesh.m_boundsMax;
     m_meshes.push_back(gpuMesh);
-}
\ No newline at end of file
+}
+
+[[nodiscard]] uint32_t MeshCache::allocate_mesh_ranges(const GfxDevice& gfxDevice, GPUMesh& gpuMesh, VkIndexType indexType) {
+    auto try_page = [&](uint32_t pageIndex) -> bool {
+        MeshBufferPage& page = m_pages[pageIndex];
+        std::optional<uint32_t> vertexOffset = gpuMesh.vertexCount > 0 ? page.vertexRanges.allocate(gpuMesh.vertexCount) : std::optional<uint32_t>(0);
+        if (!vertexOffset.has_value()) {
+            return false;
+        }
+        std::optional<uint32_t> firstIndex = gpuMesh.indexCount > 0 ? page.indexRanges.allocate(gpuMesh.indexCount) : std::optional<uint32_t>(0);
+        if (!firstIndex.has_value()) {
+            if (gpuMesh.vertexCount > 0) {
+                page.vertexRanges.free(vertexOffset.value(), gpuMesh.vertexCount);
+            }
+            return false;
+        }
+        gpuMesh.vertexOffset = vertexOffset.value();
+        gpuMesh.firstIndex = firstIndex.value();
+        return true;
+    };
+
+    for (uint32_t pageIndex = 0; pageIndex < m_pages.size(); pageIndex++) {
+        if (m_pages[pageIndex].vertexFormat == gpuMesh.vertexFormat && m_pages[pageIndex].indexType == indexType && try_page(pageIndex)) {
+            return pageIndex;
+        }
+    }
+
+    const uint32_t newPageIndex = create_page(gfxDevice, gpuMesh.vertexFormat, indexType,
+        std::max(MESH_PAGE_VERTEX_CAPACITY, gpuMesh.vertexCount),
+        std::max(MESH_PAGE_INDEX_CAPACITY, gpuMesh.indexCount));
+    [[maybe_unused]] const bool bAllocated = try_page(newPageIndex);
+    assert(bAllocated);
+    return newPageIndex;
+}
+
+[[nodiscard]] uint32_t MeshCache::create_page(const GfxDevice& gfxDevice, VertexFormat vertexFormat, VkIndexType indexType, uint32_t vertexCapacity, uint32_t indexCapacity) {
+    MeshBufferPage& page = m_pages.emplace_back();
+    page.vertexFormat = vertexFormat;
+    page.indexType = indexType;
+    create_static_buffer(page.vertexBuffer, static_cast<VkDeviceSize>(vertexCapacity) * vertex_stride(vertexFormat), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, gfxDevice.m_vmaAllocator);
+    create_static_buffer(page.indexBuffer, static_cast<VkDeviceSize>(indexCapacity) * index_size(indexType), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, gfxDevice.m_vmaAllocator);
+    page.vertexRanges = RangeAllocator(vertexCapacity);
+    page.indexRanges = RangeAllocator(indexCapacity);
+    MRLOG("Created mesh buffer page " << m_pages.size() - 1 << " (" << vertexCapacity << (vertexFormat == VertexFormat::Compact ? " compact" : "") << " vertices, " << indexCapacity << (indexType == VK_INDEX_TYPE_UINT16 ? " 16 bit" : " 32 bit") << " indices)");
+    return static_cast<uint32_t>(m_pages.size() - 1);
+}
@@ -1,9 +1,28 @@
 #pragma once
 #include <Mesh/Mesh.h>
 #include <Common/IdTypes.h>
+#include <Common/RangeAllocator.h>
+#include <Wrappers/Buffer.h>
+#include <Common/Config.h>
+#include <vulkan/vulkan.h>
+#include <array>
+#include <vector>
 
 class GfxDevice;
 
+// Indices are relative to the mesh's vertexOffset and primitive restart is off, so every 16 bit value is a usable index
+inline constexpr uint32_t MAX_16_BIT_INDEXED_VERTICES = 1 << 16;
+
+/* One large vertex buffer + index buffer pair that many meshes are suballocated from, all in the same vertex format and index width */
+struct MeshBufferPage {
+    VertexFormat vertexFormat{VertexFormat::Full};
+    VkIndexType indexType{VK_INDEX_TYPE_UINT32}; // UINT16 pages hold the meshes with no more than MAX_16_BIT_INDEXED_VERTICES vertices
+    AllocatedBuffer vertexBuffer;
+    AllocatedBuffer indexBuffer;
+    RangeAllocator vertexRanges; // In vertices
+    RangeAllocator indexRanges; // In indices
+};
+
 class MeshCache
 {
 public:
@@ -16,9 +35,33 @@ public:
 
     [[nodiscard]] GPUMeshId add_mesh(const GfxDevice& gfxDevice, const CPUMesh& mesh);
     [[nodiscard]] const GPUMesh& get_mesh(GPUMeshId id) const;
+    /*
+     * The id draws nothing from now on, but frames already submitted may still read its vertices and indices.
+     * So the ranges only return to their page once begin_frame() is next called for the current frame in flight, after its fence has signalled.
+     */
+    void remove_mesh(GPUMeshId id);
+    /* Only call once the frame's fence has signalled, releases the ranges removed the last time this frame in flight was recorded */
+    void begin_frame(uint32_t frameInFlightIndex);
+    /* Bind the vertex and index buffers of a page with the page's index type, draws then address meshes with firstIndex/vertexOffset */
+    void bind_page(VkCommandBuffer cmd, uint32_t pageIndex) const;
+    [[nodiscard]] uint32_t get_page_count() const;
+    [[nodiscard]] VertexFormat get_page_vertex_format(uint32_t pageIndex) const;
+    /* Bytes of vertex data uploaded so far, for comparing vertex formats */
+    [[nodiscard]] uint64_t get_vertex_memory_size() const;
+    /* Bytes of index data uploaded so far */
+    [[nodiscard]] uint64_t get_index_memory_size() const;
     void cleanup(const GfxDevice& gfxDevice);
 
 private:
-    void upload_mesh(const CPUMesh& mesh, VmaAllocator allocator);
+    void upload_mesh(const GfxDevice& gfxDevice, const CPUMesh& mesh);
+    /* Find (or create) a page with room for the mesh and reserve the ranges in it */
+    [[nodiscard]] uint32_t allocate_mesh_ranges(const GfxDevice& gfxDevice, GPUMesh& gpuMesh, VkIndexType indexType);
+    [[nodiscard]] uint32_t create_page(const GfxDevice& gfxDevice, VertexFormat vertexFormat, VkIndexType indexType, uint32_t vertexCapacity, uint32_t indexCapacity);
     std::vector<GPUMesh> m_meshes;
-};
\ No newline at end of file
+    std::vector<MeshBufferPage> m_pages;
+    uint64_t m_vertexMemorySize{0};
+    uint64_t m_indexMemorySize{0};
+    std::vector<uint16_t> m_narrowedIndices; // Scratch for converting a mesh's indices to 16 bit before upload
+    std::array<std::vector<GPUMesh>, MAX_FRAMES_IN_FLIGHT> m_removedMeshes; // Ranges waiting on their frame in flight's fence before they can be reused
+    uint32_t m_frameIndex{0};
+};
@@ -0,0 +1,402 @@
+#include "MeshOptimizer.h"
+#include <Common/Log.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+// Forsyth's tuned constants, the cache size here is what the scoring assumes rather than what the hardware has
+static constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+static constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+static constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+static constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+static constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+/* Vertex cache simulation. Stores when each vertex was last transformed instead of a queue, so every lookup is O(1) */
+class FifoVertexCache
+{
+public:
+    explicit FifoVertexCache(size_t vertexCount) : m_insertTimes(vertexCount, 0) {}
+
+    void flush() {
+        m_time += VERTEX_CACHE_ANALYSIS_SIZE + 1;
+    }
+
+    /* Returns 1 on a miss, which transforms the vertex and pushes it into the cache */
+    [[nodiscard]] uint32_t access(uint32_t vertexIndex) {
+        if (m_time - m_insertTimes[vertexIndex] <= VERTEX_CACHE_ANALYSIS_SIZE)
+        {
+            return 0;
+        }
+        m_insertTimes[vertexIndex] = m_time++;
+        return 1;
+    }
+
+    [[nodiscard]] uint32_t access_triangle(const uint32_t* triangle) {
+        return access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+    }
+
+private:
+    std::vector<uint32_t> m_insertTimes;
+    uint32_t m_time{VERTEX_CACHE_ANALYSIS_SIZE + 1}; // Far enough ahead of the zeroed insert times that everything starts out missing
+};
+
+[[nodiscard]] VertexCacheStats analyze_vertex_cache(std::span<const uint32_t> indices, uint32_t vertexCount) {
+    VertexCacheStats stats;
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+    {
+        return stats;
+    }
+    FifoVertexCache cache(vertexCount);
+    uint64_t misses = 0;
+    for (size_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        misses += cache.access_triangle(&indices[triangle * 3]);
+    }
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(vertexCount);
+    return stats;
+}
+
+struct VertexBytesHash {
+    [[nodiscard]] size_t operator()(const Vertex& vertex) const noexcept {
+        // FNV-1a
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(Vertex); i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+struct VertexBytesEqual {
+    [[nodiscard]] bool operator()(const Vertex& a, const Vertex& b) const noexcept {
+        return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+static_assert(sizeof(Vertex) == 16 * sizeof(float), "Vertex has padding, hashing and comparing its bytes would read it");
+
+static void deduplicate_vertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::unordered_map<Vertex, uint32_t, VertexBytesHash, VertexBytesEqual> uniqueIndices;
+    uniqueIndices.reserve(vertices.size());
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<Vertex> uniqueVertices;
+    uniqueVertices.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const auto [it, bInserted] = uniqueIndices.try_emplace(vertices[i], static_cast<uint32_t>(uniqueVertices.size()));
+        if (bInserted)
+        {
+            uniqueVertices.push_back(vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+    for (uint32_t& index : indices)
+    {
+        index = remap[index];
+    }
+    vertices = std::move(uniqueVertices);
+}
+
+static float forsyth_vertex_score(int32_t cachePosition, uint32_t remainingTriangleCount) {
+    if (remainingTriangleCount == 0)
+    {
+        return -1.0f; // Nothing left to draw with this vertex
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            // Used by the last triangle, a fixed score stops strips from being favoured over fans
+            score = FORSYTH_LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            const float scale = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+    // Vertices with few triangles left get finished off, so they stop taking up cache space
+    score += FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangleCount), -FORSYTH_VALENCE_BOOST_POWER);
+    return score;
+}
+
+static void optimize_vertex_cache(std::vector<uint32_t>& indices, uint32_t vertexCount) {
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Triangles using each vertex, emitted ones are swapped to the back of the vertex's range so only the remaining ones are walked
+    std::vector<uint32_t> remainingTriangleCounts(vertexCount, 0);
+    for (const uint32_t index : indices)
+    {
+        remainingTriangleCounts[index]++;
+    }
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::inclusive_scan(remainingTriangleCounts.begin(), remainingTriangleCounts.end(), adjacencyOffsets.begin() + 1);
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            adjacency[fillOffsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int32_t> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+    {
+        vertexScores[vertex] = forsyth_vertex_score(-1, remainingTriangleCounts[vertex]);
+    }
+    auto triangle_score = [&](uint32_t triangle) {
+        return vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+    };
+
+    std::vector<float> triangleScores(triangleCount);
+    uint32_t bestTriangle = 0;
+    float bestScore = -1.0f;
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        triangleScores[triangle] = triangle_score(triangle);
+        if (triangleScores[triangle] > bestScore)
+        {
+            bestScore = triangleScores[triangle];
+            bestTriangle = triangle;
+        }
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+    std::vector<uint32_t> optimizedIndices;
+    optimizedIndices.reserve(indices.size());
+    uint32_t scanCursor = 0;
+    for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        if (bestTriangle == INVALID_INDEX)
+        {
+            // Nothing in the cache has triangles left, carry on with the next one not drawn yet
+            while (emitted[scanCursor])
+            {
+                scanCursor++;
+            }
+            bestTriangle = scanCursor;
+        }
+
+        const uint32_t* triangle = &indices[static_cast<size_t>(bestTriangle) * 3];
+        emitted[bestTriangle] = true;
+        optimizedIndices.insert(optimizedIndices.end(), triangle, triangle + 3);
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            const uint32_t vertex = triangle[corner];
+            const auto begin = adjacency.begin() + adjacencyOffsets[vertex];
+            const auto end = begin + remainingTriangleCounts[vertex];
+            std::iter_swap(std::find(begin, end, bestTriangle), end - 1);
+            remainingTriangleCounts[vertex]--;
+        }
+
+        // LRU: the triangle's vertices move to the front, whatever falls past FORSYTH_CACHE_SIZE is evicted
+        newCache.clear();
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            if (std::find(newCache.begin(), newCache.end(), triangle[corner]) == newCache.end())
+            {
+                newCache.push_back(triangle[corner]);
+            }
+        }
+        for (const uint32_t vertex : cache)
+        {
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+            {
+                newCache.push_back(vertex);
+            }
+        }
+        for (size_t position = 0; position < newCache.size(); position++)
+        {
+            const uint32_t vertex = newCache[position];
+            cachePositions[vertex] = position < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(position) : -1;
+            vertexScores[vertex] = forsyth_vertex_score(cachePositions[vertex], remainingTriangleCounts[vertex]);
+        }
+
+        // Only triangles touching the cache changed score, the next one is picked from them
+        bestTriangle = INVALID_INDEX;
+        bestScore = -1.0f;
+        for (const uint32_t vertex : newCache)
+        {
+            const uint32_t adjacencyBegin = adjacencyOffsets[vertex];
+            for (uint32_t i = adjacencyBegin; i < adjacencyBegin + remainingTriangleCounts[vertex]; i++)
+            {
+                const uint32_t adjacentTriangle = adjacency[i];
+                triangleScores[adjacentTriangle] = triangle_score(adjacentTriangle);
+                if (triangleScores[adjacentTriangle] > bestScore)
+                {
+                    bestScore = triangleScores[adjacentTriangle];
+                    bestTriangle = adjacentTriangle;
+                }
+            }
+        }
+        newCache.resize(std::min<size_t>(newCache.size(), FORSYTH_CACHE_SIZE));
+        std::swap(cache, newCache);
+    }
+    indices = std::move(optimizedIndices);
+}
+
+/*
+ * Splits the cache optimized order into clusters wherever the cache ran dry, then splits those further as long as each piece
+ * stays within threshold of its cluster's ACMR. Clusters facing away from the mesh's center draw first, so they occlude the rest.
+ */
+static void optimize_overdraw(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float threshold) {
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount < 2)
+    {
+        return;
+    }
+
+    FifoVertexCache cache(vertices.size());
+    std::vector<uint32_t> hardBoundaries;
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        if (cache.access_triangle(&indices[static_cast<size_t>(triangle) * 3]) == 3 || triangle == 0)
+        {
+            hardBoundaries.push_back(triangle);
+        }
+    }
+    hardBoundaries.push_back(triangleCount);
+
+    std::vector<uint32_t> clusterStarts;
+    for (size_t hardCluster = 0; hardCluster + 1 < hardBoundaries.size(); hardCluster++)
+    {
+        const uint32_t start = hardBoundaries[hardCluster];
+        const uint32_t end = hardBoundaries[hardCluster + 1];
+
+        cache.flush();
+        uint32_t clusterMisses = 0;
+        for (uint32_t triangle = start; triangle < end; triangle++)
+        {
+            clusterMisses += cache.access_triangle(&indices[static_cast<size_t>(triangle) * 3]);
+        }
+        const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+        clusterStarts.push_back(start);
+        cache.flush();
+        uint32_t runningMisses = 0;
+        uint32_t runningTriangles = 0;
+        for (uint32_t triangle = start; triangle < end; triangle++)
+        {
+            runningMisses += cache.access_triangle(&indices[static_cast<size_t>(triangle) * 3]);
+            runningTriangles++;
+            if (static_cast<float>(runningMisses) / static_cast<float>(runningTriangles) <= clusterThreshold)
+            {
+                clusterStarts.push_back(triangle + 1);
+                cache.flush();
+                runningMisses = 0;
+                runningTriangles = 0;
+            }
+        }
+        // The piece left at the end rarely reaches the threshold, merge it into the one before instead of drawing a poor cluster on its own
+        if (clusterStarts.back() != start)
+        {
+            clusterStarts.pop_back();
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    glm::vec3 meshCentroid(0.0f);
+    for (const Vertex& vertex : vertices)
+    {
+        meshCentroid += vertex.position;
+    }
+    meshCentroid /= static_cast<float>(vertices.size());
+
+    const size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t cluster = 0; cluster < clusterCount; cluster++)
+    {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (uint32_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; triangle++)
+        {
+            const glm::vec3& p0 = vertices[indices[static_cast<size_t>(triangle) * 3]].position;
+            const glm::vec3& p1 = vertices[indices[static_cast<size_t>(triangle) * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[static_cast<size_t>(triangle) * 3 + 2]].position;
+            const glm::vec3 triangleNormal = glm::cross(p1 - p0, p2 - p0);
+            const float triangleArea = glm::length(triangleNormal);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += triangleNormal;
+            area += triangleArea;
+        }
+        const float normalLength = glm::length(normal);
+        if (area <= 0.0f || normalLength <= 0.0f)
+        {
+            sortKeys[cluster] = 0.0f; // Degenerate, no preferred side
+            continue;
+        }
+        sortKeys[cluster] = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+    }
+
+    std::vector<uint32_t> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> sortedIndices;
+    sortedIndices.reserve(indices.size());
+    for (const uint32_t cluster : clusterOrder)
+    {
+        sortedIndices.insert(sortedIndices.end(), indices.begin() + static_cast<size_t>(clusterStarts[cluster]) * 3, indices.begin() + static_cast<size_t>(clusterStarts[cluster + 1]) * 3);
+    }
+    indices = std::move(sortedIndices);
+}
+
+static void optimize_vertex_fetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::vector<uint32_t> remap(vertices.size(), INVALID_INDEX);
+    std::vector<Vertex> reorderedVertices;
+    reorderedVertices.reserve(vertices.size());
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == INVALID_INDEX)
+        {
+            remap[index] = static_cast<uint32_t>(reorderedVertices.size());
+            reorderedVertices.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(reorderedVertices);
+}
+
+MeshOptimizationStats optimize_mesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    MeshOptimizationStats stats;
+    stats.vertexCountBefore = static_cast<uint32_t>(vertices.size());
+    stats.before = analyze_vertex_cache(indices, stats.vertexCountBefore);
+
+    deduplicate_vertices(vertices, indices);
+    if (indices.size() % 3 == 0)
+    {
+        optimize_vertex_cache(indices, static_cast<uint32_t>(vertices.size()));
+        optimize_overdraw(vertices, indices, OVERDRAW_ACMR_THRESHOLD);
+    }
+    else
+    {
+        MRWARN("Mesh isn't a triangle list, only merging its vertices");
+    }
+    optimize_vertex_fetch(vertices, indices);
+
+    stats.vertexCountAfter = static_cast<uint32_t>(vertices.size());
+    stats.after = analyze_vertex_cache(indices, stats.vertexCountAfter);
+    return stats;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <Vertex/Vertex.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+inline constexpr uint32_t VERTEX_CACHE_ANALYSIS_SIZE = 16; // FIFO entries ACMR/ATVR are measured against, about what current GPUs reuse
+inline constexpr float OVERDRAW_ACMR_THRESHOLD = 1.05f; // How much vertex cache efficiency overdraw sorting may give up
+
+/* Post transform vertex cache efficiency of an index buffer, lower is better for both */
+struct VertexCacheStats {
+    float acmr{0.0f}; // Average cache miss ratio, vertex shader invocations per triangle. 0.5 at best, 3 at worst
+    float atvr{0.0f}; // Average transformed vertex ratio, vertex shader invocations per vertex. 1 at best
+};
+
+struct MeshOptimizationStats {
+    uint32_t vertexCountBefore{0};
+    uint32_t vertexCountAfter{0};
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+/* Simulates a VERTEX_CACHE_ANALYSIS_SIZE entry FIFO cache over indices, vertexCount is only used for the ATVR */
+[[nodiscard]] VertexCacheStats analyze_vertex_cache(std::span<const uint32_t> indices, uint32_t vertexCount);
+
+/*
+ * Rewrites a triangle list for the GPU, in place:
+ * 1. Identical vertices are merged
+ * 2. Triangles are reordered for the post transform vertex cache (Forsyth 2006, "Linear-Speed Vertex Cache Optimisation")
+ * 3. Runs of those triangles are sorted so outward facing ones draw first, for less overdraw (Sander et al. 2007, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+ * 4. Vertices are reordered into first use order for vertex fetch locality, unreferenced ones are dropped
+ */
+MeshOptimizationStats optimize_mesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
@@ -11,11 +11,10 @@ RenderMeshComponent::RenderMeshComponent(const GPUMeshId _GPUmeshId, const MeshC
     , m_materialId(m_meshCache.get_mesh(m_GPUmeshId).m_materialId)
 {}
 
-void RenderMeshComponent::bind_mesh_buffers_and_draw(VkCommandBuffer commandBuffer, [[maybe_unused]] std::span<VkDescriptorSet const> descriptorSets) const {
-
-    VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &(m_meshCache.get_mesh(m_GPUmeshId).vertexBuffer.buffer), &offset);
-    vkCmdBindIndexBuffer(commandBuffer, m_meshCache.get_mesh(m_GPUmeshId).indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+[[nodiscard]] GPUMeshId RenderMeshComponent::get_mesh_id() const {
+    return m_GPUmeshId;
+}
 
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(m_meshCache.get_mesh(m_GPUmeshId).indexCount), 1, 0, 0, 0);
+[[nodiscard]] const GPUMesh& RenderMeshComponent::get_mesh() const {
+    return m_meshCache.get_mesh(m_GPUmeshId);
 }
@@ -6,10 +6,12 @@
 #include <Common/IdTypes.h>
 
 class MeshCache;
+struct GPUMesh;
 
 struct RenderMeshComponent {
     RenderMeshComponent(const GPUMeshId _GPUmeshId, const MeshCache& _meshCache, glm::mat4 _transformMatrix);
-    void bind_mesh_buffers_and_draw(VkCommandBuffer commandBuffer, std::span<VkDescriptorSet const> descriptorSets) const;
+    [[nodiscard]] GPUMeshId get_mesh_id() const;
+    [[nodiscard]] const GPUMesh& get_mesh() const;
 
 
     
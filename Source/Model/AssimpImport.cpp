@@ -0,0 +1,240 @@
+#include <Common/Compiler/DisableWarnings.h>
+PUSH_MSVC_WARNINGS
+DISABLE_MSVC_WARNING(4267) // conversion from 'size_t' to 'uint32_t', possible loss of data
+DISABLE_MSVC_WARNING(4201) // nonstandard extension used : nameless struct / union (glm library)
+PUSH_CLANG_WARNINGS
+DISABLE_CLANG_WARNING("-Wmissing-field-initializers")
+DISABLE_CLANG_WARNING("-Wshorten-64-to-32")
+
+#include "AssimpImport.h"
+#include <Common/Log.h>
+#include <Common/CpuProfiler.h>
+#include <Mesh/MeshOptimizer.h>
+#include <unordered_map>
+#include <limits>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <assimp/matrix4x4.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+static constexpr uint32_t UNIMPORTED_MESH = std::numeric_limits<uint32_t>::max();
+
+static constexpr aiTextureType sceneTextureTypes[] = {
+    aiTextureType_BASE_COLOR,
+    aiTextureType_METALNESS,
+    aiTextureType_NORMALS,
+    aiTextureType_EMISSIVE
+};
+
+static CookedTextureRole texture_role(aiTextureType textureType)
+{
+    switch(textureType)
+    {
+        case aiTextureType_BASE_COLOR:
+            return CookedTextureRole::Diffuse;
+        case aiTextureType_METALNESS:
+            return CookedTextureRole::MetallicRoughness;
+        case aiTextureType_NORMALS:
+            return CookedTextureRole::Normal;
+        case aiTextureType_EMISSIVE:
+            return CookedTextureRole::Emissive;
+        default:
+            MRCERR("Tried to load non-standard aiTextureType!");
+            exit(1);
+    }
+}
+
+static std::string get_texture_name(const std::filesystem::path& modelPath, bool texturesEmbedded, const aiMaterial* material, aiTextureType textureType)
+{
+    if (texturesEmbedded)
+    {
+        std::string textureName = modelPath.filename().replace_extension().string();
+        switch(texture_role(textureType))
+        {
+            case CookedTextureRole::Diffuse:
+                return textureName + std::string("_diffuse_tex");
+            case CookedTextureRole::MetallicRoughness:
+                return textureName + std::string("_metallic_roughness_tex");
+            case CookedTextureRole::Normal:
+                return textureName + std::string("_normals_tex");
+            case CookedTextureRole::Emissive:
+            default:
+                return textureName + std::string("_emissive_tex");
+        }
+    }
+    aiString str;
+    material->GetTexture(textureType, 0, &str);
+    return std::string(str.C_Str());
+}
+
+static glm::mat4x4 convertAssimpMatrix(const aiMatrix4x4 &aiMat)
+{
+    return {
+        aiMat.a1, aiMat.b1, aiMat.c1, aiMat.d1,
+        aiMat.a2, aiMat.b2, aiMat.c2, aiMat.d2,
+        aiMat.a3, aiMat.b3, aiMat.c3, aiMat.d3,
+        aiMat.a4, aiMat.b4, aiMat.c4, aiMat.d4
+    };
+}
+
+static void import_materials(const std::filesystem::path& path, bool texturesEmbedded, const aiScene* scene, ImportedModel& model)
+{
+    std::unordered_map<std::string, int32_t> textureIndices;
+    model.materials.resize(scene->mNumMaterials);
+    for (unsigned int materialIndex = 0; materialIndex < scene->mNumMaterials; materialIndex++)
+    {
+        const aiMaterial* material = scene->mMaterials[materialIndex];
+        ImportedMaterial& importedMaterial = model.materials[materialIndex];
+
+        aiColor4D aiColor;
+        if (material->Get(AI_MATKEY_BASE_COLOR, aiColor) == AI_SUCCESS)
+        {
+            importedMaterial.baseColorFactor = glm::vec4(aiColor.r, aiColor.g, aiColor.b, aiColor.a);
+        }
+
+        for (aiTextureType textureType : sceneTextureTypes)
+        {
+            if (material->GetTextureCount(textureType) == 0)
+            {
+                continue;
+            }
+            const size_t roleIndex = static_cast<size_t>(texture_role(textureType));
+            std::string textureName = get_texture_name(path, texturesEmbedded, material, textureType);
+            auto existing = textureIndices.find(textureName);
+            if (existing != textureIndices.end())
+            {
+                importedMaterial.textureIndices[roleIndex] = existing->second;
+                continue;
+            }
+
+            ImportedTexture texture;
+            texture.name = textureName;
+            texture.role = texture_role(textureType);
+            if (texturesEmbedded) // .glb for example
+            {
+                aiString embeddedTextureFile;
+                material->GetTexture(textureType, 0, &embeddedTextureFile);
+                const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(embeddedTextureFile.C_Str());
+                if (!embeddedTexture || embeddedTexture->mHeight != 0)
+                {
+                    MRCERR("Embedded texture is missing or uncompressed, what do? " << embeddedTextureFile.C_Str());
+                    exit(1);
+                }
+                const unsigned char* encodedData = reinterpret_cast<const unsigned char*>(embeddedTexture->pcData);
+                texture.embeddedData.assign(encodedData, encodedData + embeddedTexture->mWidth); // For compressed textures mWidth is the size in bytes
+            }
+            else
+            {
+                texture.filePath = path.parent_path() / std::filesystem::path(textureName);
+            }
+
+            const int32_t textureIndex = static_cast<int32_t>(model.textures.size());
+            model.textures.push_back(std::move(texture));
+            textureIndices.emplace(std::move(textureName), textureIndex);
+            importedMaterial.textureIndices[roleIndex] = textureIndex;
+        }
+    }
+}
+
+static ImportedMesh import_mesh(const aiMesh *mesh, const aiScene *scene)
+{
+    ImportedMesh importedMesh;
+    importedMesh.materialIndex = mesh->mMaterialIndex;
+    importedMesh.vertices.resize(mesh->mNumVertices);
+
+    // Vertex colors carry the material's base color factor, see ImportedMaterial
+    glm::vec4 vertexColor = glm::vec4(1.0f, 0.0f, 1.0f, 1.0f); // Magenta fallback
+    aiColor4D aiColor;
+    if (scene->mMaterials[mesh->mMaterialIndex]->Get(AI_MATKEY_BASE_COLOR, aiColor) == AI_SUCCESS)
+    {
+        vertexColor = glm::vec4(aiColor.r, aiColor.g, aiColor.b, aiColor.a);
+    }
+
+    importedMesh.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    importedMesh.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i < mesh->mNumVertices; i++)
+    {
+        Vertex& vertex = importedMesh.vertices[i];
+
+        vertex.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+        vertex.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+        if (mesh->HasTextureCoords(0))
+        {
+            vertex.uv_x = mesh->mTextureCoords[0][i].x;
+            vertex.uv_y = mesh->mTextureCoords[0][i].y;
+        }
+        // TODO:
+        // vertex.tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+        vertex.color = vertexColor;
+
+        importedMesh.boundsMin = glm::min(importedMesh.boundsMin, vertex.position);
+        importedMesh.boundsMax = glm::max(importedMesh.boundsMax, vertex.position);
+    }
+    if (mesh->mNumVertices == 0)
+    {
+        importedMesh.boundsMin = glm::vec3(0.0f);
+        importedMesh.boundsMax = glm::vec3(0.0f);
+    }
+
+    importedMesh.indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
+    for (size_t i = 0; i < mesh->mNumFaces; i++)
+    {
+        const aiFace& face = mesh->mFaces[i];
+        importedMesh.indices.insert(importedMesh.indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+    }
+
+    // Assimp hands back unshared vertices in file order, which is also what gets cooked
+    MR_PROFILE_ZONE("Optimize mesh");
+    const MeshOptimizationStats stats = optimize_mesh(importedMesh.vertices, importedMesh.indices);
+    MRLOG("Optimized mesh " << mesh->mName.C_Str() << ": " << stats.vertexCountBefore << " -> " << stats.vertexCountAfter << " vertices, ACMR "
+        << stats.before.acmr << " -> " << stats.after.acmr << ", ATVR " << stats.before.atvr << " -> " << stats.after.atvr);
+    return importedMesh;
+}
+
+/* sceneMeshIndices maps Assimp's mesh index to ImportedModel::meshes, so a mesh referenced by several nodes is imported once */
+static void import_node(const aiNode *node, const aiScene *scene, const glm::mat4x4& accumulateMatrix, std::vector<uint32_t>& sceneMeshIndices, ImportedModel& model)
+{
+    glm::mat4x4 transform = accumulateMatrix * convertAssimpMatrix(node->mTransformation);
+
+    // Process this node's meshes
+    for (size_t i = 0; i < node->mNumMeshes; i++)
+    {
+        const unsigned int sceneMeshIndex = node->mMeshes[i];
+        if (sceneMeshIndices[sceneMeshIndex] == UNIMPORTED_MESH)
+        {
+            sceneMeshIndices[sceneMeshIndex] = static_cast<uint32_t>(model.meshes.size());
+            model.meshes.push_back(import_mesh(scene->mMeshes[sceneMeshIndex], scene));
+        }
+        model.instances.push_back({sceneMeshIndices[sceneMeshIndex], transform});
+    }
+    // Process this node's child node(s)
+    for (size_t i = 0; i < node->mNumChildren; i++)
+    {
+        import_node(node->mChildren[i], scene, transform, sceneMeshIndices, model);
+    }
+}
+
+[[nodiscard]] bool import_model_assimp(const std::filesystem::path& path, bool texturesEmbedded, ImportedModel& model)
+{
+    MR_PROFILE_ZONE("Assimp import");
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path.string(), aiProcess_Triangulate | aiProcess_FlipUVs);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        MRCERR("Problem loading model: " << path.string());
+        return false;
+    }
+    import_materials(path, texturesEmbedded, scene, model);
+    glm::mat4x4 rootTransform = convertAssimpMatrix(scene->mRootNode->mTransformation);
+    std::vector<uint32_t> sceneMeshIndices(scene->mNumMeshes, UNIMPORTED_MESH);
+    import_node(scene->mRootNode, scene, rootTransform, sceneMeshIndices, model);
+    MRLOG("Imported " << model.meshes.size() << " meshes used by " << model.instances.size() << " instances from " << path.filename().string());
+    return true;
+}
+
+POP_CLANG_WARNINGS
+POP_MSVC_WARNINGS
@@ -0,0 +1,48 @@
+#pragma once
+#include <Vertex/Vertex.h>
+#include <Model/CookedModelFormat.h>
+#include <glm/mat4x4.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/*
+ * GPU independent result of running a model through Assimp, shared by the runtime fallback path in CPUModel and the AssetCooker tool.
+ */
+
+struct ImportedTexture {
+    std::string name; // TextureCache key
+    CookedTextureRole role;
+    std::filesystem::path filePath; // Set for textures stored next to the model
+    std::vector<unsigned char> embeddedData; // Still encoded image bytes for textures stored inside the model (.glb)
+};
+
+struct ImportedMaterial {
+    int32_t textureIndices[static_cast<size_t>(CookedTextureRole::Count)]{COOKED_NO_TEXTURE, COOKED_NO_TEXTURE, COOKED_NO_TEXTURE, COOKED_NO_TEXTURE};
+    glm::vec4 baseColorFactor{1.0f, 0.0f, 1.0f, 1.0f}; // Magenta when the material doesn't specify one
+};
+
+/* One of the source's meshes, in its own local space. Nodes that reference it become ImportedMeshInstances */
+struct ImportedMesh {
+    std::vector<Vertex> vertices; // Deduplicated and in first use order
+    std::vector<uint32_t> indices; // Ordered for the vertex cache and overdraw, see optimize_mesh()
+    uint32_t materialIndex{0};
+    glm::vec3 boundsMin{0.0f}; // Local space
+    glm::vec3 boundsMax{0.0f};
+};
+
+/* A node's reference to a mesh */
+struct ImportedMeshInstance {
+    uint32_t meshIndex{0}; // Into ImportedModel::meshes
+    glm::mat4x4 transform{1.0f}; // The node hierarchy's transform, local to model space
+};
+
+struct ImportedModel {
+    std::vector<ImportedMesh> meshes;
+    std::vector<ImportedMeshInstance> instances;
+    std::vector<ImportedMaterial> materials;
+    std::vector<ImportedTexture> textures;
+};
+
+/* Returns false if Assimp could not load the file */
+[[nodiscard]] bool import_model_assimp(const std::filesystem::path& path, bool texturesEmbedded, ImportedModel& model);
@@ -0,0 +1,308 @@
+#include "CookedModel.h"
+#include <Model/AssimpImport.h>
+#include <Common/Log.h>
+#include <cstring>
+#include <cassert>
+#include <fstream>
+
+static uint64_t align_offset(uint64_t offset) {
+    return (offset + COOKED_MODEL_ALIGNMENT - 1) & ~(COOKED_MODEL_ALIGNMENT - 1);
+}
+
+static int64_t source_write_time(const std::filesystem::path& sourcePath) {
+    std::error_code errorCode;
+    const auto writeTime = std::filesystem::last_write_time(sourcePath, errorCode);
+    return errorCode ? 0 : static_cast<int64_t>(writeTime.time_since_epoch().count());
+}
+
+[[nodiscard]] std::filesystem::path cooked_model_path(const std::filesystem::path& sourcePath) {
+    std::filesystem::path cookedPath = sourcePath;
+    cookedPath += COOKED_MODEL_EXTENSION;
+    return cookedPath;
+}
+
+[[nodiscard]] std::filesystem::path cooked_texture_path(const std::filesystem::path& modelPath, const std::string& textureName) {
+    std::filesystem::path cookedPath = modelPath.parent_path() / std::filesystem::path(textureName);
+    cookedPath += COOKED_TEXTURE_EXTENSION;
+    return cookedPath;
+}
+
+[[nodiscard]] bool is_cooked_file_stale(const std::filesystem::path& cookedPath, const std::filesystem::path& sourcePath) {
+    std::error_code errorCode;
+    const auto sourceWriteTime = std::filesystem::last_write_time(sourcePath, errorCode);
+    if (errorCode)
+    {
+        return false;
+    }
+    const auto cookedWriteTime = std::filesystem::last_write_time(cookedPath, errorCode);
+    return !errorCode && cookedWriteTime < sourceWriteTime;
+}
+
+[[nodiscard]] bool write_cooked_model(const std::filesystem::path& outputPath, const std::filesystem::path& sourcePath, const ImportedModel& model) {
+    CookedModelHeader header = {};
+    std::memcpy(header.magic, COOKED_MODEL_MAGIC, sizeof(header.magic));
+    header.version = COOKED_MODEL_VERSION;
+    header.vertexStride = sizeof(Vertex);
+    header.meshCount = static_cast<uint32_t>(model.meshes.size());
+    header.materialCount = static_cast<uint32_t>(model.materials.size());
+    header.textureCount = static_cast<uint32_t>(model.textures.size());
+    header.instanceCount = static_cast<uint32_t>(model.instances.size());
+    header.sourceFileSize = std::filesystem::file_size(sourcePath);
+    header.sourceFileWriteTime = source_write_time(sourcePath);
+
+    // Build the tables first so the section sizes are known
+    std::vector<CookedMesh> meshes;
+    meshes.reserve(model.meshes.size());
+    uint64_t vertexCount = 0;
+    uint64_t indexCount = 0;
+    for (const ImportedMesh& importedMesh : model.meshes)
+    {
+        CookedMesh mesh = {};
+        mesh.firstVertex = vertexCount;
+        mesh.vertexCount = importedMesh.vertices.size();
+        mesh.firstIndex = indexCount;
+        mesh.indexCount = importedMesh.indices.size();
+        mesh.materialIndex = importedMesh.materialIndex;
+        std::memcpy(mesh.boundsMin, &importedMesh.boundsMin[0], sizeof(mesh.boundsMin));
+        std::memcpy(mesh.boundsMax, &importedMesh.boundsMax[0], sizeof(mesh.boundsMax));
+        vertexCount += mesh.vertexCount;
+        indexCount += mesh.indexCount;
+        meshes.push_back(mesh);
+    }
+
+    std::vector<CookedMeshInstance> instances;
+    instances.reserve(model.instances.size());
+    for (const ImportedMeshInstance& importedInstance : model.instances)
+    {
+        CookedMeshInstance instance = {};
+        instance.meshIndex = importedInstance.meshIndex;
+        std::memcpy(instance.transform, &importedInstance.transform[0][0], sizeof(instance.transform));
+        instances.push_back(instance);
+    }
+
+    std::vector<CookedMaterial> materials;
+    materials.reserve(model.materials.size());
+    for (const ImportedMaterial& importedMaterial : model.materials)
+    {
+        CookedMaterial material = {};
+        std::memcpy(material.textureIndices, importedMaterial.textureIndices, sizeof(material.textureIndices));
+        std::memcpy(material.baseColorFactor, &importedMaterial.baseColorFactor[0], sizeof(material.baseColorFactor));
+        materials.push_back(material);
+    }
+
+    std::vector<CookedTexture> textures;
+    std::string stringTable;
+    uint64_t embeddedSize = 0;
+    for (const ImportedTexture& importedTexture : model.textures)
+    {
+        CookedTexture texture = {};
+        texture.nameOffset = static_cast<uint32_t>(stringTable.size());
+        texture.nameLength = static_cast<uint32_t>(importedTexture.name.size());
+        texture.role = static_cast<uint32_t>(importedTexture.role);
+        texture.embeddedOffset = embeddedSize;
+        texture.embeddedSize = importedTexture.embeddedData.size();
+        stringTable += importedTexture.name;
+        embeddedSize = align_offset(embeddedSize + texture.embeddedSize);
+        textures.push_back(texture);
+    }
+
+    // Lay out the sections
+    uint64_t offset = align_offset(sizeof(CookedModelHeader));
+    header.meshTableOffset = offset;
+    offset = align_offset(offset + meshes.size() * sizeof(CookedMesh));
+    header.instanceTableOffset = offset;
+    offset = align_offset(offset + instances.size() * sizeof(CookedMeshInstance));
+    header.materialTableOffset = offset;
+    offset = align_offset(offset + materials.size() * sizeof(CookedMaterial));
+    header.textureTableOffset = offset;
+    offset = align_offset(offset + textures.size() * sizeof(CookedTexture));
+    header.stringTableOffset = offset;
+    offset = align_offset(offset + stringTable.size());
+    header.vertexBlobOffset = offset;
+    header.vertexBlobSize = vertexCount * sizeof(Vertex);
+    offset = align_offset(offset + header.vertexBlobSize);
+    header.indexBlobOffset = offset;
+    header.indexBlobSize = indexCount * sizeof(uint32_t);
+    offset = align_offset(offset + header.indexBlobSize);
+    header.embeddedTextureBlobOffset = offset;
+    header.embeddedTextureBlobSize = embeddedSize;
+
+    std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        MRCERR("Could not open " << outputPath.string() << " for writing");
+        return false;
+    }
+    auto write_at = [&file](uint64_t sectionOffset, const void* data, size_t size) {
+        // Zero pad up to the section start
+        static const char zeros[COOKED_MODEL_ALIGNMENT] = {};
+        const uint64_t position = static_cast<uint64_t>(file.tellp());
+        assert(sectionOffset >= position && sectionOffset - position < COOKED_MODEL_ALIGNMENT);
+        file.write(zeros, static_cast<std::streamsize>(sectionOffset - position));
+        if (size > 0)
+        {
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        }
+    };
+    write_at(0, &header, sizeof(header));
+    write_at(header.meshTableOffset, meshes.data(), meshes.size() * sizeof(CookedMesh));
+    write_at(header.instanceTableOffset, instances.data(), instances.size() * sizeof(CookedMeshInstance));
+    write_at(header.materialTableOffset, materials.data(), materials.size() * sizeof(CookedMaterial));
+    write_at(header.textureTableOffset, textures.data(), textures.size() * sizeof(CookedTexture));
+    write_at(header.stringTableOffset, stringTable.data(), stringTable.size());
+    write_at(header.vertexBlobOffset, nullptr, 0);
+    for (const ImportedMesh& importedMesh : model.meshes)
+    {
+        file.write(reinterpret_cast<const char*>(importedMesh.vertices.data()), static_cast<std::streamsize>(importedMesh.vertices.size() * sizeof(Vertex)));
+    }
+    write_at(header.indexBlobOffset, nullptr, 0);
+    for (const ImportedMesh& importedMesh : model.meshes)
+    {
+        file.write(reinterpret_cast<const char*>(importedMesh.indices.data()), static_cast<std::streamsize>(importedMesh.indices.size() * sizeof(uint32_t)));
+    }
+    for (size_t i = 0; i < textures.size(); i++)
+    {
+        write_at(header.embeddedTextureBlobOffset + textures[i].embeddedOffset, model.textures[i].embeddedData.data(), model.textures[i].embeddedData.size());
+    }
+    write_at(header.embeddedTextureBlobOffset + header.embeddedTextureBlobSize, nullptr, 0);
+    return static_cast<bool>(file);
+}
+
+[[nodiscard]] bool CookedModelView::open(const std::filesystem::path& cookedPath, const std::filesystem::path& sourcePath) {
+    m_header = nullptr;
+    if (!std::filesystem::exists(cookedPath) || !m_file.open(cookedPath))
+    {
+        return false;
+    }
+    if (!validate(sourcePath))
+    {
+        m_file.close();
+        return false;
+    }
+    m_header = at<CookedModelHeader>(0);
+    return true;
+}
+
+[[nodiscard]] bool CookedModelView::validate(const std::filesystem::path& sourcePath) const {
+    if (m_file.size() < sizeof(CookedModelHeader))
+    {
+        MRWARN("Cooked model " << sourcePath.string() << " is truncated, ignoring it");
+        return false;
+    }
+    const CookedModelHeader* header = at<CookedModelHeader>(0);
+    if (std::memcmp(header->magic, COOKED_MODEL_MAGIC, sizeof(header->magic)) != 0 || header->version != COOKED_MODEL_VERSION || header->vertexStride != sizeof(Vertex))
+    {
+        MRWARN("Cooked model for " << sourcePath.string() << " is from a different format version, re-run the AssetCooker");
+        return false;
+    }
+    // Only compare against the source when it's around, cooked files are allowed to ship without their sources
+    if (std::filesystem::exists(sourcePath) &&
+        (header->sourceFileSize != std::filesystem::file_size(sourcePath) || header->sourceFileWriteTime != source_write_time(sourcePath)))
+    {
+        MRWARN("Cooked model for " << sourcePath.string() << " is out of date, re-run the AssetCooker");
+        return false;
+    }
+
+    const uint64_t fileSize = m_file.size();
+    auto section_fits = [fileSize](uint64_t offset, uint64_t size) { return offset <= fileSize && size <= fileSize - offset; };
+    // count elements of stride bytes starting at element first fit in size bytes, written so corrupt values can't wrap around
+    auto range_fits = [](uint64_t first, uint64_t count, uint64_t stride, uint64_t size) { return first <= size / stride && count <= size / stride - first; };
+    const bool bSectionsFit = section_fits(header->meshTableOffset, uint64_t(header->meshCount) * sizeof(CookedMesh))
+        && section_fits(header->instanceTableOffset, uint64_t(header->instanceCount) * sizeof(CookedMeshInstance))
+        && section_fits(header->materialTableOffset, uint64_t(header->materialCount) * sizeof(CookedMaterial))
+        && section_fits(header->textureTableOffset, uint64_t(header->textureCount) * sizeof(CookedTexture))
+        && section_fits(header->vertexBlobOffset, header->vertexBlobSize)
+        && section_fits(header->indexBlobOffset, header->indexBlobSize)
+        && section_fits(header->embeddedTextureBlobOffset, header->embeddedTextureBlobSize);
+    if (!bSectionsFit)
+    {
+        MRWARN("Cooked model for " << sourcePath.string() << " is corrupt, ignoring it");
+        return false;
+    }
+    const CookedMesh* meshes = at<CookedMesh>(header->meshTableOffset);
+    for (uint32_t i = 0; i < header->meshCount; i++)
+    {
+        if (!range_fits(meshes[i].firstVertex, meshes[i].vertexCount, sizeof(Vertex), header->vertexBlobSize)
+            || !range_fits(meshes[i].firstIndex, meshes[i].indexCount, sizeof(uint32_t), header->indexBlobSize)
+            || meshes[i].materialIndex >= header->materialCount)
+        {
+            MRWARN("Cooked model for " << sourcePath.string() << " has an out of range mesh, ignoring it");
+            return false;
+        }
+    }
+    const CookedMeshInstance* instances = at<CookedMeshInstance>(header->instanceTableOffset);
+    for (uint32_t i = 0; i < header->instanceCount; i++)
+    {
+        if (instances[i].meshIndex >= header->meshCount)
+        {
+            MRWARN("Cooked model for " << sourcePath.string() << " has an instance of a missing mesh, ignoring it");
+            return false;
+        }
+    }
+    // CPUModel indexes its texture names with these directly
+    const CookedMaterial* materials = at<CookedMaterial>(header->materialTableOffset);
+    for (uint32_t i = 0; i < header->materialCount; i++)
+    {
+        for (const int32_t textureIndex : materials[i].textureIndices)
+        {
+            if (textureIndex != COOKED_NO_TEXTURE && (textureIndex < 0 || static_cast<uint32_t>(textureIndex) >= header->textureCount))
+            {
+                MRWARN("Cooked model for " << sourcePath.string() << " has a material using a missing texture, ignoring it");
+                return false;
+            }
+        }
+    }
+    if (!section_fits(header->stringTableOffset, 0))
+    {
+        MRWARN("Cooked model for " << sourcePath.string() << " is corrupt, ignoring it");
+        return false;
+    }
+    const uint64_t stringTableSize = fileSize - header->stringTableOffset;
+    const CookedTexture* textures = at<CookedTexture>(header->textureTableOffset);
+    for (uint32_t i = 0; i < header->textureCount; i++)
+    {
+        if (!range_fits(textures[i].nameOffset, textures[i].nameLength, 1, stringTableSize)
+            || !range_fits(textures[i].embeddedOffset, textures[i].embeddedSize, 1, header->embeddedTextureBlobSize))
+        {
+            MRWARN("Cooked model for " << sourcePath.string() << " has an out of range texture, ignoring it");
+            return false;
+        }
+    }
+    return true;
+}
+
+[[nodiscard]] std::span<const CookedMesh> CookedModelView::get_meshes() const {
+    return {at<CookedMesh>(m_header->meshTableOffset), m_header->meshCount};
+}
+
+[[nodiscard]] std::span<const CookedMeshInstance> CookedModelView::get_instances() const {
+    return {at<CookedMeshInstance>(m_header->instanceTableOffset), m_header->instanceCount};
+}
+
+[[nodiscard]] std::span<const CookedMaterial> CookedModelView::get_materials() const {
+    return {at<CookedMaterial>(m_header->materialTableOffset), m_header->materialCount};
+}
+
+[[nodiscard]] std::span<const CookedTexture> CookedModelView::get_textures() const {
+    return {at<CookedTexture>(m_header->textureTableOffset), m_header->textureCount};
+}
+
+[[nodiscard]] std::string_view CookedModelView::get_texture_name(const CookedTexture& texture) const {
+    return {at<char>(m_header->stringTableOffset + texture.nameOffset), texture.nameLength};
+}
+
+[[nodiscard]] std::span<const unsigned char> CookedModelView::get_embedded_texture_data(const CookedTexture& texture) const {
+    if (texture.embeddedSize == 0)
+    {
+        return {};
+    }
+    return {at<unsigned char>(m_header->embeddedTextureBlobOffset + texture.embeddedOffset), texture.embeddedSize};
+}
+
+[[nodiscard]] std::span<const Vertex> CookedModelView::get_vertices(const CookedMesh& mesh) const {
+    return {at<Vertex>(m_header->vertexBlobOffset) + mesh.firstVertex, mesh.vertexCount};
+}
+
+[[nodiscard]] std::span<const uint32_t> CookedModelView::get_indices(const CookedMesh& mesh) const {
+    return {at<uint32_t>(m_header->indexBlobOffset) + mesh.firstIndex, mesh.indexCount};
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <Model/CookedModelFormat.h>
+#include <Common/MappedFile.h>
+#include <Vertex/Vertex.h>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+
+struct ImportedModel;
+
+/* Where the cooked version of a source model lives, next to the source with COOKED_MODEL_EXTENSION appended */
+[[nodiscard]] std::filesystem::path cooked_model_path(const std::filesystem::path& sourcePath);
+/* Where the AssetCooker puts the block compressed version of a model's texture, next to the model with COOKED_TEXTURE_EXTENSION appended */
+[[nodiscard]] std::filesystem::path cooked_texture_path(const std::filesystem::path& modelPath, const std::string& textureName);
+/* Whether sourcePath has been modified after cookedPath was written, false if either file is missing */
+[[nodiscard]] bool is_cooked_file_stale(const std::filesystem::path& cookedPath, const std::filesystem::path& sourcePath);
+
+/* Serialize an imported model, returns false if the file could not be written */
+[[nodiscard]] bool write_cooked_model(const std::filesystem::path& outputPath, const std::filesystem::path& sourcePath, const ImportedModel& model);
+
+/*
+ * Memory mapped, validated view of a cooked model. All spans point straight into the mapping and stay valid while this object lives.
+ */
+class CookedModelView
+{
+public:
+    CookedModelView() = default;
+    CookedModelView(const CookedModelView&) = delete;
+    CookedModelView& operator=(const CookedModelView&) = delete;
+    CookedModelView(CookedModelView&&) = delete;
+    CookedModelView& operator=(CookedModelView&&) = delete;
+
+    /* Fails (without logging an error) if the file is missing, and with a warning if it is malformed, from another version or older than sourcePath */
+    [[nodiscard]] bool open(const std::filesystem::path& cookedPath, const std::filesystem::path& sourcePath);
+
+    [[nodiscard]] std::span<const CookedMesh> get_meshes() const;
+    [[nodiscard]] std::span<const CookedMeshInstance> get_instances() const;
+    [[nodiscard]] std::span<const CookedMaterial> get_materials() const;
+    [[nodiscard]] std::span<const CookedTexture> get_textures() const;
+    [[nodiscard]] std::string_view get_texture_name(const CookedTexture& texture) const;
+    [[nodiscard]] std::span<const unsigned char> get_embedded_texture_data(const CookedTexture& texture) const;
+    [[nodiscard]] std::span<const Vertex> get_vertices(const CookedMesh& mesh) const;
+    [[nodiscard]] std::span<const uint32_t> get_indices(const CookedMesh& mesh) const;
+
+private:
+    template<typename T>
+    [[nodiscard]] const T* at(uint64_t offset) const {
+        return reinterpret_cast<const T*>(m_file.data() + offset);
+    }
+    [[nodiscard]] bool validate(const std::filesystem::path& sourcePath) const;
+
+    MappedFile m_file;
+    const CookedModelHeader* m_header{nullptr};
+};
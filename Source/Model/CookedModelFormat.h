@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * On disk layout of a cooked model (.mrmodel), written by the AssetCooker tool and memory mapped by CPUModel.
+ *
+ * [CookedModelHeader]
+ * [CookedMesh     x meshCount]
+ * [CookedMeshInstance x instanceCount]
+ * [CookedMaterial x materialCount]
+ * [CookedTexture  x textureCount]
+ * [string table]              texture names, not null terminated
+ * [vertex blob]               every mesh's vertices back to back, already in the engine's Vertex layout
+ * [index blob]                uint32_t indices, relative to the mesh's first vertex
+ * [embedded texture blob]     still encoded (png/jpg) image bytes pulled out of .glb files
+ *
+ * Offsets are in bytes from the start of the file, each section starts on a COOKED_MODEL_ALIGNMENT boundary.
+ * Bump COOKED_MODEL_VERSION whenever any of these structs or the Vertex layout changes, old files are then ignored and re-imported.
+ */
+
+inline constexpr char COOKED_MODEL_MAGIC[4] = {'M', 'R', 'C', 'M'};
+inline constexpr uint32_t COOKED_MODEL_VERSION = 3; // 2: meshes are optimized for the vertex cache and overdraw, 3: meshes are in local space with separate instances
+inline constexpr uint64_t COOKED_MODEL_ALIGNMENT = 16;
+inline constexpr const char* COOKED_MODEL_EXTENSION = ".mrmodel";
+inline constexpr const char* COOKED_TEXTURE_EXTENSION = ".ktx2";
+
+inline constexpr int32_t COOKED_NO_TEXTURE = -1;
+
+enum class CookedTextureRole : uint32_t {
+    Diffuse = 0,
+    MetallicRoughness = 1,
+    Normal = 2,
+    Emissive = 3,
+    Count
+};
+
+struct CookedModelHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexStride; // sizeof(Vertex) at cook time, checked against the runtime
+    uint32_t meshCount;
+    uint32_t materialCount;
+    uint32_t textureCount;
+    uint32_t instanceCount;
+    uint32_t padding;
+    uint64_t sourceFileSize; // Used to spot a source asset that changed since it was cooked
+    int64_t sourceFileWriteTime;
+
+    uint64_t meshTableOffset;
+    uint64_t instanceTableOffset;
+    uint64_t materialTableOffset;
+    uint64_t textureTableOffset;
+    uint64_t stringTableOffset;
+    uint64_t vertexBlobOffset;
+    uint64_t vertexBlobSize;
+    uint64_t indexBlobOffset;
+    uint64_t indexBlobSize;
+    uint64_t embeddedTextureBlobOffset;
+    uint64_t embeddedTextureBlobSize;
+};
+
+struct CookedMesh {
+    uint64_t firstVertex; // In vertices, into the vertex blob
+    uint64_t vertexCount;
+    uint64_t firstIndex; // In indices, into the index blob
+    uint64_t indexCount;
+    uint32_t materialIndex;
+    uint32_t padding;
+    float boundsMin[3]; // Local space, like the vertices
+    float boundsMax[3];
+};
+
+struct CookedMeshInstance {
+    uint32_t meshIndex; // Into the mesh table
+    float transform[16]; // Column major, local to model space
+};
+
+struct CookedMaterial {
+    int32_t textureIndices[static_cast<size_t>(CookedTextureRole::Count)]; // Into the texture table, COOKED_NO_TEXTURE uses the engine fallback
+    float baseColorFactor[4];
+};
+
+struct CookedTexture {
+    uint32_t nameOffset; // Into the string table, also the TextureCache key
+    uint32_t nameLength;
+    uint32_t role; // CookedTextureRole
+    uint32_t padding;
+    uint64_t embeddedOffset; // Into the embedded texture blob, embeddedSize == 0 means the name is a path relative to the source model
+    uint64_t embeddedSize;
+};
+
+static_assert(sizeof(CookedModelHeader) % 8 == 0);
+static_assert(sizeof(CookedMesh) % 8 == 0);
+static_assert(sizeof(CookedMeshInstance) % 4 == 0);
+static_assert(sizeof(CookedTexture) % 8 == 0);
@@ -11,371 +11,213 @@ DISABLE_CLANG_WARNING("-Wshorten-64-to-32")
 #include <Texture/TextureCache.h>
 #include <Material/MaterialCache.h>
 #include <Material/Material.h>
+#include <Texture/TextureDecoder.h>
 #include <vulkan/vulkan.h>
+#include <vulkan/vk_enum_string_helper.h>
+#include <Texture/Ktx2.h>
 #include <Common/Log.h>
+#include <Common/ThreadPool.h>
+#include <Common/CpuProfiler.h>
+#include <Vertex/VertexPacking.h>
 #include <span>
+#include <chrono>
 
-// Define these only in *one* .cpp file.
-#define STB_IMAGE_IMPLEMENTATION
-//#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include <External/tinygltf/stb_image.h>
 
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-#include <assimp/matrix4x4.h>
-
-#define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <glm/gtx/matrix_decompose.hpp>
 
-void CPUModel::load_texture_from_filename(const aiMaterial* material, aiTextureType textureType, Material& meshMaterial)
+void CPUModel::load_textures(std::vector<TextureDecodeRequest>& decodeRequests, ThreadPool& threadPool)
 {
-    aiString str;
-    material->GetTexture(textureType, 0, &str);
-    const std::string textureName(str.C_Str());
-
-    GPUTextureId* meshMaterialTextureIdToSet = nullptr;
-
-    switch(textureType)
+    // Skip what other models already brought in, so decoding happens in one parallel batch for just the new textures
+    std::erase_if(decodeRequests, [this](const TextureDecodeRequest& request) { return m_textureCache.is_texture_loaded_already(request.textureName); });
+    // Textures the AssetCooker already compressed don't need decoding at all
+    std::erase_if(decodeRequests, [this](const TextureDecodeRequest& request) { return load_cooked_texture(request); });
+
+    const auto decodeStart = std::chrono::steady_clock::now();
+    decode_textures(threadPool, decodeRequests);
+    const auto decodeEnd = std::chrono::steady_clock::now();
+    MRLOG("Decoded " << decodeRequests.size() << " textures for " << m_path.filename().string() << " in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(decodeEnd - decodeStart).count() << "ms using "
+        << threadPool.get_thread_count() << " worker threads");
+
+    // Uploads stay on this thread, the TextureCache is not thread safe
+    for (const TextureDecodeRequest& request : decodeRequests)
     {
-        case aiTextureType_BASE_COLOR:
-            meshMaterialTextureIdToSet = &meshMaterial.diffuseTextureId;
-            break;
-        case aiTextureType_METALNESS:
-            meshMaterialTextureIdToSet = &meshMaterial.metallicRoughnessTextureId;
-            break;
-        case aiTextureType_NORMALS:
-            meshMaterialTextureIdToSet = &meshMaterial.normalTextureId;
-            break;
-        case aiTextureType_EMISSIVE:
-            meshMaterialTextureIdToSet = &meshMaterial.emissiveTextureId;
-            break;
-        default:
-            MRCERR("Tried to load non-standard aiTextureType!");
+        if (!request.decoded.data)
+        {
+            MRCERR("Failed to load texture: " << request.textureName);
             exit(1);
+        }
+        GPUTextureId textureId = m_textureCache.add_texture(m_gfxDevice, request.decoded, request.textureName);
+        UNUSED(textureId);
     }
-    
-    if (!m_textureCache.is_texture_loaded_already(textureName))
+    free_decoded_textures(decodeRequests);
+}
+
+bool CPUModel::load_cooked_texture(const TextureDecodeRequest& request)
+{
+    // Embedded textures are only as fresh as the model they came from
+    const std::filesystem::path& sourcePath = request.encodedData ? m_path : request.filePath;
+    const std::filesystem::path cookedPath = cooked_texture_path(m_path, request.textureName);
+    if (is_cooked_file_stale(cookedPath, sourcePath))
     {
-        std::filesystem::path texturePath = m_path.parent_path() / std::filesystem::path(textureName);
-        int width, height, numberComponents;
-        unsigned char *data = stbi_load(texturePath.string().c_str(), &width, &height, &numberComponents, STBI_rgb_alpha); // TODO: request 4 channels from all images
-        TextureLoadingData textureLoadingData = {
-            .data = data,
-            .texSize = {width, height, 4} // TODO: force all images to have 4 channels...ignoring numberComponents for now
-        };
-        *meshMaterialTextureIdToSet  = m_textureCache.add_texture(m_gfxDevice, textureLoadingData, textureName);
-        stbi_image_free(data);
+        MRWARN("Cooked texture " << cookedPath.string() << " is older than its source, re-run the AssetCooker");
+        return false;
     }
-    else
+    Ktx2View cookedTexture;
+    if (!cookedTexture.open(cookedPath))
     {
-        *meshMaterialTextureIdToSet  = m_textureCache.get_texture_id(textureName);
+        return false;
     }
+    if (!m_gfxDevice.supports_sampled_format(cookedTexture.get_format()))
+    {
+        MRWARN("Device can't sample format " << string_VkFormat(cookedTexture.get_format()) << " of cooked texture " << request.textureName << ", falling back to RGBA8");
+        return false;
+    }
+    GPUTextureId textureId = m_textureCache.add_cooked_texture(m_gfxDevice, cookedTexture, request.textureName);
+    UNUSED(textureId);
+    return true;
 }
 
-void CPUModel::load_embedded_texture_data(const aiMaterial* material, const aiScene* scene, aiTextureType textureType, Material& meshMaterial)
+MaterialId CPUModel::add_material(std::span<const int32_t> textureIndices, std::span<const std::string> textureNames)
 {
-    aiString embeddedTextureFile;
-    material->GetTexture(textureType, 0, &embeddedTextureFile);
-    const aiTexture* texture = scene->GetEmbeddedTexture(embeddedTextureFile.C_Str());
-    std::string textureName = m_path.filename().replace_extension().string();
+    // From the glTF 2.0 spec: https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#metallic-roughness-material
 
-    GPUTextureId* meshMaterialTextureIdToSet = nullptr;
+    // "The value for each property MAY be defined using factors and/or textures (e.g., baseColorTexture and baseColorFactor). If a texture is not given, all respective texture components within this material model MUST be assumed to have a value of 1.0. If both factors and textures are present, the factor value acts as a linear multiplier for the corresponding texture values."
+    auto resolve_texture_id = [&](CookedTextureRole role, const std::string& fallbackTextureName) {
+        const int32_t textureIndex = textureIndices[static_cast<size_t>(role)];
+        return m_textureCache.get_texture_id(textureIndex == COOKED_NO_TEXTURE ? fallbackTextureName : textureNames[static_cast<size_t>(textureIndex)]);
+    };
 
-    switch(textureType)
-    {
-        case aiTextureType_BASE_COLOR:
-            textureName += std::string("_diffuse_tex");
-            meshMaterialTextureIdToSet = &meshMaterial.diffuseTextureId;
-            break;
-        case aiTextureType_METALNESS:
-            textureName += std::string("_metallic_roughness_tex");
-            meshMaterialTextureIdToSet = &meshMaterial.metallicRoughnessTextureId;
-            break;
-        case aiTextureType_NORMALS:
-            textureName += std::string("_normals_tex");
-            meshMaterialTextureIdToSet = &meshMaterial.normalTextureId;
-            break;
-        case aiTextureType_EMISSIVE:
-            textureName += std::string("_emissive_tex");
-            meshMaterialTextureIdToSet = &meshMaterial.emissiveTextureId;
-            break;
-        default:
-            MRCERR("Tried to load non-standard aiTextureType!");
-            exit(1);
-    }
-    
+    Material material;
+    material.diffuseTextureId = resolve_texture_id(CookedTextureRole::Diffuse, missingDiffuseTextureName);
+    material.metallicRoughnessTextureId = resolve_texture_id(CookedTextureRole::MetallicRoughness, default1TextureName);
+    material.normalTextureId = resolve_texture_id(CookedTextureRole::Normal, default1TextureName);
+    material.emissiveTextureId = resolve_texture_id(CookedTextureRole::Emissive, default1TextureName);
+    return m_materialCache.add_material(material);
+}
 
-    if (!m_textureCache.is_texture_loaded_already(textureName))
+void CPUModel::load_cooked_model(ThreadPool& threadPool)
+{
+    std::vector<std::string> textureNames;
+    std::vector<TextureDecodeRequest> decodeRequests;
+    for (const CookedTexture& cookedTexture : m_cookedModel.get_textures())
     {
-        int width, height, numberComponents;
-        stbi_uc* data = stbi_load_from_memory(reinterpret_cast<unsigned char*>(texture->pcData), texture->mWidth, &width, &height, &numberComponents, STBI_rgb_alpha);
-        if (!data)
+        TextureDecodeRequest& request = decodeRequests.emplace_back();
+        request.textureName = std::string(m_cookedModel.get_texture_name(cookedTexture));
+        std::span<const unsigned char> embeddedData = m_cookedModel.get_embedded_texture_data(cookedTexture);
+        if (!embeddedData.empty())
         {
-            MRCERR("Failed to load embedded texture from memory!");
-            exit(1);
+            request.encodedData = embeddedData.data(); // Decoded straight out of the mapping
+            request.encodedSize = embeddedData.size();
         }
+        else
+        {
+            request.filePath = m_path.parent_path() / std::filesystem::path(request.textureName);
+        }
+        textureNames.push_back(request.textureName);
+    }
+    load_textures(decodeRequests, threadPool);
 
-        TextureLoadingData textureLoadingData = {
-            .data = data,
-            .texSize = {width, height, 4} // TODO: force all images to have 4 channels...ignoring numberComponents for now
-        };
-        *meshMaterialTextureIdToSet = m_textureCache.add_texture(m_gfxDevice, textureLoadingData, textureName);
-        stbi_image_free(textureLoadingData.data);
+    std::vector<MaterialId> materialIds;
+    for (const CookedMaterial& cookedMaterial : m_cookedModel.get_materials())
+    {
+        materialIds.push_back(add_material(cookedMaterial.textureIndices, textureNames));
     }
-    else
+
+    for (const CookedMesh& cookedMesh : m_cookedModel.get_meshes())
+    {
+        CPUMesh& cpuMesh = m_cpuMeshes.emplace_back();
+        cpuMesh.m_vertices = m_cookedModel.get_vertices(cookedMesh);
+        cpuMesh.m_indices = m_cookedModel.get_indices(cookedMesh);
+        cpuMesh.m_materialId = materialIds[cookedMesh.materialIndex];
+        cpuMesh.m_boundsMin = glm::make_vec3(cookedMesh.boundsMin);
+        cpuMesh.m_boundsMax = glm::make_vec3(cookedMesh.boundsMax);
+    }
+    for (const CookedMeshInstance& cookedInstance : m_cookedModel.get_instances())
     {
-        *meshMaterialTextureIdToSet = m_textureCache.get_texture_id(textureName);
+        m_instances.push_back({cookedInstance.meshIndex, glm::make_mat4(cookedInstance.transform)});
     }
 }
 
-CPUMesh CPUModel::process_mesh(aiMesh *mesh, const aiScene *scene, const glm::mat4x4& transformMatrix)
+void CPUModel::load_imported_model(ThreadPool& threadPool)
 {
-    CPUMesh cpuMesh;
-    cpuMesh.m_transform = transformMatrix;
-    for (size_t i = 0; i < mesh->mNumVertices; i++)
+    std::vector<std::string> textureNames;
+    std::vector<TextureDecodeRequest> decodeRequests;
+    for (const ImportedTexture& importedTexture : m_importedModel.textures)
     {
-        Vertex vertex;
-
-        glm::vec4 worldSpaceVertex = transformMatrix * glm::vec4(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z, 1.0f);
-        vertex.position = glm::vec3(worldSpaceVertex.x, worldSpaceVertex.y, worldSpaceVertex.z);
-        // vertex.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
-        vertex.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
-        if (mesh->HasTextureCoords(0))
+        TextureDecodeRequest& request = decodeRequests.emplace_back();
+        request.textureName = importedTexture.name;
+        request.filePath = importedTexture.filePath;
+        if (!importedTexture.embeddedData.empty())
         {
-            vertex.uv_x = mesh->mTextureCoords[0][i].x;
-            vertex.uv_y = mesh->mTextureCoords[0][i].y;
+            request.encodedData = importedTexture.embeddedData.data();
+            request.encodedSize = importedTexture.embeddedData.size();
         }
+        textureNames.push_back(importedTexture.name);
+    }
+    load_textures(decodeRequests, threadPool);
 
-        // TODO:
-        // vertex.tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
-        cpuMesh.m_vertices.emplace_back(vertex);
+    std::vector<MaterialId> materialIds;
+    for (const ImportedMaterial& importedMaterial : m_importedModel.materials)
+    {
+        materialIds.push_back(add_material(importedMaterial.textureIndices, textureNames));
     }
-    for (size_t i = 0; i < mesh->mNumFaces; i++)
+
+    for (const ImportedMesh& importedMesh : m_importedModel.meshes)
     {
-        aiFace face = mesh->mFaces[i];
-        for(unsigned int j = 0; j < face.mNumIndices; j++)
-        {
-            cpuMesh.m_indices.push_back(face.mIndices[j]);
-        } 
+        CPUMesh& cpuMesh = m_cpuMeshes.emplace_back();
+        cpuMesh.m_vertices = importedMesh.vertices;
+        cpuMesh.m_indices = importedMesh.indices;
+        cpuMesh.m_materialId = materialIds[importedMesh.materialIndex];
+        cpuMesh.m_boundsMin = importedMesh.boundsMin;
+        cpuMesh.m_boundsMax = importedMesh.boundsMax;
     }
-    if(mesh->mMaterialIndex >= 0)
+    for (const ImportedMeshInstance& importedInstance : m_importedModel.instances)
     {
-        aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-        Material meshMaterial;
-
-        unsigned int materialDiffuseCount = material->GetTextureCount(aiTextureType_BASE_COLOR);
-        unsigned int materialMetallicRoughnessCount = material->GetTextureCount(aiTextureType_METALNESS);
-        unsigned int materialNormalCount = material->GetTextureCount(aiTextureType_NORMALS);
-        unsigned int materialEmissiveCount = material->GetTextureCount(aiTextureType_EMISSIVE);
-
-        aiColor4D aiColor;
-        if (material->Get(AI_MATKEY_BASE_COLOR, aiColor) == AI_SUCCESS)
-        {
-            for (Vertex& vertex : cpuMesh.m_vertices)
-            {
-                vertex.color = glm::vec4(aiColor.r, aiColor.g, aiColor.b, aiColor.a);
-            }
-        }
-        else
-        {
-            for (Vertex& vertex : cpuMesh.m_vertices)
-            {
-                vertex.color = glm::vec4(1.0f, 0.0f, 1.0f, 1.0f); // Magenta fallback
-            }
-        }
-        
-
-        // ai_real floatFactor;
-        float metallicFactor;
-        material->Get(AI_MATKEY_METALLIC_FACTOR, metallicFactor);
-        //float metallicFactor = *floatFactor;
-        //UNUSED(metallicFactor);
-
-        // material->Get(AI_MATKEY_ROUGHNESS_FACTOR, floatFactor);
-        // float roughnessFactor;
-
-        // material->Get(AI_MATKEY_EMISSIVE);
-        // glm::vec3 emissiveFactor;
-
-
-        //float normalScale;
-
-        if (m_texturesEmbedded) // .glb for example
-        {
-            
-            // const bool isCompressed = texture->mHeight == 0 ? true : false;
-            // if (isCompressed)
-            if (materialDiffuseCount > 0)
-            {
-                load_embedded_texture_data(material, scene, aiTextureType_BASE_COLOR, meshMaterial);   
-            }
-            else
-            {
-                meshMaterial.diffuseTextureId = m_textureCache.get_texture_id(missingDiffuseTextureName);
-            }
-            // else
-            // {
-            //     MRCERR("Uncompressed texture, what do?");
-            //     exit(1);
-            // }
-
-            if (materialMetallicRoughnessCount > 0)
-            {
-                load_embedded_texture_data(material, scene, aiTextureType_METALNESS, meshMaterial);
-            }
-            else
-            {
-                meshMaterial.metallicRoughnessTextureId = m_textureCache.get_texture_id(default1TextureName);
-            }
-
-            if (materialNormalCount > 0)
-            {
-                load_embedded_texture_data(material, scene, aiTextureType_NORMALS, meshMaterial);
-            }
-            else
-            {
-                meshMaterial.normalTextureId = m_textureCache.get_texture_id(default1TextureName);
-            }
-
-            if (materialEmissiveCount > 0)
-            {
-                load_embedded_texture_data(material, scene, aiTextureType_EMISSIVE, meshMaterial);
-            }
-            else
-            {
-                meshMaterial.emissiveTextureId = m_textureCache.get_texture_id(default1TextureName);
-            }
-
-
-        }
-        else
-        {
-            // TODO: When can a material have multiple textures of type diffuse?
-
-            // TODO: Right now this CPUModel class is directly uploading the textures as it parses the assimp data structure, which doesn't
-            // necessarily follow the spirit of the class name.
-            // Better possibly would be to store the texture data and queue uploading jobs after the fact, along with uploading the mesh data.
-
-            // From the glTF 2.0 spec: https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#metallic-roughness-material
-
-            // "The value for each property MAY be defined using factors and/or textures (e.g., baseColorTexture and baseColorFactor). If a texture is not given, all respective texture components within this material model MUST be assumed to have a value of 1.0. If both factors and textures are present, the factor value acts as a linear multiplier for the corresponding texture values."
-
-            // {
-            // "materials": [
-            //     {
-            //         "name": "Material0",
-            //         "pbrMetallicRoughness": {
-            //             "baseColorFactor": [ 0.5, 0.5, 0.5, 1.0 ],
-            //             "baseColorTexture": {
-            //                 "index": 1,
-            //                 "texCoord": 1
-            //             },
-            //             "metallicFactor": 1,
-            //             "roughnessFactor": 1,
-            //             "metallicRoughnessTexture": {
-            //                 "index": 2,
-            //                 "texCoord": 1
-            //             }
-            //         },
-            //         "normalTexture": {
-            //             "scale": 2,
-            //             "index": 3,
-            //             "texCoord": 1
-            //         },
-            //         "emissiveFactor": [ 0.2, 0.1, 0.0 ]
-            //     }
-            // ]
-            // }
-
-            if (materialDiffuseCount > 0)
-            {
-                load_texture_from_filename(material, aiTextureType_BASE_COLOR, meshMaterial);
-            }
-            else
-            {
-                meshMaterial.diffuseTextureId = m_textureCache.get_texture_id(missingDiffuseTextureName);
-            }
-            if (materialMetallicRoughnessCount > 0)
-            {
-                load_texture_from_filename(material, aiTextureType_METALNESS, meshMaterial);
-            }
-            else
-            {
-                meshMaterial.metallicRoughnessTextureId = m_textureCache.get_texture_id(default1TextureName);
-            }
-            if (materialNormalCount > 0)
-            {
-                load_texture_from_filename(material, aiTextureType_NORMALS, meshMaterial);
-            }
-            else
-            {
-                meshMaterial.normalTextureId = m_textureCache.get_texture_id(default1TextureName);
-            }
-            if (materialEmissiveCount > 0)
-            {
-                load_texture_from_filename(material, aiTextureType_EMISSIVE, meshMaterial);
-            }
-            else
-            {
-                meshMaterial.emissiveTextureId = m_textureCache.get_texture_id(default1TextureName);
-            }
-        }
-        cpuMesh.m_materialId = m_materialCache.add_material(meshMaterial);
+        m_instances.push_back({importedInstance.meshIndex, importedInstance.transform});
     }
-    return cpuMesh;
 }
 
-glm::mat4x4 convertAssimpMatrix(const aiMatrix4x4 &aiMat)
+void CPUModel::pack_vertices(ThreadPool& threadPool)
 {
-    return {
-        aiMat.a1, aiMat.b1, aiMat.c1, aiMat.d1,
-        aiMat.a2, aiMat.b2, aiMat.c2, aiMat.d2,
-        aiMat.a3, aiMat.b3, aiMat.c3, aiMat.d3,
-        aiMat.a4, aiMat.b4, aiMat.c4, aiMat.d4
-    };
+    m_compactVertices.resize(m_cpuMeshes.size());
+    threadPool.parallel_for(m_cpuMeshes.size(), [this](size_t meshIndex) {
+        CPUMesh& cpuMesh = m_cpuMeshes[meshIndex];
+        pack_compact_vertices(cpuMesh.m_vertices, cpuMesh.m_boundsMin, cpuMesh.m_boundsMax, m_compactVertices[meshIndex]);
+    });
+    for (size_t meshIndex = 0; meshIndex < m_cpuMeshes.size(); meshIndex++)
+    {
+        m_cpuMeshes[meshIndex].m_vertices = {};
+        m_cpuMeshes[meshIndex].m_compactVertices = m_compactVertices[meshIndex];
+    }
 }
 
-void CPUModel::process_assimp_node(aiNode *node, const aiScene *scene, const glm::mat4x4& accumulateMatrix)
-{
-    glm::mat4x4 transform = accumulateMatrix * convertAssimpMatrix(node->mTransformation);
-
+CPUModel::CPUModel(const char* _filePath, bool _texturesEmbedded, MaterialCache& _materialCache, TextureCache& _textureCache, const GfxDevice& _gfxDevice, ThreadPool& _threadPool, VertexFormat _vertexFormat) : m_materialCache(_materialCache), m_textureCache(_textureCache), m_gfxDevice(_gfxDevice), m_texturesEmbedded(_texturesEmbedded), m_filePath(_filePath), m_path(std::string(m_filePath)){
+    MR_PROFILE_ZONE("Load model");
 
-    // Decompose transform into its components
-    // glm::vec3 scale;
-    // glm::quat orientation;
-    // glm::vec3 translation;
-    // glm::vec3 skew;
-    // glm::vec4 perspective;
-    // glm::decompose(convertAssimpMatrix(node->mTransformation), scale, orientation, translation, skew, perspective);
-
-
-    // Process this node's meshes
-    for (size_t i = 0; i < node->mNumMeshes; i++)
+    const auto loadStart = std::chrono::steady_clock::now();
+    const bool bCooked = m_cookedModel.open(cooked_model_path(m_path), m_path);
+    if (bCooked)
     {
-        aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-        m_cpuMeshes.push_back(process_mesh(mesh, scene, transform));
+        load_cooked_model(_threadPool);
     }
-    // Process this node's child node(s)
-    for (size_t i = 0; i < node->mNumChildren; i++)
+    else
     {
-        process_assimp_node(node->mChildren[i], scene, transform);
+        if (!import_model_assimp(m_path, m_texturesEmbedded, m_importedModel))
+        {
+            exit(1);
+        }
+        load_imported_model(_threadPool);
     }
-}
-
-CPUModel::CPUModel(const char* _filePath, bool _texturesEmbedded, MaterialCache& _materialCache, TextureCache& _textureCache, const GfxDevice& _gfxDevice) : m_materialCache(_materialCache), m_textureCache(_textureCache), m_gfxDevice(_gfxDevice), m_texturesEmbedded(_texturesEmbedded), m_filePath(_filePath), m_path(std::string(m_filePath)){
-
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(m_filePath, aiProcess_Triangulate | aiProcess_FlipUVs);
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    if (_vertexFormat == VertexFormat::Compact)
     {
-        MRCERR("Problem loading model: " << m_filePath);
+        pack_vertices(_threadPool);
     }
-    glm::mat4x4 rootTransform = convertAssimpMatrix(scene->mRootNode->mTransformation);
-    process_assimp_node(scene->mRootNode, scene, rootTransform);
+    const auto loadEnd = std::chrono::steady_clock::now();
+    MRLOG("Loaded " << m_path.filename().string() << (bCooked ? " (cooked)" : " (Assimp, run the AssetCooker to speed this up)") << " in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(loadEnd - loadStart).count() << "ms");
 }
 
 POP_CLANG_WARNINGS
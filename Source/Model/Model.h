@@ -3,23 +3,28 @@
 #include <Common/IdTypes.h>
 #include <Texture/TextureData.h>
 #include <Material/Material.h>
+#include <Model/AssimpImport.h>
+#include <Model/CookedModel.h>
 #include <filesystem>
 
 class GfxDevice;
 class TextureCache;
 class MaterialCache;
-struct aiMesh;
-struct aiScene;
-struct aiNode;
-struct aiMaterial;
-struct aiString;
-#include <assimp/material.h>
+class ThreadPool;
+struct TextureDecodeRequest;
 #include <glm/mat4x4.hpp>
 
+/*
+ * Loads a model's textures and materials into their caches and exposes its meshes.
+ * Prefers the cooked (.mrmodel) version next to the source file, which is memory mapped so the meshes point straight into the file,
+ * and falls back to importing the source with Assimp when there is no usable cooked file.
+ * Every mesh is listed once in its local space, m_instances places them (several times for meshes the model reuses).
+ */
 struct CPUModel {
-    CPUModel(const char* _filePath, bool _texturesEmbedded, MaterialCache& _materialCache, TextureCache& _textureCache, const GfxDevice& _gfxDevice);
+    CPUModel(const char* _filePath, bool _texturesEmbedded, MaterialCache& _materialCache, TextureCache& _textureCache, const GfxDevice& _gfxDevice, ThreadPool& _threadPool, VertexFormat _vertexFormat = VertexFormat::Full);
 
-    std::vector<CPUMesh> m_cpuMeshes;
+    std::vector<CPUMesh> m_cpuMeshes; // Only valid while this CPUModel is alive
+    std::vector<CPUMeshInstance> m_instances;
 private:
     MaterialCache& m_materialCache;
     TextureCache& m_textureCache;
@@ -28,13 +33,21 @@ private:
     const char* m_filePath;
     const std::filesystem::path m_path;
 
+    // Backing storage for m_cpuMeshes, only one of these is used
+    CookedModelView m_cookedModel;
+    ImportedModel m_importedModel;
+    std::vector<std::vector<CompactVertex>> m_compactVertices; // Per mesh, VertexFormat::Compact only
+
     inline static const std::string missingDiffuseTextureName{"missing_diffuse_texture.png"};
     inline static const std::string default1TextureName{"default_1_texture.png"};
 
-
-    void load_texture_from_filename(const aiMaterial* material, aiTextureType textureType, Material& meshMaterial);
-    void load_embedded_texture_data(const aiMaterial* material, const aiScene* scene, aiTextureType textureType, Material& meshMaterial);
-    CPUMesh process_mesh(aiMesh *mesh, const aiScene *scene, const glm::mat4x4& transformMatrix);
-    void process_assimp_node(aiNode *node, const aiScene *scene, const glm::mat4x4& accumulateMatrix);
-
+    void load_cooked_model(ThreadPool& threadPool);
+    void load_imported_model(ThreadPool& threadPool);
+    /* Quantize every mesh's vertices into m_compactVertices and point the meshes at them instead */
+    void pack_vertices(ThreadPool& threadPool);
+    /* Decode every texture that isn't in the cache yet in parallel, then upload them all into the TextureCache */
+    void load_textures(std::vector<TextureDecodeRequest>& decodeRequests, ThreadPool& threadPool);
+    /* Upload the AssetCooker's block compressed version of a texture if there is an up to date one the device can sample, returns false otherwise */
+    [[nodiscard]] bool load_cooked_texture(const TextureDecodeRequest& request);
+    [[nodiscard]] MaterialId add_material(std::span<const int32_t> textureIndices, std::span<const std::string> textureNames);
 };
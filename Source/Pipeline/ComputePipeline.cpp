@@ -0,0 +1,38 @@
+#include <Pipeline/ComputePipeline.h>
+#include <Shader/Shader.h>
+#include <Common/RootDir.h>
+#include <Common/Log.h>
+#include <chrono>
+
+ComputePipeline::ComputePipeline(const GfxDevice& _gfxDevice) : Pipeline(_gfxDevice) {}
+
+void ComputePipeline::BuildPipeline(
+    const std::string& computeShaderPath,
+    std::span<VkPushConstantRange const> pushConstantRanges,
+    std::span<VkDescriptorSetLayout const> descriptorSetLayouts
+    ) {
+
+    VkShaderModule computeShaderModule;
+    load_shader_spirv_source_to_module(std::string(ROOT_DIR) + computeShaderPath, m_logicalDevice, computeShaderModule);
+
+    VkPipelineShaderStageCreateInfo computeShaderStageInfo = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, VkPipelineShaderStageCreateFlags(), VK_SHADER_STAGE_COMPUTE_BIT, computeShaderModule, "main", nullptr};
+
+    CreatePipelineLayout(pushConstantRanges, descriptorSetLayouts);
+
+    VkComputePipelineCreateInfo pipelineCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = VkPipelineCreateFlags(),
+        .stage = computeShaderStageInfo,
+        .layout = m_pipelineLayout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = 0
+    };
+
+    const auto createStart = std::chrono::steady_clock::now();
+    vkCreateComputePipelines(m_logicalDevice, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_pipeline);
+    const auto createEnd = std::chrono::steady_clock::now();
+    MRLOG("Created pipeline " << computeShaderPath << " in "
+        << std::chrono::duration_cast<std::chrono::microseconds>(createEnd - createStart).count() << "us");
+    vkDestroyShaderModule(m_logicalDevice, computeShaderModule, nullptr);
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <Pipeline/Pipeline.h>
+#include <string>
+
+class GfxDevice;
+
+class ComputePipeline final : public Pipeline {
+public:
+    ComputePipeline(const GfxDevice& _gfxDevice);
+    void BuildPipeline(
+        const std::string& computeShaderPath,
+        std::span<VkPushConstantRange const> pushConstantRanges,
+        std::span<VkDescriptorSetLayout const> descriptorSetLayouts
+        );
+    ~ComputePipeline() = default;
+};
@@ -2,6 +2,8 @@
 #include <Shader/Shader.h>
 #include <Vertex/VertexDescriptors.h> // Temp
 #include <Common/RootDir.h>
+#include <Common/Log.h>
+#include <chrono>
 
 GraphicsPipeline::GraphicsPipeline(const GfxDevice& _gfxDevice) : Pipeline(_gfxDevice) {}
 
@@ -118,7 +120,11 @@ void GraphicsPipeline::BuildPipeline(
         0
     };
 
-    vkCreateGraphicsPipelines(m_logicalDevice, {}, 1, &pipelineCreateInfo, nullptr, &m_pipeline);
+    const auto createStart = std::chrono::steady_clock::now();
+    vkCreateGraphicsPipelines(m_logicalDevice, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_pipeline);
+    const auto createEnd = std::chrono::steady_clock::now();
+    MRLOG("Created pipeline " << vertexShaderPath << " + " << fragmentShaderPath << " in "
+        << std::chrono::duration_cast<std::chrono::microseconds>(createEnd - createStart).count() << "us");
     vkDestroyShaderModule(m_logicalDevice, vertexShaderModule, nullptr);
     vkDestroyShaderModule(m_logicalDevice, fragmentShaderModule, nullptr);
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include <Pipeline/Pipeline.h>
 #include <Rendering/GfxDevice.h>
 
-Pipeline::Pipeline(const GfxDevice& device) : m_logicalDevice(device) {}
+Pipeline::Pipeline(const GfxDevice& device) : m_logicalDevice(device), m_pipelineCache(device.get_pipeline_cache().get_handle()) {}
 
 Pipeline::~Pipeline() {} // Must be provided since destructors are called in reverse order back to the base class
 
@@ -21,6 +21,7 @@ protected:
         );
 
     const VkDevice m_logicalDevice;
+    const VkPipelineCache m_pipelineCache;
     VkPipeline m_pipeline;
     VkPipelineLayout m_pipelineLayout;
 };
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "PipelineCache.h"
+#include <Common/Log.h>
+#include <vulkan/vk_enum_string_helper.h> // Doesn't work on linux?
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+
+static constexpr char PIPELINE_CACHE_MAGIC[4] = {'M', 'R', 'P', 'C'};
+static constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
+
+/* Precedes the driver's cache data in the file, the driver's own header only identifies the device and not the driver version */
+struct PipelineCacheFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t driverVersion;
+    uint32_t reserved;
+    uint64_t dataSize;
+};
+
+static bool read_file(const std::filesystem::path& path, std::vector<std::byte>& fileData) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    const std::streamsize fileSize = file.tellg();
+    if (fileSize <= 0)
+    {
+        return false;
+    }
+    fileData.resize(static_cast<size_t>(fileSize));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(fileData.data()), fileSize);
+    return file.good();
+}
+
+void PipelineCache::init(VkDevice device, VkPhysicalDevice physicalDevice, const std::filesystem::path& path) {
+    m_device = device;
+    m_path = path;
+    vkGetPhysicalDeviceProperties(physicalDevice, &m_physicalDeviceProperties);
+
+    std::vector<std::byte> fileData;
+    const bool bFileRead = read_file(m_path, fileData);
+    m_bWarm = bFileRead && is_compatible(fileData.data(), fileData.size());
+    if (bFileRead && !m_bWarm)
+    {
+        MRWARN("Pipeline cache " << m_path.string() << " is from a different device or driver, starting with an empty cache");
+    }
+
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .initialDataSize = 0,
+        .pInitialData = nullptr
+    };
+    if (m_bWarm)
+    {
+        pipelineCacheCreateInfo.initialDataSize = fileData.size() - sizeof(PipelineCacheFileHeader);
+        pipelineCacheCreateInfo.pInitialData = fileData.data() + sizeof(PipelineCacheFileHeader);
+        m_loadedSize = pipelineCacheCreateInfo.initialDataSize;
+    }
+    VkResult res = vkCreatePipelineCache(m_device, &pipelineCacheCreateInfo, nullptr, &m_pipelineCache);
+    if (res != VK_SUCCESS)
+    {
+        MRCERR(string_VkResult(res));
+        MRCERR("Failed to create pipeline cache!");
+        exit(1);
+    }
+    if (m_bWarm)
+    {
+        MRLOG("Pipeline cache: warm, loaded " << m_loadedSize / 1024 << " KB from " << m_path.string());
+    }
+    else
+    {
+        MRLOG("Pipeline cache: cold, pipelines will be compiled from scratch");
+    }
+}
+
+[[nodiscard]] bool PipelineCache::is_compatible(const std::byte* fileData, size_t fileSize) const {
+    if (fileSize < sizeof(PipelineCacheFileHeader) + sizeof(VkPipelineCacheHeaderVersionOne))
+    {
+        return false;
+    }
+    PipelineCacheFileHeader fileHeader;
+    std::memcpy(&fileHeader, fileData, sizeof(fileHeader));
+    if (std::memcmp(fileHeader.magic, PIPELINE_CACHE_MAGIC, sizeof(fileHeader.magic)) != 0
+        || fileHeader.version != PIPELINE_CACHE_VERSION
+        || fileHeader.driverVersion != m_physicalDeviceProperties.driverVersion
+        || fileHeader.dataSize != fileSize - sizeof(PipelineCacheFileHeader))
+    {
+        return false;
+    }
+
+    VkPipelineCacheHeaderVersionOne cacheHeader;
+    std::memcpy(&cacheHeader, fileData + sizeof(PipelineCacheFileHeader), sizeof(cacheHeader));
+    return cacheHeader.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne)
+        && cacheHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        && cacheHeader.vendorID == m_physicalDeviceProperties.vendorID
+        && cacheHeader.deviceID == m_physicalDeviceProperties.deviceID
+        && std::memcmp(cacheHeader.pipelineCacheUUID, m_physicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCache::save() const {
+    size_t dataSize = 0;
+    vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr);
+    std::vector<std::byte> data(dataSize);
+    VkResult res = vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data());
+    if (res != VK_SUCCESS)
+    {
+        MRWARN("Failed to read back the pipeline cache: " << string_VkResult(res));
+        return;
+    }
+
+    PipelineCacheFileHeader fileHeader = {};
+    std::memcpy(fileHeader.magic, PIPELINE_CACHE_MAGIC, sizeof(fileHeader.magic));
+    fileHeader.version = PIPELINE_CACHE_VERSION;
+    fileHeader.driverVersion = m_physicalDeviceProperties.driverVersion;
+    fileHeader.dataSize = dataSize;
+
+    std::filesystem::path tempPath = m_path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(dataSize));
+        if (!file.good())
+        {
+            MRWARN("Failed to write the pipeline cache to " << tempPath.string());
+            return;
+        }
+    }
+    std::error_code errorCode;
+    std::filesystem::rename(tempPath, m_path, errorCode);
+    if (errorCode)
+    {
+        MRWARN("Failed to replace " << m_path.string() << ": " << errorCode.message());
+        return;
+    }
+    MRLOG("Saved " << dataSize / 1024 << " KB pipeline cache to " << m_path.string());
+}
+
+void PipelineCache::cleanup() {
+    vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+    m_pipelineCache = VK_NULL_HANDLE;
+}
+
+[[nodiscard]] VkPipelineCache PipelineCache::get_handle() const { return m_pipelineCache; }
+[[nodiscard]] bool PipelineCache::is_warm() const { return m_bWarm; }
+[[nodiscard]] size_t PipelineCache::get_loaded_size() const { return m_loadedSize; }
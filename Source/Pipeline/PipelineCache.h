@@ -0,0 +1,40 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <filesystem>
+#include <cstddef>
+
+/*
+ * Device wide VkPipelineCache that every pipeline build goes through, loaded from disk on startup and written back on shutdown.
+ * A file from a different vendor, device, driver version or pipelineCacheUUID is ignored and the cache starts empty (a cold start).
+ */
+class PipelineCache
+{
+public:
+    PipelineCache() = default;
+    ~PipelineCache() = default;
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+    PipelineCache(PipelineCache&&) = delete;
+    PipelineCache& operator=(PipelineCache&&) = delete;
+
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, const std::filesystem::path& path);
+    /* Writes the cache to the path it was loaded from, through a temporary file so a crash never leaves a truncated cache */
+    void save() const;
+    void cleanup();
+
+    [[nodiscard]] VkPipelineCache get_handle() const;
+    /* Whether a compatible cache was loaded from disk, pipelines built this run should mostly skip compilation */
+    [[nodiscard]] bool is_warm() const;
+    [[nodiscard]] size_t get_loaded_size() const;
+
+private:
+    /* Checks our file header and the VkPipelineCacheHeaderVersionOne that follows it against this device */
+    [[nodiscard]] bool is_compatible(const std::byte* fileData, size_t fileSize) const;
+
+    VkDevice m_device{VK_NULL_HANDLE};
+    VkPipelineCache m_pipelineCache{VK_NULL_HANDLE};
+    VkPhysicalDeviceProperties m_physicalDeviceProperties{};
+    std::filesystem::path m_path;
+    bool m_bWarm{false};
+    size_t m_loadedSize{0};
+};
@@ -0,0 +1,119 @@
+#include "Benchmark.h"
+#include <Common/Log.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+[[nodiscard]] CameraPath make_benchmark_camera_path() {
+    return CameraPath({
+        {.timeSeconds =  0.0f, .position = glm::vec3(-11.0f, 1.5f,  0.0f), .yaw =   0.0f, .pitch =   0.0f},
+        {.timeSeconds =  4.0f, .position = glm::vec3( -2.0f, 1.5f,  1.0f), .yaw =  10.0f, .pitch =   5.0f},
+        {.timeSeconds =  8.0f, .position = glm::vec3(  9.0f, 2.0f,  0.0f), .yaw =  90.0f, .pitch =   0.0f},
+        {.timeSeconds = 11.0f, .position = glm::vec3(  9.0f, 6.0f, -3.0f), .yaw = 180.0f, .pitch = -15.0f},
+        {.timeSeconds = 16.0f, .position = glm::vec3( -9.0f, 6.0f, -3.0f), .yaw = 180.0f, .pitch = -10.0f},
+        {.timeSeconds = 19.0f, .position = glm::vec3(-11.0f, 3.0f,  0.0f), .yaw = 360.0f, .pitch =  30.0f}
+    });
+}
+
+BenchmarkRecorder::BenchmarkRecorder(uint64_t _firstFrameNumber, uint32_t _frameCount)
+    : m_firstFrameNumber(_firstFrameNumber)
+    , m_frames(_frameCount)
+    {}
+
+void BenchmarkRecorder::record_frame(uint64_t frameNumber, double cpuFrameMs, double fenceWaitMs) {
+    if (frameNumber < m_firstFrameNumber || frameNumber - m_firstFrameNumber >= m_frames.size())
+    {
+        return;
+    }
+    FrameTiming& frame = m_frames[frameNumber - m_firstFrameNumber];
+    frame.cpuFrameMs = cpuFrameMs;
+    frame.fenceWaitMs = fenceWaitMs;
+}
+
+void BenchmarkRecorder::set_gpu_time(uint64_t frameNumber, double gpuFrameMs) {
+    if (frameNumber < m_firstFrameNumber || frameNumber - m_firstFrameNumber >= m_frames.size())
+    {
+        return;
+    }
+    m_frames[frameNumber - m_firstFrameNumber].gpuFrameMs = gpuFrameMs;
+}
+
+// Nearest rank on sorted values, so every percentile is a time some frame actually took
+static double percentile(const std::vector<double>& sortedValues, double percent) {
+    const size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sortedValues.size())));
+    return sortedValues[std::clamp<size_t>(rank, 1, sortedValues.size()) - 1];
+}
+
+static void write_statistics(std::ofstream& file, const char* name, std::vector<double> values, bool bLast) {
+    file << "  \"" << name << "\": {\"samples\": " << values.size();
+    if (!values.empty())
+    {
+        std::sort(values.begin(), values.end());
+        double total = 0.0;
+        for (const double value : values)
+        {
+            total += value;
+        }
+        file << ", \"p50\": " << percentile(values, 50.0)
+            << ", \"p95\": " << percentile(values, 95.0)
+            << ", \"p99\": " << percentile(values, 99.0)
+            << ", \"max\": " << values.back()
+            << ", \"mean\": " << total / static_cast<double>(values.size());
+    }
+    file << "}" << (bLast ? "\n" : ",\n");
+}
+
+static std::string escape_json(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+[[nodiscard]] bool BenchmarkRecorder::write_json(const std::filesystem::path& path, const BenchmarkInfo& info) const {
+    std::vector<double> cpuFrameMs;
+    std::vector<double> fenceWaitMs;
+    std::vector<double> gpuFrameMs;
+    for (const FrameTiming& frame : m_frames)
+    {
+        if (frame.cpuFrameMs >= 0.0)
+        {
+            cpuFrameMs.push_back(frame.cpuFrameMs);
+            fenceWaitMs.push_back(frame.fenceWaitMs);
+        }
+        if (frame.gpuFrameMs >= 0.0)
+        {
+            gpuFrameMs.push_back(frame.gpuFrameMs);
+        }
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        MRWARN("Failed to open " << path.string() << " for writing");
+        return false;
+    }
+    file << "{\n"
+        << "  \"device\": \"" << escape_json(info.deviceName) << "\",\n"
+        << "  \"width\": " << info.width << ",\n"
+        << "  \"height\": " << info.height << ",\n"
+        << "  \"gpuDrivenRendering\": " << (info.bGpuDrivenRendering ? "true" : "false") << ",\n"
+        << "  \"tiledLighting\": " << (info.bTiledLighting ? "true" : "false") << ",\n"
+        << "  \"timestepSeconds\": " << BENCHMARK_TIMESTEP_SECONDS << ",\n"
+        << "  \"warmupFrames\": " << BENCHMARK_WARMUP_FRAMES << ",\n"
+        << "  \"frames\": " << cpuFrameMs.size() << ",\n";
+    write_statistics(file, "cpuFrameMs", cpuFrameMs, false);
+    write_statistics(file, "fenceWaitMs", fenceWaitMs, false);
+    write_statistics(file, "gpuFrameMs", gpuFrameMs, true);
+    file << "}\n";
+
+    MRLOG("Benchmark: recorded " << cpuFrameMs.size() << " frames, results written to " << path.string());
+    return file.good();
+}
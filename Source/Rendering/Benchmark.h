@@ -0,0 +1,49 @@
+#pragma once
+#include <Camera/CameraPath.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+inline constexpr float BENCHMARK_TIMESTEP_SECONDS = 1.0f / 60.0f; // Simulated time per frame, independent of how long frames really take
+inline constexpr uint32_t BENCHMARK_WARMUP_FRAMES = 60; // Rendered at the start of the path but not recorded, first use costs (pipeline and driver caches) land here
+
+/* Flythrough of Sponza: down the nave, up to the gallery and back along it, ending on the ceiling */
+[[nodiscard]] CameraPath make_benchmark_camera_path();
+
+/* Written into the results so runs from different builds or settings can be told apart */
+struct BenchmarkInfo {
+    std::string deviceName;
+    uint32_t width;
+    uint32_t height;
+    bool bGpuDrivenRendering;
+    bool bTiledLighting;
+};
+
+/*
+ * Per frame timings of a benchmark run, summarised as p50/p95/p99/max/mean JSON.
+ * The GPU time of a frame is only known a couple of frames later (GpuProfiler reads timestamps back without stalling),
+ * so it is attached by frame number once available. Frames without one are left out of the GPU statistics.
+ */
+class BenchmarkRecorder
+{
+public:
+    BenchmarkRecorder(uint64_t _firstFrameNumber, uint32_t _frameCount);
+
+    /* cpuFrameMs is the whole frame on the main thread, fence wait included */
+    void record_frame(uint64_t frameNumber, double cpuFrameMs, double fenceWaitMs);
+    /* Ignores frames outside the recorded range */
+    void set_gpu_time(uint64_t frameNumber, double gpuFrameMs);
+
+    [[nodiscard]] bool write_json(const std::filesystem::path& path, const BenchmarkInfo& info) const;
+
+private:
+    struct FrameTiming {
+        double cpuFrameMs{-1.0}; // Negative until recorded
+        double fenceWaitMs{-1.0};
+        double gpuFrameMs{-1.0};
+    };
+
+    uint64_t m_firstFrameNumber;
+    std::vector<FrameTiming> m_frames;
+};
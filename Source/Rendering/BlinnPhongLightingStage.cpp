@@ -24,6 +24,7 @@ BlinnPhongLightingStage::BlinnPhongLightingStage(
     GPUTextureId _metallicRoughnessRTId
     )
     : StageBase(_gfxDevice)
+    , m_extent(_gfxDevice.get_render_extent())
     , m_textureCache(_textureCache)
     , m_globalDescriptorPool(_globalDescriptorPool)
     , m_bindlessDescriptorSet(_bindlessDescriptorSet)
@@ -153,8 +154,10 @@ BlinnPhongLightingStage::~BlinnPhongLightingStage() {}
 
 void BlinnPhongLightingStage::Draw(VkCommandBuffer cmdBuffer, VkDeviceAddress sceneDataBufferAddress) {
 
-    vkCmdSetViewport(cmdBuffer, 0, 1, &DEFAULT_VIEWPORT_FULLSCREEN);
-    vkCmdSetScissor(cmdBuffer, 0, 1, &DEFAULT_SCISSOR_FULLSCREEN);
+    const VkViewport viewport = viewport_fullscreen(m_extent);
+    const VkRect2D scissor = scissor_fullscreen(m_extent);
+    vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
 
     vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.get_pipeline_handle());
 
@@ -167,7 +170,6 @@ void BlinnPhongLightingStage::Draw(VkCommandBuffer cmdBuffer, VkDeviceAddress sc
 
     // TODO: different push constants template, just using this for the sceneBuffer for now
     DefaultPushConstants pushConstants;
-    pushConstants.model = glm::mat4(0.0f);
     pushConstants.sceneDataBufferAddress = sceneDataBufferAddress;
     pushConstants.materialId = 0;
     vkCmdPushConstants(cmdBuffer, m_pipeline.get_pipeline_layout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstants), &pushConstants);
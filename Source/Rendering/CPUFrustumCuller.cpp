@@ -0,0 +1,33 @@
+#include <Rendering/CPUFrustumCuller.h>
+#include <Camera/Frustum.h>
+#include <Mesh/RenderMeshComponent.h>
+#include <Mesh/Mesh.h>
+#include <Common/CpuProfiler.h>
+#include <vector>
+
+void CPUFrustumCuller::update_world_bounds(std::span<const RenderMeshComponent> renderMeshComponents) {
+    m_bounds.resize(static_cast<uint32_t>(renderMeshComponents.size()));
+    for (uint32_t i = 0; i < m_bounds.count; i++)
+    {
+        const RenderMeshComponent& renderMeshComponent = renderMeshComponents[i];
+        const GPUMesh& gpuMesh = renderMeshComponent.get_mesh();
+        m_bounds.set(i, renderMeshComponent.m_transformMatrix, gpuMesh.boundsMin, gpuMesh.boundsMax);
+    }
+}
+
+[[nodiscard]] std::span<const uint32_t> CPUFrustumCuller::cull(const Frustum& frustum, std::span<const RenderMeshComponent> renderMeshComponents) {
+    MR_PROFILE_ZONE("CPU frustum culling");
+    update_world_bounds(renderMeshComponents);
+    frustum_cull(frustum, m_bounds, m_visibleIndices);
+    std::erase_if(m_visibleIndices, [renderMeshComponents](uint32_t objectIndex) { return renderMeshComponents[objectIndex].get_mesh().indexCount == 0; });
+    m_culledCount = m_bounds.count - static_cast<uint32_t>(m_visibleIndices.size());
+    return m_visibleIndices;
+}
+
+[[nodiscard]] uint32_t CPUFrustumCuller::get_visible_count() const {
+    return static_cast<uint32_t>(m_visibleIndices.size());
+}
+
+[[nodiscard]] uint32_t CPUFrustumCuller::get_culled_count() const {
+    return m_culledCount;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <Camera/FrustumCull.h>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+struct Frustum;
+struct RenderMeshComponent;
+
+/*
+ * Frustum culls RenderMeshComponents on the CPU for the non GPU driven path.
+ * World space AABBs are kept as CullBounds (structure of arrays) so the plane tests run on 4 boxes at a time with SSE (scalar elsewhere).
+ */
+class CPUFrustumCuller
+{
+public:
+    CPUFrustumCuller() = default;
+    ~CPUFrustumCuller() = default;
+    CPUFrustumCuller(const CPUFrustumCuller&) = delete;
+    CPUFrustumCuller& operator=(const CPUFrustumCuller&) = delete;
+    CPUFrustumCuller(CPUFrustumCuller&&) = delete;
+    CPUFrustumCuller& operator=(CPUFrustumCuller&&) = delete;
+
+    /* Returns the indices of the visible (and non empty) components, valid until the next call */
+    [[nodiscard]] std::span<const uint32_t> cull(const Frustum& frustum, std::span<const RenderMeshComponent> renderMeshComponents);
+
+    [[nodiscard]] uint32_t get_visible_count() const;
+    [[nodiscard]] uint32_t get_culled_count() const;
+
+private:
+    void update_world_bounds(std::span<const RenderMeshComponent> renderMeshComponents);
+
+    CullBounds m_bounds;
+    std::vector<uint32_t> m_visibleIndices;
+    uint32_t m_culledCount{0};
+};
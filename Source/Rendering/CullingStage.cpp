@@ -0,0 +1,47 @@
+#include "CullingStage.h"
+#include <Rendering/GfxDevice.h>
+#include <Rendering/GPUScene.h>
+#include <Rendering/FrameAllocator.h>
+#include <Camera/Frustum.h>
+
+CullingStage::CullingStage(const GfxDevice& _gfxDevice)
+    : StageBase(_gfxDevice)
+    , m_pipeline(m_gfxDevice)
+    {
+        m_pipeline.BuildPipeline(m_computeShaderPath, m_pushConstantRanges, {});
+    }
+
+CullingStage::~CullingStage() {}
+
+void CullingStage::ClearDrawCounts(VkCommandBuffer cmdBuffer, const GPUScene& gpuScene) {
+    vkCmdFillBuffer(cmdBuffer, gpuScene.get_draw_count_buffer().buffer, 0, VK_WHOLE_SIZE, 0);
+}
+
+void CullingStage::Dispatch(VkCommandBuffer cmdBuffer, FrameAllocator& frameAllocator, const GPUScene& gpuScene, const Frustum& frustum) {
+    CullData cullData;
+    for (size_t i = 0; i < frustum.planes.size(); i++)
+    {
+        cullData.frustumPlanes[i] = frustum.planes[i];
+    }
+    cullData.objectCount = gpuScene.get_object_count();
+    cullData.bCompact = is_compacting() ? 1 : 0;
+
+    CullPushConstants pushConstants;
+    pushConstants.cullDataAddress = frameAllocator.push(cullData).gpuAddress;
+    pushConstants.objectBufferAddress = gpuScene.get_object_buffer_address();
+    pushConstants.drawCommandBufferAddress = gpuScene.get_draw_command_buffer().gpuAddress;
+    pushConstants.drawCountBufferAddress = gpuScene.get_draw_count_buffer().gpuAddress;
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline.get_pipeline_handle());
+    vkCmdPushConstants(cmdBuffer, m_pipeline.get_pipeline_layout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(cmdBuffer, (cullData.objectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+}
+
+[[nodiscard]] bool CullingStage::is_compacting() const {
+    return m_gfxDevice.get_draw_indexed_indirect_count() != nullptr;
+}
+
+void CullingStage::Cleanup() {
+    vkDestroyPipelineLayout(m_gfxDevice, m_pipeline.get_pipeline_layout(), nullptr);
+    vkDestroyPipeline(m_gfxDevice, m_pipeline.get_pipeline_handle(), nullptr);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <Pipeline/ComputePipeline.h>
+#include <Rendering/StageBase.h>
+#include <glm/glm.hpp>
+#include <array>
+
+class GfxDevice;
+class GPUScene;
+class FrameAllocator;
+struct Frustum;
+
+/* Per frame culling parameters, matches CullDataBuffer in cull.comp (scalar layout) */
+struct CullData {
+    glm::vec4 frustumPlanes[6];
+    uint32_t objectCount;
+    uint32_t bCompact;
+};
+
+struct CullPushConstants {
+    VkDeviceAddress cullDataAddress;
+    VkDeviceAddress objectBufferAddress;
+    VkDeviceAddress drawCommandBufferAddress;
+    VkDeviceAddress drawCountBufferAddress;
+
+    static constexpr VkPushConstantRange range() {
+        VkPushConstantRange cullPushConstantRange = {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset = 0,
+            .size = sizeof(CullPushConstants)
+        };
+        return cullPushConstantRange;
+    }
+};
+
+/*
+ * Frustum culls every GPUScene object in a compute shader and writes the draw commands GBufferStage::DrawIndirect consumes.
+ * With VK_KHR_draw_indirect_count visible draws are compacted per mesh page and counted,
+ * otherwise each object keeps its own command and culled objects get an instanceCount of 0.
+ */
+class CullingStage final : public StageBase {
+
+    inline static constexpr std::array<VkPushConstantRange, 1> m_pushConstantRanges = {CullPushConstants::range()};
+    inline static constexpr uint32_t WORKGROUP_SIZE = 64; // local_size_x in cull.comp
+
+public:
+    CullingStage(const GfxDevice& _gfxDevice);
+    ~CullingStage();
+    CullingStage(const CullingStage&) = delete;
+    CullingStage& operator=(const CullingStage&) = delete;
+
+    /* Only needed when compacting, the counts are accumulated with atomics */
+    void ClearDrawCounts(VkCommandBuffer cmdBuffer, const GPUScene& gpuScene);
+    /* Writes the draw commands (and counts), the caller orders this against the clear and the indirect draws */
+    void Dispatch(VkCommandBuffer cmdBuffer, FrameAllocator& frameAllocator, const GPUScene& gpuScene, const Frustum& frustum);
+    /* Whether visible draws are packed and counted (VK_KHR_draw_indirect_count), otherwise the count buffer is unused */
+    [[nodiscard]] bool is_compacting() const;
+    void Cleanup() override;
+
+private:
+    const std::string m_computeShaderPath = std::string("Shaders/cull.comp.spv");
+public:
+    ComputePipeline m_pipeline;
+};
@@ -0,0 +1,102 @@
+#include <Rendering/FrameAllocator.h>
+#include <Rendering/GfxDevice.h>
+#include <Common/Log.h>
+#include <vulkan/vk_enum_string_helper.h> // Doesn't work on linux?
+
+void FrameAllocator::init(const GfxDevice& gfxDevice, VkDeviceSize chunkSize) {
+    m_device = gfxDevice;
+    m_allocator = gfxDevice.m_vmaAllocator;
+    m_chunkSize = chunkSize;
+    for (FrameChunks& frame : m_frames)
+    {
+        frame.allocator = ChunkedLinearAllocator(m_chunkSize);
+        add_chunk_buffers(frame);
+    }
+}
+
+void FrameAllocator::begin_frame(uint32_t frameInFlightIndex) {
+    m_frameIndex = frameInFlightIndex;
+    m_frames[m_frameIndex].allocator.reset();
+}
+
+[[nodiscard]] FrameAllocation FrameAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    FrameChunks& frame = m_frames[m_frameIndex];
+    const ChunkedAllocation chunkAllocation = frame.allocator.allocate(size, alignment);
+    add_chunk_buffers(frame);
+
+    const AllocatedBuffer& buffer = frame.buffers[chunkAllocation.chunkIndex];
+    FrameAllocation allocation;
+    allocation.cpuAddress = static_cast<char*>(buffer.mappedData) + chunkAllocation.offset;
+    allocation.gpuAddress = buffer.gpuAddress + chunkAllocation.offset;
+    allocation.buffer = buffer.buffer;
+    allocation.offset = chunkAllocation.offset;
+    return allocation;
+}
+
+[[nodiscard]] VkDeviceSize FrameAllocator::get_frame_bytes_used() const {
+    return m_frames[m_frameIndex].allocator.get_bytes_used();
+}
+
+[[nodiscard]] VkDeviceSize FrameAllocator::get_total_bytes_reserved() const {
+    VkDeviceSize total = 0;
+    for (const FrameChunks& frame : m_frames)
+    {
+        total += frame.allocator.get_bytes_reserved();
+    }
+    return total;
+}
+
+void FrameAllocator::cleanup(const GfxDevice& gfxDevice) {
+    for (FrameChunks& frame : m_frames)
+    {
+        for (AllocatedBuffer& buffer : frame.buffers)
+        {
+            buffer.cleanup(gfxDevice.m_vmaAllocator);
+        }
+        frame.buffers.clear();
+        frame.allocator = ChunkedLinearAllocator();
+    }
+}
+
+void FrameAllocator::add_chunk_buffers(FrameChunks& frame) {
+    while (frame.buffers.size() < frame.allocator.get_chunk_count())
+    {
+        add_chunk_buffer(frame, frame.allocator.get_chunk_size(static_cast<uint32_t>(frame.buffers.size())));
+    }
+}
+
+void FrameAllocator::add_chunk_buffer(FrameChunks& frame, VkDeviceSize size) {
+    AllocatedBuffer& buffer = frame.buffers.emplace_back();
+
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = size;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
+
+    // Mapped for the lifetime of the buffer, prefer device local (ReBAR / UMA) if the device has host visible VRAM
+    // Coherent so nothing has to be flushed before submit
+    VmaAllocationCreateInfo vmaAllocInfo = {};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    vmaAllocInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    VmaAllocationInfo allocationInfo = {};
+    VkResult res = vmaCreateBuffer(m_allocator, &bufferCreateInfo, &vmaAllocInfo, &buffer.buffer, &buffer.allocation, &allocationInfo);
+    if (res != VK_SUCCESS) {
+        MRCERR(string_VkResult(res));
+        MRCERR("Could not allocate frame allocator chunk!");
+        exit(1);
+    }
+    buffer.mappedData = allocationInfo.pMappedData;
+
+    VkBufferDeviceAddressInfoKHR addressInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR,
+        .buffer = buffer.buffer
+    };
+    buffer.gpuAddress = vkGetBufferDeviceAddress(m_device, &addressInfo);
+
+    if (frame.buffers.size() > 1)
+    {
+        MRLOG("Frame allocator grew to " << frame.buffers.size() << " chunks for this frame in flight");
+    }
+}
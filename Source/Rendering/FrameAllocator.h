@@ -0,0 +1,74 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <Wrappers/Buffer.h>
+#include <Common/Config.h>
+#include <Common/ChunkedLinearAllocator.h>
+#include <IncludeHelpers/VmaIncludes.h>
+#include <array>
+#include <vector>
+#include <span>
+#include <cstring>
+
+class GfxDevice;
+
+/* A chunk of this frame's memory, write through cpuAddress and hand gpuAddress to shaders (buffer_reference) */
+struct FrameAllocation {
+    void* cpuAddress{nullptr};
+    VkDeviceAddress gpuAddress{0};
+    VkBuffer buffer{VK_NULL_HANDLE};
+    VkDeviceSize offset{0};
+};
+
+/*
+ * Linear allocator for data that is rewritten every frame (scene data, lights, per draw data).
+ * Each frame in flight owns a ChunkedLinearAllocator backed by persistently mapped buffers, begin_frame() rewinds that frame's chunks once its fence has been waited on.
+ * When a frame runs out of room a new chunk is appended and kept for later frames, so the allocator grows to the high water mark.
+ */
+class FrameAllocator
+{
+public:
+    FrameAllocator() = default;
+    ~FrameAllocator() = default;
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+    FrameAllocator(FrameAllocator&&) = delete;
+    FrameAllocator& operator=(FrameAllocator&&) = delete;
+
+    void init(const GfxDevice& gfxDevice, VkDeviceSize chunkSize);
+    /* Only call once the frame's fence has signalled, everything handed out for this frame index last time is reused */
+    void begin_frame(uint32_t frameInFlightIndex);
+    [[nodiscard]] FrameAllocation allocate(VkDeviceSize size, VkDeviceSize alignment = DEFAULT_ALIGNMENT);
+
+    template<typename T>
+    [[nodiscard]] FrameAllocation push(std::span<const T> data) {
+        FrameAllocation allocation = allocate(data.size_bytes(), alignof(T) > DEFAULT_ALIGNMENT ? alignof(T) : DEFAULT_ALIGNMENT);
+        memcpy(allocation.cpuAddress, data.data(), data.size_bytes());
+        return allocation;
+    }
+    template<typename T>
+    [[nodiscard]] FrameAllocation push(const T& data) {
+        return push(std::span<const T>(&data, 1));
+    }
+
+    [[nodiscard]] VkDeviceSize get_frame_bytes_used() const;
+    [[nodiscard]] VkDeviceSize get_total_bytes_reserved() const;
+    void cleanup(const GfxDevice& gfxDevice);
+
+private:
+    inline static constexpr VkDeviceSize DEFAULT_ALIGNMENT = 16; // Enough for vec4/mat4 members under scalar and std430 layouts
+
+    struct FrameChunks {
+        ChunkedLinearAllocator allocator;
+        std::vector<AllocatedBuffer> buffers; // One per allocator chunk
+    };
+
+    /* Create buffers for chunks the allocator appended since the last call */
+    void add_chunk_buffers(FrameChunks& frame);
+    void add_chunk_buffer(FrameChunks& frame, VkDeviceSize size);
+
+    VkDevice m_device{VK_NULL_HANDLE};
+    VmaAllocator m_allocator{VK_NULL_HANDLE};
+    VkDeviceSize m_chunkSize{0};
+    std::array<FrameChunks, MAX_FRAMES_IN_FLIGHT> m_frames;
+    uint32_t m_frameIndex{0};
+};
@@ -1,6 +1,8 @@
 #include "GBufferStage.h"
 #include <Rendering/GfxDevice.h>
-#include <Mesh/RenderMeshComponent.h>
+#include <Rendering/InstanceBatcher.h>
+#include <Mesh/MeshCache.h>
+#include <Rendering/GPUScene.h>
 #include <Common/Defaults.h>
 
 GBufferStage::GBufferStage(
@@ -10,10 +12,15 @@ GBufferStage::GBufferStage(
     VkDescriptorSet _bindlessDescriptorSet)
     : StageBase(_gfxDevice)
     , m_bindlessDescriptorSet(_bindlessDescriptorSet)
+    , m_extent(_gfxDevice.get_render_extent())
     , m_pipeline(m_gfxDevice)
+    , m_indirectPipeline(m_gfxDevice)
+    , m_compactPipeline(m_gfxDevice)
+    , m_compactIndirectPipeline(m_gfxDevice)
     {
 
         VertexInputDescription vertexDescription = VertexInputDescription::get_default_vertex_description();
+        VertexInputDescription compactVertexDescription = VertexInputDescription::get_compact_vertex_description();
         std::array<VkDescriptorSetLayout, 1> descriptorSetLayouts = {{_bindlessDescriptorSetLayout}};
         m_pipeline.BuildPipeline(
             _pipelineRenderingCreateInfo
@@ -23,35 +30,142 @@ GBufferStage::GBufferStage(
             , descriptorSetLayouts
             , m_extent
             );
+        m_indirectPipeline.BuildPipeline(
+            _pipelineRenderingCreateInfo
+            , m_indirectVertexShaderPath, m_fragmentShaderPath
+            , vertexDescription
+            , m_pushConstantRanges
+            , descriptorSetLayouts
+            , m_extent
+            );
+        m_compactPipeline.BuildPipeline(
+            _pipelineRenderingCreateInfo
+            , m_compactVertexShaderPath, m_fragmentShaderPath
+            , compactVertexDescription
+            , m_pushConstantRanges
+            , descriptorSetLayouts
+            , m_extent
+            );
+        m_compactIndirectPipeline.BuildPipeline(
+            _pipelineRenderingCreateInfo
+            , m_compactIndirectVertexShaderPath, m_fragmentShaderPath
+            , compactVertexDescription
+            , m_pushConstantRanges
+            , descriptorSetLayouts
+            , m_extent
+            );
     }
 
 GBufferStage::~GBufferStage() {}
 
-void GBufferStage::Draw(VkCommandBuffer cmdBuffer, VkDeviceAddress sceneDataBufferAddress, std::span<RenderMeshComponent> renderMeshComponents) {
+[[nodiscard]] const GraphicsPipeline& GBufferStage::get_pipeline(VertexFormat vertexFormat) const {
+    return vertexFormat == VertexFormat::Compact ? m_compactPipeline : m_pipeline;
+}
+
+[[nodiscard]] const GraphicsPipeline& GBufferStage::get_indirect_pipeline(VertexFormat vertexFormat) const {
+    return vertexFormat == VertexFormat::Compact ? m_compactIndirectPipeline : m_indirectPipeline;
+}
+
+void GBufferStage::Draw(VkCommandBuffer cmdBuffer, VkDeviceAddress sceneDataBufferAddress, VkDeviceAddress instanceTransformBufferAddress, const MeshCache& meshCache, std::span<const InstanceBatch> batches) {
 
-    vkCmdSetViewport(cmdBuffer, 0, 1, &DEFAULT_VIEWPORT_FULLSCREEN);
-    vkCmdSetScissor(cmdBuffer, 0, 1, &DEFAULT_SCISSOR_FULLSCREEN);
+    const VkViewport viewport = viewport_fullscreen(m_extent);
+    const VkRect2D scissor = scissor_fullscreen(m_extent);
+    vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
 
     vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.get_pipeline_handle());
 
-    // Bindless descriptor set shared for color pass
+    // Bindless descriptor set shared for color pass, the compact pipeline's layout is compatible so it stays bound
     vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 
        m_pipeline.get_pipeline_layout(), 
        0, 1, &m_bindlessDescriptorSet, 0, nullptr);
 
-    for(const RenderMeshComponent& renderMeshComponent : renderMeshComponents)
+    // Meshes share a handful of big buffers, so only rebind when the page changes
+    uint32_t boundPageIndex = std::numeric_limits<uint32_t>::max();
+    VertexFormat boundVertexFormat = VertexFormat::Full;
+    for(const InstanceBatch& batch : batches)
     {
+        const GPUMesh& gpuMesh = meshCache.get_mesh(batch.meshId);
+        if (gpuMesh.indexCount == 0)
+        {
+            continue;
+        }
+        if (gpuMesh.pageIndex != boundPageIndex)
+        {
+            meshCache.bind_page(cmdBuffer, gpuMesh.pageIndex);
+            boundPageIndex = gpuMesh.pageIndex;
+        }
+        if (gpuMesh.vertexFormat != boundVertexFormat)
+        {
+            vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, get_pipeline(gpuMesh.vertexFormat).get_pipeline_handle());
+            boundVertexFormat = gpuMesh.vertexFormat;
+        }
+
         DefaultPushConstants pushConstants;
-        pushConstants.model = renderMeshComponent.m_transformMatrix;
         pushConstants.sceneDataBufferAddress = sceneDataBufferAddress;
-        pushConstants.materialId = renderMeshComponent.m_materialId;
+        pushConstants.materialId = batch.materialId;
+        pushConstants.instanceTransformBufferAddress = instanceTransformBufferAddress;
+        pushConstants.positionDequantOffset = glm::vec4(gpuMesh.boundsMin, 0.0f);
+        pushConstants.positionDequantScale = glm::vec4(gpuMesh.boundsMax - gpuMesh.boundsMin, 0.0f);
         vkCmdPushConstants(cmdBuffer, m_pipeline.get_pipeline_layout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstants), &pushConstants);
 
-        renderMeshComponent.bind_mesh_buffers_and_draw(cmdBuffer, std::span<const VkDescriptorSet>());
+        vkCmdDrawIndexed(cmdBuffer, gpuMesh.indexCount, batch.instanceCount, gpuMesh.firstIndex, static_cast<int32_t>(gpuMesh.vertexOffset), batch.firstInstance);
+    }
+}
+
+void GBufferStage::DrawIndirect(VkCommandBuffer cmdBuffer, VkDeviceAddress sceneDataBufferAddress, const MeshCache& meshCache, const GPUScene& gpuScene) {
+
+    const VkViewport viewport = viewport_fullscreen(m_extent);
+    const VkRect2D scissor = scissor_fullscreen(m_extent);
+    vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_indirectPipeline.get_pipeline_handle());
+
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 
+       m_indirectPipeline.get_pipeline_layout(), 
+       0, 1, &m_bindlessDescriptorSet, 0, nullptr);
+
+    // Transform and material come from the object buffer, so one push covers every draw
+    DefaultPushConstants pushConstants;
+    pushConstants.sceneDataBufferAddress = sceneDataBufferAddress;
+    pushConstants.objectBufferAddress = gpuScene.get_object_buffer_address();
+    vkCmdPushConstants(cmdBuffer, m_indirectPipeline.get_pipeline_layout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstants), &pushConstants);
+
+    const VkBuffer drawCommandBuffer = gpuScene.get_draw_command_buffer().buffer;
+    const VkBuffer drawCountBuffer = gpuScene.get_draw_count_buffer().buffer;
+    const PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = m_gfxDevice.get_draw_indexed_indirect_count();
+    constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    VertexFormat boundVertexFormat = VertexFormat::Full;
+    for (const PageDrawRange& pageDrawRange : gpuScene.get_page_draw_ranges())
+    {
+        const VertexFormat pageVertexFormat = meshCache.get_page_vertex_format(pageDrawRange.pageIndex);
+        if (pageVertexFormat != boundVertexFormat)
+        {
+            vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, get_indirect_pipeline(pageVertexFormat).get_pipeline_handle());
+            boundVertexFormat = pageVertexFormat;
+        }
+        meshCache.bind_page(cmdBuffer, pageDrawRange.pageIndex);
+        const VkDeviceSize drawOffset = static_cast<VkDeviceSize>(pageDrawRange.firstDraw) * stride;
+        if (drawIndexedIndirectCount)
+        {
+            drawIndexedIndirectCount(cmdBuffer, drawCommandBuffer, drawOffset, drawCountBuffer, pageDrawRange.pageIndex * sizeof(uint32_t), pageDrawRange.maxDrawCount, stride);
+        }
+        else
+        {
+            // Culled objects were written with an instanceCount of 0
+            vkCmdDrawIndexedIndirect(cmdBuffer, drawCommandBuffer, drawOffset, pageDrawRange.maxDrawCount, stride);
+        }
     }
 }
 
 void GBufferStage::Cleanup() {
+    vkDestroyPipelineLayout(m_gfxDevice, m_compactIndirectPipeline.get_pipeline_layout(), nullptr);
+    vkDestroyPipeline(m_gfxDevice, m_compactIndirectPipeline.get_pipeline_handle(), nullptr);
+    vkDestroyPipelineLayout(m_gfxDevice, m_compactPipeline.get_pipeline_layout(), nullptr);
+    vkDestroyPipeline(m_gfxDevice, m_compactPipeline.get_pipeline_handle(), nullptr);
+    vkDestroyPipelineLayout(m_gfxDevice, m_indirectPipeline.get_pipeline_layout(), nullptr);
+    vkDestroyPipeline(m_gfxDevice, m_indirectPipeline.get_pipeline_handle(), nullptr);
     vkDestroyPipelineLayout(m_gfxDevice, m_pipeline.get_pipeline_layout(), nullptr);
     vkDestroyPipeline(m_gfxDevice, m_pipeline.get_pipeline_handle(), nullptr);
 }
\ No newline at end of file
@@ -4,10 +4,13 @@
 #include <Common/IdTypes.h>
 #include <Common/Config.h>
 #include <Rendering/StageBase.h>
+#include <Vertex/Vertex.h>
 #include <array>
 
 class GfxDevice;
-struct RenderMeshComponent;
+struct InstanceBatch;
+class MeshCache;
+class GPUScene;
 
 class GBufferStage final : public StageBase {
 
@@ -25,15 +28,28 @@ public:
     GBufferStage(const GBufferStage&) = delete;
     GBufferStage& operator=(const GBufferStage&) = delete;
 
-    void Draw(VkCommandBuffer cmdBuffer, VkDeviceAddress sceneDataBufferAddress, std::span<RenderMeshComponent> renderMeshComponents);
+    /* One instanced draw per batch, instanceTransformBufferAddress is the InstanceBatcher's transform buffer the batches index into */
+    void Draw(VkCommandBuffer cmdBuffer, VkDeviceAddress sceneDataBufferAddress, VkDeviceAddress instanceTransformBufferAddress, const MeshCache& meshCache, std::span<const InstanceBatch> batches);
+    /* Draws the commands CullingStage wrote for gpuScene this frame, one indirect draw per mesh page */
+    void DrawIndirect(VkCommandBuffer cmdBuffer, VkDeviceAddress sceneDataBufferAddress, const MeshCache& meshCache, const GPUScene& gpuScene);
     void Cleanup() override;
 
 private:
+    /* Pages hold a single vertex format, so draws switch pipeline whenever the page's format changes */
+    [[nodiscard]] const GraphicsPipeline& get_pipeline(VertexFormat vertexFormat) const;
+    [[nodiscard]] const GraphicsPipeline& get_indirect_pipeline(VertexFormat vertexFormat) const;
+
     const std::string m_vertexShaderPath = std::string("Shaders/triangle_mesh.vert.spv");
+    const std::string m_indirectVertexShaderPath = std::string("Shaders/gpu_driven_mesh.vert.spv");
+    const std::string m_compactVertexShaderPath = std::string("Shaders/triangle_mesh_compact.vert.spv");
+    const std::string m_compactIndirectVertexShaderPath = std::string("Shaders/gpu_driven_mesh_compact.vert.spv");
     const std::string m_fragmentShaderPath = std::string("Shaders/gbuffer.frag.spv");
     const VkDescriptorSet m_bindlessDescriptorSet;
-    const VkExtent2D m_extent = {WINDOW_WIDTH, WINDOW_HEIGHT};
+    const VkExtent2D m_extent;
 public:
     GraphicsPipeline m_pipeline;
+    GraphicsPipeline m_indirectPipeline;
+    GraphicsPipeline m_compactPipeline; // Same as the two above for CompactVertex pages
+    GraphicsPipeline m_compactIndirectPipeline;
     GraphicsPipelineId m_pipelineId;
 };
\ No newline at end of file
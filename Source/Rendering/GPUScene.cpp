@@ -0,0 +1,158 @@
+#include <Rendering/GPUScene.h>
+#include <Rendering/GfxDevice.h>
+#include <Mesh/MeshCache.h>
+#include <Mesh/RenderMeshComponent.h>
+#include <Common/Log.h>
+#include <vulkan/vk_enum_string_helper.h> // Doesn't work on linux?
+#include <cassert>
+#include <cstring>
+
+static void create_scene_buffer(AllocatedBuffer& allocatedBuffer, VkDeviceSize size, VkBufferUsageFlags usage, bool bHostWritten, const GfxDevice& gfxDevice) {
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = size;
+    bufferCreateInfo.usage = usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
+
+    // Objects are written by the CPU like the frame allocator's chunks, the draw buffers only ever by the GPU
+    VmaAllocationCreateInfo vmaAllocInfo = {};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    if (bHostWritten)
+    {
+        vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        vmaAllocInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    }
+
+    VmaAllocationInfo allocationInfo = {};
+    VkResult res = vmaCreateBuffer(gfxDevice.m_vmaAllocator, &bufferCreateInfo, &vmaAllocInfo, &allocatedBuffer.buffer, &allocatedBuffer.allocation, &allocationInfo);
+    if (res != VK_SUCCESS) {
+        MRCERR(string_VkResult(res));
+        MRCERR("Could not allocate GPU scene buffer!");
+        exit(1);
+    }
+    allocatedBuffer.mappedData = bHostWritten ? allocationInfo.pMappedData : nullptr;
+
+    VkBufferDeviceAddressInfoKHR addressInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR,
+        .buffer = allocatedBuffer.buffer
+    };
+    allocatedBuffer.gpuAddress = vkGetBufferDeviceAddress(gfxDevice, &addressInfo);
+}
+
+void GPUScene::init(const GfxDevice& gfxDevice, const MeshCache& meshCache, std::span<const RenderMeshComponent> renderMeshComponents) {
+    static_assert(MAX_FRAMES_IN_FLIGHT <= 8, "m_pendingFrameMasks holds one bit per frame in flight");
+    assert(!renderMeshComponents.empty());
+
+    // Give every page a contiguous run of draw slots, one per object using it
+    const uint32_t pageCount = meshCache.get_page_count();
+    std::vector<uint32_t> pageObjectCounts(pageCount, 0);
+    for (const RenderMeshComponent& renderMeshComponent : renderMeshComponents)
+    {
+        pageObjectCounts[renderMeshComponent.get_mesh().pageIndex]++;
+    }
+    std::vector<uint32_t> pageFirstDraws(pageCount, 0);
+    uint32_t firstDraw = 0;
+    for (uint32_t pageIndex = 0; pageIndex < pageCount; pageIndex++)
+    {
+        pageFirstDraws[pageIndex] = firstDraw;
+        if (pageObjectCounts[pageIndex] > 0)
+        {
+            m_pageDrawRanges.push_back({pageIndex, firstDraw, pageObjectCounts[pageIndex]});
+        }
+        firstDraw += pageObjectCounts[pageIndex];
+    }
+
+    std::vector<uint32_t> pageNextDraws = pageFirstDraws;
+    m_objects.reserve(renderMeshComponents.size());
+    for (const RenderMeshComponent& renderMeshComponent : renderMeshComponents)
+    {
+        const GPUMesh& gpuMesh = renderMeshComponent.get_mesh();
+        GPUObjectData& object = m_objects.emplace_back();
+        object.model = renderMeshComponent.m_transformMatrix;
+        object.boundsMin = gpuMesh.boundsMin;
+        object.firstIndex = gpuMesh.firstIndex;
+        object.boundsMax = gpuMesh.boundsMax;
+        object.indexCount = gpuMesh.indexCount;
+        object.vertexOffset = static_cast<int32_t>(gpuMesh.vertexOffset);
+        object.materialId = renderMeshComponent.m_materialId;
+        object.pageIndex = gpuMesh.pageIndex;
+        object.pageFirstDraw = pageFirstDraws[gpuMesh.pageIndex];
+        object.drawSlot = pageNextDraws[gpuMesh.pageIndex]++;
+    }
+    m_pendingFrameMasks.assign(m_objects.size(), 0);
+
+    const VkDeviceSize objectBufferSize = m_objects.size() * sizeof(GPUObjectData);
+    for (FrameBuffers& frame : m_frames)
+    {
+        create_scene_buffer(frame.objects, objectBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true, gfxDevice);
+        create_scene_buffer(frame.drawCommands, m_objects.size() * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, false, gfxDevice);
+        create_scene_buffer(frame.drawCounts, pageCount * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, false, gfxDevice);
+        memcpy(frame.objects.mappedData, m_objects.data(), objectBufferSize);
+    }
+    MRLOG("GPU scene: " << m_objects.size() << " objects across " << m_pageDrawRanges.size() << " mesh pages");
+}
+
+void GPUScene::set_transform(uint32_t objectIndex, const glm::mat4& transform) {
+    GPUObjectData& object = m_objects[objectIndex];
+    if (object.model == transform)
+    {
+        return;
+    }
+    object.model = transform;
+    // Every frame in flight has its own copy, each needs the new transform the next time it runs
+    for (uint32_t frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+    {
+        const uint8_t frameBit = static_cast<uint8_t>(1u << frameIndex);
+        if ((m_pendingFrameMasks[objectIndex] & frameBit) == 0)
+        {
+            m_pendingFrameMasks[objectIndex] |= frameBit;
+            m_frames[frameIndex].pendingObjects.push_back(objectIndex);
+        }
+    }
+}
+
+void GPUScene::begin_frame(uint32_t frameInFlightIndex) {
+    m_frameIndex = frameInFlightIndex;
+    FrameBuffers& frame = m_frames[m_frameIndex];
+    GPUObjectData* mappedObjects = static_cast<GPUObjectData*>(frame.objects.mappedData);
+    const uint8_t frameBit = static_cast<uint8_t>(1u << m_frameIndex);
+    for (uint32_t objectIndex : frame.pendingObjects)
+    {
+        mappedObjects[objectIndex] = m_objects[objectIndex];
+        m_pendingFrameMasks[objectIndex] &= static_cast<uint8_t>(~frameBit);
+    }
+    m_objectsWrittenThisFrame = static_cast<uint32_t>(frame.pendingObjects.size());
+    frame.pendingObjects.clear();
+}
+
+[[nodiscard]] uint32_t GPUScene::get_object_count() const {
+    return static_cast<uint32_t>(m_objects.size());
+}
+
+[[nodiscard]] std::span<const PageDrawRange> GPUScene::get_page_draw_ranges() const {
+    return m_pageDrawRanges;
+}
+
+[[nodiscard]] VkDeviceAddress GPUScene::get_object_buffer_address() const {
+    return m_frames[m_frameIndex].objects.gpuAddress;
+}
+
+[[nodiscard]] const AllocatedBuffer& GPUScene::get_draw_command_buffer() const {
+    return m_frames[m_frameIndex].drawCommands;
+}
+
+[[nodiscard]] const AllocatedBuffer& GPUScene::get_draw_count_buffer() const {
+    return m_frames[m_frameIndex].drawCounts;
+}
+
+[[nodiscard]] uint32_t GPUScene::get_objects_written_this_frame() const {
+    return m_objectsWrittenThisFrame;
+}
+
+void GPUScene::cleanup(const GfxDevice& gfxDevice) {
+    for (FrameBuffers& frame : m_frames)
+    {
+        frame.objects.cleanup(gfxDevice.m_vmaAllocator);
+        frame.drawCommands.cleanup(gfxDevice.m_vmaAllocator);
+        frame.drawCounts.cleanup(gfxDevice.m_vmaAllocator);
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <Wrappers/Buffer.h>
+#include <Common/Config.h>
+#include <Common/IdTypes.h>
+#include <array>
+#include <vector>
+#include <span>
+
+class GfxDevice;
+class MeshCache;
+struct RenderMeshComponent;
+
+/* Everything the culling compute shader and the GPU driven vertex shader need about one object, matches ObjectData in object_data.glsl (scalar layout) */
+struct GPUObjectData {
+    glm::mat4 model;
+    glm::vec3 boundsMin;
+    uint32_t firstIndex;
+    glm::vec3 boundsMax;
+    uint32_t indexCount;
+    int32_t vertexOffset;
+    MaterialId materialId;
+    uint32_t pageIndex; // MeshCache page, draws are grouped per page since each page has its own vertex/index buffers
+    uint32_t pageFirstDraw; // Where the object's page starts in the draw command buffer
+    uint32_t drawSlot; // The object's own command when draws aren't compacted
+    uint32_t padding[3];
+};
+static_assert(sizeof(GPUObjectData) == 128);
+
+/* The run of draw commands that use one MeshCache page */
+struct PageDrawRange {
+    uint32_t pageIndex;
+    uint32_t firstDraw;
+    uint32_t maxDrawCount;
+};
+
+/*
+ * GPU side copy of the scene's RenderMeshComponents for GPU driven rendering, plus the draw command and draw count buffers culling writes into.
+ * Each frame in flight has its own mapped object buffer, only objects that changed since that frame last ran are rewritten,
+ * so the per frame CPU cost doesn't depend on how many objects there are.
+ */
+class GPUScene
+{
+public:
+    GPUScene() = default;
+    ~GPUScene() = default;
+    GPUScene(const GPUScene&) = delete;
+    GPUScene& operator=(const GPUScene&) = delete;
+    GPUScene(GPUScene&&) = delete;
+    GPUScene& operator=(GPUScene&&) = delete;
+
+    /* Object i is renderMeshComponents[i] */
+    void init(const GfxDevice& gfxDevice, const MeshCache& meshCache, std::span<const RenderMeshComponent> renderMeshComponents);
+    void set_transform(uint32_t objectIndex, const glm::mat4& transform);
+    /* Only call once the frame's fence has signalled, writes the objects that changed since this frame index last ran */
+    void begin_frame(uint32_t frameInFlightIndex);
+
+    [[nodiscard]] uint32_t get_object_count() const;
+    [[nodiscard]] std::span<const PageDrawRange> get_page_draw_ranges() const;
+    [[nodiscard]] VkDeviceAddress get_object_buffer_address() const;
+    [[nodiscard]] const AllocatedBuffer& get_draw_command_buffer() const;
+    [[nodiscard]] const AllocatedBuffer& get_draw_count_buffer() const;
+    [[nodiscard]] uint32_t get_objects_written_this_frame() const;
+    void cleanup(const GfxDevice& gfxDevice);
+
+private:
+    struct FrameBuffers {
+        AllocatedBuffer objects; // Mapped, GPUObjectData[objectCount]
+        AllocatedBuffer drawCommands; // VkDrawIndexedIndirectCommand[objectCount], written by culling
+        AllocatedBuffer drawCounts; // uint32_t[pageCount], written by culling
+        std::vector<uint32_t> pendingObjects; // Changed since this frame index last ran
+    };
+
+    std::vector<GPUObjectData> m_objects;
+    std::vector<uint8_t> m_pendingFrameMasks; // Bit i set when the object is already queued in m_frames[i].pendingObjects
+    std::vector<PageDrawRange> m_pageDrawRanges;
+    std::array<FrameBuffers, MAX_FRAMES_IN_FLIGHT> m_frames;
+    uint32_t m_frameIndex{0};
+    uint32_t m_objectsWrittenThisFrame{0};
+};
@@ -3,20 +3,41 @@
 #include <SDL3/SDL_vulkan.h>
 #include <Common/Debug.h>
 #include <Common/Config.h>
+#include <Texture/BlockCompression.h>
+#include <Common/RootDir.h>
 #include <vulkan/vk_enum_string_helper.h> // Doesn't work on linux?
 #include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <array>
+#if PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+// The clock std::chrono::steady_clock reads, calibrated GPU timestamps are paired with it so GPU zones land on the CPU profiler's timeline
+#if PLATFORM_WINDOWS
+static constexpr VkTimeDomainEXT HOST_TIME_DOMAIN = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#elif PLATFORM_MACOS
+static constexpr VkTimeDomainEXT HOST_TIME_DOMAIN = VK_TIME_DOMAIN_MAX_ENUM_EXT; // No host domain that matches steady_clock
+#else
+static constexpr VkTimeDomainEXT HOST_TIME_DOMAIN = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
 
 void GfxDevice::create_instance() {
     // Specify application and engine info
     VkApplicationInfo appInfo = {VK_STRUCTURE_TYPE_APPLICATION_INFO, nullptr, "Magic Red", VK_MAKE_API_VERSION(1, 0, 0, 0), "Magic Red", VK_MAKE_API_VERSION(1, 0, 0, 0), VK_API_VERSION_1_2};
 
-    // Get extensions required for SDL VK surface rendering
-    uint32_t sdlExtensionCount = 0;
-    SDL_Vulkan_GetInstanceExtensions(&sdlExtensionCount);
-    m_extensionsVector.resize(sdlExtensionCount);
-    const char* const* sdlVulkanExtensions = SDL_Vulkan_GetInstanceExtensions(&sdlExtensionCount);
-    for (uint32_t i = 0; i < sdlExtensionCount; i++) {
-        m_extensionsVector[i] = sdlVulkanExtensions[i];
+    // Get extensions required for SDL VK surface rendering, headless runs never touch SDL so they also work without a display
+    if (!m_bHeadless) {
+        uint32_t sdlExtensionCount = 0;
+        SDL_Vulkan_GetInstanceExtensions(&sdlExtensionCount);
+        m_extensionsVector.resize(sdlExtensionCount);
+        const char* const* sdlVulkanExtensions = SDL_Vulkan_GetInstanceExtensions(&sdlExtensionCount);
+        for (uint32_t i = 0; i < sdlExtensionCount; i++) {
+            m_extensionsVector[i] = sdlVulkanExtensions[i];
+        }
     }
     
 
@@ -155,7 +176,11 @@ void GfxDevice::find_queue_family_indices() {
         )
     ));
     m_presentQueueFamilyIndex = 0u;
-    for (uint32_t queueFamilyIndex = 0; queueFamilyIndex < queueFamilyProperties.size(); queueFamilyIndex++) {
+    if (m_bHeadless) {
+        m_presentQueueFamilyIndex = m_graphicsQueueFamilyIndex; // Nothing is presented, the graphics queue does everything
+        queueFamilyPropertyCount = 0; // No surface to query presentation support against
+    }
+    for (uint32_t queueFamilyIndex = 0; queueFamilyIndex < queueFamilyPropertyCount; queueFamilyIndex++) {
         // Check if a given queue family on our device supports presentation to the surface that was created
         VkBool32 supported = VK_FALSE;
         VkResult res = vkGetPhysicalDeviceSurfaceSupportKHR(m_physicalDevice, static_cast<uint32_t>(queueFamilyIndex), m_surface, &supported);
@@ -194,10 +219,50 @@ void GfxDevice::create_device() {
     // Actually check if things are supported
 
     // Device extensions
-    std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME, "VK_KHR_dynamic_rendering", "VK_KHR_buffer_device_address", "VK_EXT_scalar_block_layout", "VK_EXT_descriptor_indexing"};
+    std::vector<const char*> deviceExtensions = { "VK_KHR_dynamic_rendering", "VK_KHR_buffer_device_address", "VK_EXT_scalar_block_layout", "VK_EXT_descriptor_indexing", "VK_KHR_synchronization2"};
+    if (!m_bHeadless)
+    {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
 #if PLATFORM_MACOS
     deviceExtensions.push_back("VK_KHR_portability_subset");
 #endif
+    // Optional, lets GPU culling compact its draws. Without it every object keeps a draw slot and culled ones draw 0 instances
+    uint32_t availableExtensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &availableExtensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(availableExtensionCount);
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &availableExtensionCount, availableExtensions.data());
+    const bool bDrawIndirectCount = std::any_of(availableExtensions.begin(), availableExtensions.end(), [](const VkExtensionProperties& extension) {
+        return strcmp(extension.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0;
+    });
+    if (bDrawIndirectCount)
+    {
+        deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
+    // Optional, lines GPU profiler timestamps up with CPU zones in captured traces. Both the device and the host clock have to be calibrateable
+    bool bCalibratedTimestamps = HOST_TIME_DOMAIN != VK_TIME_DOMAIN_MAX_ENUM_EXT && std::any_of(availableExtensions.begin(), availableExtensions.end(), [](const VkExtensionProperties& extension) {
+        return strcmp(extension.extensionName, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) == 0;
+    });
+    if (bCalibratedTimestamps)
+    {
+        const auto vkGetPhysicalDeviceCalibrateableTimeDomains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(vkGetInstanceProcAddr(m_instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+        uint32_t timeDomainCount = 0;
+        if (vkGetPhysicalDeviceCalibrateableTimeDomains)
+        {
+            vkGetPhysicalDeviceCalibrateableTimeDomains(m_physicalDevice, &timeDomainCount, nullptr);
+        }
+        std::vector<VkTimeDomainEXT> timeDomains(timeDomainCount);
+        if (timeDomainCount > 0)
+        {
+            vkGetPhysicalDeviceCalibrateableTimeDomains(m_physicalDevice, &timeDomainCount, timeDomains.data());
+        }
+        bCalibratedTimestamps = std::find(timeDomains.begin(), timeDomains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != timeDomains.end()
+            && std::find(timeDomains.begin(), timeDomains.end(), HOST_TIME_DOMAIN) != timeDomains.end();
+    }
+    if (bCalibratedTimestamps)
+    {
+        deviceExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+    }
     
     // Needed to enable dynamic rendering extension
     VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering_feature {
@@ -205,9 +270,16 @@ void GfxDevice::create_device() {
         .dynamicRendering = VK_TRUE,
     };
 
+    // Render graph barriers are batched through vkCmdPipelineBarrier2
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2_feature {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR,
+        .pNext = &dynamic_rendering_feature,
+        .synchronization2 = VK_TRUE
+    };
+
     VkPhysicalDeviceBufferDeviceAddressFeatures buffer_device_address_feature {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES_KHR,
-        .pNext = &dynamic_rendering_feature,
+        .pNext = &synchronization2_feature,
         .bufferDeviceAddress = VK_TRUE,
 #ifdef NDEBUG
         .bufferDeviceAddressCaptureReplay = VK_TRUE,
@@ -229,6 +301,20 @@ void GfxDevice::create_device() {
         .runtimeDescriptorArray = VK_TRUE
     };
 
+    // BCn textures are optional, cooked textures fall back to RGBA8 without them
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+    m_bTextureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+    VkPhysicalDeviceFeatures enabledFeatures = {};
+    enabledFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    // Optional, GPU driven draws pass the object index through firstInstance and issue every draw from one indirect call
+    m_bGpuDriven = supportedFeatures.multiDrawIndirect == VK_TRUE && supportedFeatures.drawIndirectFirstInstance == VK_TRUE;
+    enabledFeatures.multiDrawIndirect = m_bGpuDriven ? VK_TRUE : VK_FALSE;
+    enabledFeatures.drawIndirectFirstInstance = m_bGpuDriven ? VK_TRUE : VK_FALSE;
+    // Optional, tiled compute lighting writes the BGRA8 lighting target through an image without a format qualifier
+    m_bStorageImageWriteWithoutFormat = supportedFeatures.shaderStorageImageWriteWithoutFormat == VK_TRUE;
+    enabledFeatures.shaderStorageImageWriteWithoutFormat = supportedFeatures.shaderStorageImageWriteWithoutFormat;
+
     VkDeviceCreateInfo deviceCreateInfo = {
         VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
         &descriptor_indexing_feature,
@@ -239,9 +325,21 @@ void GfxDevice::create_device() {
         nullptr,
         static_cast<uint32_t>(deviceExtensions.size()),
         deviceExtensions.data(),
-        nullptr
+        &enabledFeatures
     };
     vkCreateDevice(m_physicalDevice, &deviceCreateInfo, nullptr, &m_device);
+    if (bDrawIndirectCount)
+    {
+        m_vkCmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(m_device, "vkCmdDrawIndexedIndirectCountKHR"));
+    }
+    m_vkCmdPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(vkGetDeviceProcAddr(m_device, "vkCmdPipelineBarrier2KHR"));
+    if (bCalibratedTimestamps)
+    {
+        m_vkGetCalibratedTimestamps = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(vkGetDeviceProcAddr(m_device, "vkGetCalibratedTimestampsEXT"));
+    }
+    MRLOG("GPU driven rendering: " << (m_bGpuDriven ? "supported" : "not supported"));
+    MRLOG("Draw indirect count: " << (m_vkCmdDrawIndexedIndirectCount ? "supported" : "not supported"));
+    MRLOG("Calibrated timestamps: " << (m_vkGetCalibratedTimestamps ? "supported" : "not supported"));
     m_mainDeletionQueue.push_function([=]() {
         vkDestroyDevice(m_device, nullptr);
     });
@@ -281,7 +379,7 @@ void GfxDevice::create_swap_chain() {
     }
 
     // Create swapchain
-    VkExtent2D swapChainExtent = { WINDOW_WIDTH, WINDOW_HEIGHT };
+    VkExtent2D swapChainExtent = m_renderExtent;
     VkSwapchainCreateInfoKHR swapChainCreateInfo = {
         VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
         nullptr,
@@ -335,6 +433,37 @@ void GfxDevice::create_swap_chain() {
     });
 }
 
+void GfxDevice::create_headless_images() {
+    // Stand in for the swapchain, frames are copied into these the same way and can be read back afterwards
+    m_swapChainFormat = VK_FORMAT_B8G8R8A8_UNORM;
+    m_headlessImages.resize(m_swapChainImageCount);
+    m_swapChainImages.resize(m_swapChainImageCount);
+    m_swapChainImageViews.resize(m_swapChainImageCount);
+    const VkImageCreateInfo headlessImageCreateInfo = image_create_info(m_swapChainFormat, VkExtent3D{ m_renderExtent.width, m_renderExtent.height, 1 },
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_IMAGE_TYPE_2D);
+    for (uint32_t i = 0; i < m_swapChainImageCount; i++) {
+        AllocatedImage& headlessImage = m_headlessImages[i];
+        headlessImage.imageExtent = headlessImageCreateInfo.extent;
+        headlessImage.imageFormat = m_swapChainFormat;
+        create_gpu_only_image(headlessImage, headlessImageCreateInfo, m_vmaAllocator);
+        VkImageViewCreateInfo imageViewCreateInfo = imageview_create_info(headlessImage.image, m_swapChainFormat, {}, VK_IMAGE_ASPECT_COLOR_BIT);
+        VkResult res = vkCreateImageView(m_device, &imageViewCreateInfo, nullptr, &headlessImage.imageView);
+        if (res != VK_SUCCESS) {
+            MRCERR(string_VkResult(res));
+            MRCERR("Could not create headless image view!");
+        }
+        m_swapChainImages[i] = headlessImage.image;
+        m_swapChainImageViews[i] = headlessImage.imageView;
+    }
+    MRLOG("Headless, rendering offscreen at " << m_renderExtent.width << "x" << m_renderExtent.height);
+    m_mainDeletionQueue.push_function([=]() {
+        for (AllocatedImage& headlessImage : m_headlessImages) {
+            vkDestroyImageView(m_device, headlessImage.imageView, nullptr);
+            vmaDestroyImage(m_vmaAllocator, headlessImage.image, headlessImage.allocation);
+        }
+    });
+}
+
 // void GfxDevice::create_draw_image() {
 //     VkExtent3D drawImageExtent = {
 //         WINDOW_WIDTH,
@@ -367,7 +496,7 @@ void GfxDevice::create_swap_chain() {
 // }
 
  void GfxDevice::create_depth_image_and_view() {
-    m_depthImage.imageExtent = VkExtent3D{ WINDOW_WIDTH, WINDOW_HEIGHT, 1 };
+    m_depthImage.imageExtent = VkExtent3D{ m_renderExtent.width, m_renderExtent.height, 1 };
     m_depthImage.imageFormat = VK_FORMAT_D32_SFLOAT;
 
     VkImageCreateInfo depthImageCreateInfo = image_create_info(m_depthImage.imageFormat, m_depthImage.imageExtent, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_TYPE_2D);
@@ -474,22 +603,48 @@ void GfxDevice::init_VMA() {
 }
 
 
-void GfxDevice::init(SDL_Window * const window) {
+void GfxDevice::init_upload_batcher() {
+    m_pUploadBatcher = std::make_unique<UploadBatcher>();
+    m_pUploadBatcher->init(m_device, m_graphicsQueue, m_graphicsQueueFamilyIndex, m_vmaAllocator, UPLOAD_STAGING_BUFFER_SIZE);
+    m_mainDeletionQueue.push_function([&]() {
+        m_pUploadBatcher->cleanup();
+    });
+}
+
+void GfxDevice::create_pipeline_cache() {
+    m_pipelineCache.init(m_device, m_physicalDevice, std::filesystem::path(ROOT_DIR "PipelineCache.bin"));
+    m_mainDeletionQueue.push_function([&]() {
+        m_pipelineCache.save();
+        m_pipelineCache.cleanup();
+    });
+}
+
+void GfxDevice::init(SDL_Window * const window, VkExtent2D renderExtent) {
+    m_bHeadless = window == nullptr;
+    m_renderExtent = renderExtent;
     create_instance();
     create_debug_messenger();
-    create_surface(window);
+    if (!m_bHeadless) {
+        create_surface(window);
+    }
     init_physical_device();
     find_queue_family_indices();
     create_device();
+    create_pipeline_cache();
     init_VMA();
-    create_swap_chain();
-    get_swap_chain_images();
+    if (m_bHeadless) {
+        create_headless_images();
+    } else {
+        create_swap_chain();
+        get_swap_chain_images();
+    }
     // create_draw_image();
     create_depth_image_and_view();
     create_synchronization_structures();
     create_command_pool();
     create_command_buffers();
     retrieve_queues();
+    init_upload_batcher();
 }
 
 // Used for data uploads and other "instant operations" not synced with the swapchain
@@ -529,10 +684,80 @@ void GfxDevice::immediate_submit(std::function<void(VkCommandBuffer cmd)>&& func
 
 VkInstance GfxDevice::get_instance() const { return m_instance; }
 
+[[nodiscard]] bool GfxDevice::is_headless() const { return m_bHeadless; }
+
+[[nodiscard]] VkExtent2D GfxDevice::get_render_extent() const { return m_renderExtent; }
+
 VkQueue GfxDevice::get_graphics_queue() const { return m_graphicsQueue; }
 
 VkPhysicalDevice GfxDevice::get_physical_device() const { return m_physicalDevice; }
 
+[[nodiscard]] bool GfxDevice::supports_linear_blit(VkFormat format) const {
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
+    const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
+
+[[nodiscard]] bool GfxDevice::supports_sampled_format(VkFormat format) const {
+    if (is_block_compressed(format) && !m_bTextureCompressionBC)
+    {
+        return false;
+    }
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
+    const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
+
+[[nodiscard]] bool GfxDevice::supports_storage_image_write(VkFormat format) const {
+    if (!m_bStorageImageWriteWithoutFormat)
+    {
+        return false;
+    }
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
+    return (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+}
+
+[[nodiscard]] bool GfxDevice::supports_gpu_driven() const { return m_bGpuDriven; }
+[[nodiscard]] PFN_vkCmdDrawIndexedIndirectCountKHR GfxDevice::get_draw_indexed_indirect_count() const { return m_vkCmdDrawIndexedIndirectCount; }
+[[nodiscard]] uint32_t GfxDevice::get_graphics_queue_family_index() const { return m_graphicsQueueFamilyIndex; }
+[[nodiscard]] PFN_vkCmdPipelineBarrier2KHR GfxDevice::get_cmd_pipeline_barrier2() const { return m_vkCmdPipelineBarrier2; }
+
+[[nodiscard]] const PipelineCache& GfxDevice::get_pipeline_cache() const { return m_pipelineCache; }
+
+[[nodiscard]] bool GfxDevice::get_calibrated_timestamps(uint64_t& gpuTimestamp, int64_t& hostNs) const {
+    if (!m_vkGetCalibratedTimestamps)
+    {
+        return false;
+    }
+    const std::array<VkCalibratedTimestampInfoEXT, 2> timestampInfos = {{
+        {VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, nullptr, VK_TIME_DOMAIN_DEVICE_EXT},
+        {VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, nullptr, HOST_TIME_DOMAIN}
+    }};
+    std::array<uint64_t, 2> timestamps;
+    uint64_t maxDeviation = 0;
+    VkResult res = m_vkGetCalibratedTimestamps(m_device, static_cast<uint32_t>(timestampInfos.size()), timestampInfos.data(), timestamps.data(), &maxDeviation);
+    if (res != VK_SUCCESS)
+    {
+        return false;
+    }
+    gpuTimestamp = timestamps[0];
+#if PLATFORM_WINDOWS
+    // Performance counter ticks to nanoseconds, split like steady_clock does so large counters don't overflow
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    const int64_t counter = static_cast<int64_t>(timestamps[1]);
+    hostNs = (counter / frequency.QuadPart) * 1000000000 + (counter % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+    hostNs = static_cast<int64_t>(timestamps[1]); // CLOCK_MONOTONIC is already in nanoseconds
+#endif
+    return true;
+}
+
+[[nodiscard]] UploadBatcher& GfxDevice::get_upload_batcher() const { return *m_pUploadBatcher; }
+
 VkCommandBuffer GfxDevice::get_frame_command_buffer(uint32_t currentFrameIndex) const { return m_commandBuffers[currentFrameIndex]; };
 
 VkSemaphore GfxDevice::get_frame_imageAvailableSemaphore(uint32_t currentFrameIndex) const { return m_imageAvailableSemaphores[currentFrameIndex]; };
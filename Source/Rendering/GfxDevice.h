@@ -8,6 +8,9 @@
 #include <DeletionQueue.h>
 #include <Common/Config.h>
 #include <array>
+#include <memory>
+#include <Rendering/UploadBatcher.h>
+#include <Pipeline/PipelineCache.h>
 
 #include <IncludeHelpers/VmaIncludes.h>
 
@@ -34,6 +37,14 @@ private:
     VkSurfaceKHR m_surface;
     VkPhysicalDevice m_physicalDevice;
     VkDevice m_device;
+    bool m_bHeadless = false;
+    VkExtent2D m_renderExtent;
+    bool m_bTextureCompressionBC = false;
+    bool m_bStorageImageWriteWithoutFormat = false;
+    bool m_bGpuDriven = false;
+    PFN_vkCmdDrawIndexedIndirectCountKHR m_vkCmdDrawIndexedIndirectCount{nullptr};
+    PFN_vkCmdPipelineBarrier2KHR m_vkCmdPipelineBarrier2{nullptr};
+    PFN_vkGetCalibratedTimestampsEXT m_vkGetCalibratedTimestamps{nullptr};
 
     // Queues
     uint32_t m_graphicsQueueFamilyIndex;
@@ -50,6 +61,7 @@ private:
     // Swapchain
     
     uint32_t m_swapChainImageCount = 3; // Should probably request support for this, but it's probably fine
+    std::vector<AllocatedImage> m_headlessImages; // Backing for m_swapChainImages when headless
 
     // Synchronization
     std::array<VkSemaphore, MAX_FRAMES_IN_FLIGHT> m_imageAvailableSemaphores;
@@ -66,6 +78,12 @@ private:
     VkCommandBuffer m_immediateCommandBuffer;
     VkCommandPool m_immediateCommandPool;
 
+    // Batched staging uploads
+    std::unique_ptr<UploadBatcher> m_pUploadBatcher;
+
+    // Shared by every pipeline build, persisted across runs
+    PipelineCache m_pipelineCache;
+
     // Cleanup
     DeletionQueue m_mainDeletionQueue; // Contains all deletable vulkan resources except pipelines/pipeline layouts
 
@@ -75,8 +93,10 @@ private:
     void init_physical_device();
     void find_queue_family_indices();
     void create_device();
+    void create_pipeline_cache();
     void create_swap_chain();
     void get_swap_chain_images();
+    void create_headless_images();
     // void create_draw_image();
     void create_depth_image_and_view();
     void create_synchronization_structures();
@@ -84,21 +104,45 @@ private:
     void create_command_buffers();
     void retrieve_queues();
     void init_VMA();
+    void init_upload_batcher();
 public:
-    void init(SDL_Window * const window);
+    /* A null window runs headless: no surface or swapchain, m_swapChainImages are offscreen images that are never presented */
+    void init(SDL_Window * const window, VkExtent2D renderExtent);
     VkFormat m_swapChainFormat;
     AllocatedImage m_depthImage; // TODO: gfxdevice shouldnt own this
     std::vector<VkImage> m_swapChainImages; // TODO: better interface for this
     std::vector<VkImageView> m_swapChainImageViews; // TODO: better interface for this
-    VkSwapchainKHR m_swapChain;
+    VkSwapchainKHR m_swapChain = VK_NULL_HANDLE; // Stays null when headless
     [[nodiscard]] operator VkDevice() const
     {
         return m_device;
     }
     VkInstance get_instance() const;
+    [[nodiscard]] bool is_headless() const;
+    /* Size of the swapchain (or headless) images and every full screen target */
+    [[nodiscard]] VkExtent2D get_render_extent() const;
     VkQueue get_graphics_queue() const;
+    [[nodiscard]] uint32_t get_graphics_queue_family_index() const;
     VkPhysicalDevice get_physical_device() const;
+    /* Whether optimally tiled images of this format can be the source and destination of a linear filtered vkCmdBlitImage (mip generation) */
+    [[nodiscard]] bool supports_linear_blit(VkFormat format) const;
+    /* Whether optimally tiled images of this format can be uploaded to and sampled, BCn formats also need textureCompressionBC */
+    [[nodiscard]] bool supports_sampled_format(VkFormat format) const;
+    /* Whether optimally tiled images of this format can be written from shaders as storage images declared without a format */
+    [[nodiscard]] bool supports_storage_image_write(VkFormat format) const;
+    /* Whether multiDrawIndirect and drawIndirectFirstInstance are enabled, which GPU driven rendering needs */
+    [[nodiscard]] bool supports_gpu_driven() const;
     void immediate_submit(std::function<void(VkCommandBuffer cmd)>&& function) const;
+    /* vkCmdDrawIndexedIndirectCountKHR, nullptr when VK_KHR_draw_indirect_count isn't available */
+    [[nodiscard]] PFN_vkCmdDrawIndexedIndirectCountKHR get_draw_indexed_indirect_count() const;
+    /* vkCmdPipelineBarrier2KHR, VK_KHR_synchronization2 is required */
+    [[nodiscard]] PFN_vkCmdPipelineBarrier2KHR get_cmd_pipeline_barrier2() const;
+    /* Pass get_handle() to every vkCreate*Pipelines call so builds hit the on disk cache */
+    [[nodiscard]] const PipelineCache& get_pipeline_cache() const;
+    /* Samples the GPU timestamp counter and CpuProfiler::now_ns() at the same instant. False without VK_EXT_calibrated_timestamps */
+    [[nodiscard]] bool get_calibrated_timestamps(uint64_t& gpuTimestamp, int64_t& hostNs) const;
+    /* Uploads recorded here are only guaranteed to be on the GPU after get_upload_batcher().flush() */
+    [[nodiscard]] UploadBatcher& get_upload_batcher() const;
 
 
     VkCommandBuffer get_frame_command_buffer(uint32_t currentFrameIndex) const;
@@ -0,0 +1,292 @@
+#include "GpuProfiler.h"
+#include <Rendering/GfxDevice.h>
+#include <Common/Log.h>
+#include <vulkan/vk_enum_string_helper.h> // Doesn't work on linux?
+#include <algorithm>
+#include <fstream>
+#include <tuple>
+
+void GpuProfiler::init(const GfxDevice& gfxDevice) {
+    m_pGfxDevice = &gfxDevice;
+    m_device = gfxDevice;
+
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(gfxDevice.get_physical_device(), &physicalDeviceProperties);
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(gfxDevice.get_physical_device(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(gfxDevice.get_physical_device(), &queueFamilyCount, queueFamilies.data());
+    const uint32_t timestampValidBits = queueFamilies[gfxDevice.get_graphics_queue_family_index()].timestampValidBits;
+
+    m_bSupported = timestampValidBits > 0 && physicalDeviceProperties.limits.timestampPeriod > 0.0f;
+    if (!m_bSupported)
+    {
+        MRWARN("Graphics queue doesn't support timestamps, GPU profiling is disabled");
+        return;
+    }
+    m_timestampPeriodMs = static_cast<double>(physicalDeviceProperties.limits.timestampPeriod) / 1e6;
+    m_timestampMask = timestampValidBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << timestampValidBits) - 1;
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = GPU_PROFILER_MAX_SCOPES_PER_FRAME * 2,
+        .pipelineStatistics = 0
+    };
+    for (FrameQueries& frameQueries : m_frameQueries)
+    {
+        VkResult res = vkCreateQueryPool(m_device, &queryPoolCreateInfo, nullptr, &frameQueries.queryPool);
+        if (res != VK_SUCCESS)
+        {
+            MRCERR(string_VkResult(res));
+            MRCERR("Failed to create timestamp query pool!");
+            exit(1);
+        }
+    }
+    m_queryResults.resize(static_cast<size_t>(GPU_PROFILER_MAX_SCOPES_PER_FRAME) * 2 * 2);
+
+    uint64_t gpuTimestamp;
+    int64_t hostNs;
+    m_bCanCalibrate = gfxDevice.get_calibrated_timestamps(gpuTimestamp, hostNs);
+}
+
+void GpuProfiler::begin_frame(VkCommandBuffer cmdBuffer, uint32_t frameInFlightIndex, uint64_t frameNumber) {
+    if (!m_bSupported)
+    {
+        return;
+    }
+    m_currentFrame = frameInFlightIndex;
+    FrameQueries& frameQueries = m_frameQueries[m_currentFrame];
+    collect_results(frameQueries);
+
+    frameQueries.recordedScopes.clear();
+    frameQueries.frameNumber = frameNumber;
+    frameQueries.queryCount = 0;
+    frameQueries.bCalibrated = m_bCapturing && m_bCanCalibrate
+        && m_pGfxDevice->get_calibrated_timestamps(frameQueries.calibrationTimestamp, frameQueries.calibrationHostNs);
+    vkCmdResetQueryPool(cmdBuffer, frameQueries.queryPool, 0, GPU_PROFILER_MAX_SCOPES_PER_FRAME * 2);
+}
+
+[[nodiscard]] uint32_t GpuProfiler::begin_scope(VkCommandBuffer cmdBuffer, const std::string& name) {
+    if (!m_bSupported)
+    {
+        return GPU_PROFILER_INVALID_SCOPE;
+    }
+    FrameQueries& frameQueries = m_frameQueries[m_currentFrame];
+    if (frameQueries.queryCount + 2 > GPU_PROFILER_MAX_SCOPES_PER_FRAME * 2)
+    {
+        return GPU_PROFILER_INVALID_SCOPE;
+    }
+    const RecordedScope recordedScope = {
+        .scopeIndex = find_or_add_scope(name),
+        .firstQuery = frameQueries.queryCount
+    };
+    frameQueries.queryCount += 2;
+    frameQueries.recordedScopes.push_back(recordedScope);
+    vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frameQueries.queryPool, recordedScope.firstQuery);
+    return static_cast<uint32_t>(frameQueries.recordedScopes.size() - 1);
+}
+
+void GpuProfiler::end_scope(VkCommandBuffer cmdBuffer, uint32_t scopeHandle) {
+    if (scopeHandle == GPU_PROFILER_INVALID_SCOPE)
+    {
+        return;
+    }
+    const FrameQueries& frameQueries = m_frameQueries[m_currentFrame];
+    vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frameQueries.queryPool, frameQueries.recordedScopes[scopeHandle].firstQuery + 1);
+}
+
+void GpuProfiler::collect_pending() {
+    if (!m_bSupported)
+    {
+        return;
+    }
+    for (FrameQueries& frameQueries : m_frameQueries)
+    {
+        collect_results(frameQueries);
+        // Already in the history, begin_frame() mustn't add them again
+        frameQueries.queryCount = 0;
+        frameQueries.recordedScopes.clear();
+    }
+}
+
+void GpuProfiler::collect_results(FrameQueries& frameQueries) {
+    if (frameQueries.queryCount == 0)
+    {
+        return;
+    }
+    // No WAIT_BIT, the fence already signalled. Availability guards against scopes whose end was never written
+    VkResult res = vkGetQueryPoolResults(m_device, frameQueries.queryPool, 0, frameQueries.queryCount,
+        frameQueries.queryCount * 2 * sizeof(uint64_t), m_queryResults.data(), 2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (res != VK_SUCCESS && res != VK_NOT_READY)
+    {
+        MRWARN("Failed to read GPU timestamps: " << string_VkResult(res));
+        return;
+    }
+    for (const RecordedScope& recordedScope : frameQueries.recordedScopes)
+    {
+        const size_t beginResult = static_cast<size_t>(recordedScope.firstQuery) * 2;
+        const size_t endResult = beginResult + 2;
+        if (m_queryResults[beginResult + 1] == 0 || m_queryResults[endResult + 1] == 0)
+        {
+            continue;
+        }
+        const uint64_t ticks = (m_queryResults[endResult] - m_queryResults[beginResult]) & m_timestampMask;
+
+        Scope& scope = m_scopes[recordedScope.scopeIndex];
+        scope.history[scope.nextSample] = {
+            .frameNumber = frameQueries.frameNumber,
+            .ms = static_cast<float>(static_cast<double>(ticks) * m_timestampPeriodMs)
+        };
+        scope.nextSample = (scope.nextSample + 1) % GPU_PROFILER_HISTORY_SIZE;
+        scope.sampleCount = std::min(scope.sampleCount + 1, GPU_PROFILER_HISTORY_SIZE);
+
+        if (m_bCapturing && frameQueries.bCalibrated)
+        {
+            m_capturedEvents.push_back({
+                .name = scope.name,
+                .startNs = to_host_ns(frameQueries, m_queryResults[beginResult]),
+                .endNs = to_host_ns(frameQueries, m_queryResults[endResult])
+            });
+        }
+    }
+}
+
+[[nodiscard]] int64_t GpuProfiler::to_host_ns(const FrameQueries& frameQueries, uint64_t timestamp) const {
+    // Timestamps only count up within timestampValidBits, the masked difference stays correct across a wrap.
+    // Reinterpreting it as signed covers scopes that began before the calibration sample
+    const uint64_t tickDelta = (timestamp - frameQueries.calibrationTimestamp) & m_timestampMask;
+    int64_t signedTickDelta = static_cast<int64_t>(tickDelta);
+    if (m_timestampMask != ~uint64_t(0) && tickDelta > (m_timestampMask >> 1))
+    {
+        signedTickDelta -= static_cast<int64_t>(m_timestampMask) + 1;
+    }
+    return frameQueries.calibrationHostNs + static_cast<int64_t>(static_cast<double>(signedTickDelta) * m_timestampPeriodMs * 1e6);
+}
+
+[[nodiscard]] uint32_t GpuProfiler::find_or_add_scope(const std::string& name) {
+    for (uint32_t i = 0; i < m_scopes.size(); i++)
+    {
+        if (m_scopes[i].name == name)
+        {
+            return i;
+        }
+    }
+    Scope& scope = m_scopes.emplace_back();
+    scope.name = name;
+    return static_cast<uint32_t>(m_scopes.size() - 1);
+}
+
+void GpuProfiler::cleanup() {
+    for (FrameQueries& frameQueries : m_frameQueries)
+    {
+        vkDestroyQueryPool(m_device, frameQueries.queryPool, nullptr);
+        frameQueries.queryPool = VK_NULL_HANDLE;
+    }
+}
+
+[[nodiscard]] bool GpuProfiler::is_supported() const { return m_bSupported; }
+[[nodiscard]] bool GpuProfiler::can_calibrate() const { return m_bSupported && m_bCanCalibrate; }
+
+void GpuProfiler::set_capturing(bool bCapturing) {
+    if (bCapturing && !m_bCapturing)
+    {
+        m_capturedEvents.clear();
+        if (!can_calibrate())
+        {
+            MRWARN("Calibrated timestamps aren't available, traces will only have CPU zones");
+        }
+    }
+    m_bCapturing = bCapturing;
+}
+
+[[nodiscard]] ProfilerTrack GpuProfiler::take_capture() {
+    ProfilerTrack track = {
+        .name = "GPU",
+        .events = std::move(m_capturedEvents)
+    };
+    m_capturedEvents.clear();
+    return track;
+}
+
+[[nodiscard]] std::vector<GpuProfiler::ScopeStats> GpuProfiler::get_scope_stats() const {
+    std::vector<ScopeStats> scopeStats;
+    scopeStats.reserve(m_scopes.size());
+    for (const Scope& scope : m_scopes)
+    {
+        ScopeStats stats = {
+            .name = scope.name,
+            .averageMs = 0.0f,
+            .minMs = 0.0f,
+            .maxMs = 0.0f,
+            .sampleCount = scope.sampleCount
+        };
+        if (scope.sampleCount > 0)
+        {
+            stats.minMs = scope.history[0].ms;
+            stats.maxMs = scope.history[0].ms;
+            float totalMs = 0.0f;
+            for (uint32_t i = 0; i < scope.sampleCount; i++)
+            {
+                totalMs += scope.history[i].ms;
+                stats.minMs = std::min(stats.minMs, scope.history[i].ms);
+                stats.maxMs = std::max(stats.maxMs, scope.history[i].ms);
+            }
+            stats.averageMs = totalMs / static_cast<float>(scope.sampleCount);
+        }
+        scopeStats.push_back(stats);
+    }
+    return scopeStats;
+}
+
+[[nodiscard]] std::vector<GpuProfiler::Sample> GpuProfiler::get_samples(const std::string& scopeName) const {
+    for (const Scope& scope : m_scopes)
+    {
+        if (scope.name == scopeName)
+        {
+            return std::vector<Sample>(scope.history.begin(), scope.history.begin() + scope.sampleCount);
+        }
+    }
+    return {};
+}
+
+[[nodiscard]] bool GpuProfiler::export_csv(const std::filesystem::path& path) const {
+    // (frame, scope order, ms), sorting the tuples orders rows by frame then by scope
+    std::vector<std::tuple<uint64_t, uint32_t, float>> rows;
+    for (uint32_t scopeIndex = 0; scopeIndex < m_scopes.size(); scopeIndex++)
+    {
+        const Scope& scope = m_scopes[scopeIndex];
+        for (uint32_t i = 0; i < scope.sampleCount; i++)
+        {
+            rows.emplace_back(scope.history[i].frameNumber, scopeIndex, scope.history[i].ms);
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        MRWARN("Failed to open " << path.string() << " for writing");
+        return false;
+    }
+    file << "frame,scope,gpu_ms\n";
+    for (const auto& [frameNumber, scopeIndex, ms] : rows)
+    {
+        file << frameNumber << "," << m_scopes[scopeIndex].name << "," << ms << "\n";
+    }
+    MRLOG("Exported " << rows.size() << " GPU timings to " << path.string());
+    return file.good();
+}
+
+GpuProfileScope::GpuProfileScope(GpuProfiler& profiler, VkCommandBuffer cmdBuffer, const std::string& name)
+    : m_profiler(profiler)
+    , m_cmdBuffer(cmdBuffer)
+    , m_scopeHandle(profiler.begin_scope(cmdBuffer, name))
+    {}
+
+GpuProfileScope::~GpuProfileScope() {
+    m_profiler.end_scope(m_cmdBuffer, m_scopeHandle);
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <Common/Config.h>
+#include <Common/CpuProfiler.h>
+#include <array>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <cstdint>
+
+class GfxDevice;
+
+inline constexpr uint32_t GPU_PROFILER_MAX_SCOPES_PER_FRAME = 64;
+inline constexpr uint32_t GPU_PROFILER_HISTORY_SIZE = 128; // Frames of samples kept per scope
+inline constexpr uint32_t GPU_PROFILER_INVALID_SCOPE = UINT32_MAX;
+
+/*
+ * Times named scopes of a frame's command buffer (render graph passes, the whole frame) with timestamp queries, one query pool per frame in flight.
+ * A frame's timestamps are read back by begin_frame() the next time its frame in flight comes around, after its fence has signalled, so reading never stalls.
+ * The last GPU_PROFILER_HISTORY_SIZE samples of every scope are kept for rolling averages, min/max and CSV export.
+ * While capturing, every resolved scope is also kept as an absolute interval on the CpuProfiler timeline, calibrated once per frame
+ * against the host clock so clock drift stays bounded. Without timestamp support on the graphics queue every call is a no-op.
+ */
+class GpuProfiler
+{
+public:
+    struct ScopeStats {
+        std::string name;
+        float averageMs;
+        float minMs;
+        float maxMs;
+        uint32_t sampleCount;
+    };
+    struct Sample {
+        uint64_t frameNumber;
+        float ms;
+    };
+
+    GpuProfiler() = default;
+    ~GpuProfiler() = default;
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+    GpuProfiler(GpuProfiler&&) = delete;
+    GpuProfiler& operator=(GpuProfiler&&) = delete;
+
+    void init(const GfxDevice& gfxDevice);
+    /* Only call once the frame's fence has signalled. Collects the results this frame index recorded last time and resets its queries,
+     * cmdBuffer must not be inside a render pass */
+    void begin_frame(VkCommandBuffer cmdBuffer, uint32_t frameInFlightIndex, uint64_t frameNumber);
+    /* Returns the handle end_scope() takes, scopes may nest. GPU_PROFILER_INVALID_SCOPE once the frame's queries run out */
+    [[nodiscard]] uint32_t begin_scope(VkCommandBuffer cmdBuffer, const std::string& name);
+    void end_scope(VkCommandBuffer cmdBuffer, uint32_t scopeHandle);
+    /* Reads back every frame in flight that hasn't been yet, only call once the device is idle */
+    void collect_pending();
+    void cleanup();
+
+    [[nodiscard]] bool is_supported() const;
+    /* In the order the scopes were first seen */
+    [[nodiscard]] std::vector<ScopeStats> get_scope_stats() const;
+    /* The retained samples of one scope in no particular order, empty if it was never recorded */
+    [[nodiscard]] std::vector<Sample> get_samples(const std::string& scopeName) const;
+    /* One row per retained sample (frame,scope,gpu_ms), oldest frame first */
+    [[nodiscard]] bool export_csv(const std::filesystem::path& path) const;
+
+    /* Whether captures can place GPU scopes on the host timeline (VK_EXT_calibrated_timestamps) */
+    [[nodiscard]] bool can_calibrate() const;
+    /* Starts or stops keeping calibrated scope intervals for take_capture() */
+    void set_capturing(bool bCapturing);
+    /* Moves out the intervals captured so far as a "GPU" track for CpuProfiler::end_capture() */
+    [[nodiscard]] ProfilerTrack take_capture();
+
+private:
+    struct Scope {
+        std::string name;
+        std::array<Sample, GPU_PROFILER_HISTORY_SIZE> history;
+        uint32_t sampleCount{0}; // Valid entries in history, at most GPU_PROFILER_HISTORY_SIZE
+        uint32_t nextSample{0};
+    };
+    struct RecordedScope {
+        uint32_t scopeIndex;
+        uint32_t firstQuery; // Begin timestamp, the end is the query after it
+    };
+    struct FrameQueries {
+        VkQueryPool queryPool{VK_NULL_HANDLE};
+        std::vector<RecordedScope> recordedScopes;
+        uint64_t frameNumber{0};
+        uint32_t queryCount{0};
+        bool bCalibrated{false}; // Whether calibrationTimestamp/calibrationHostNs were sampled when this frame was recorded
+        uint64_t calibrationTimestamp{0};
+        int64_t calibrationHostNs{0};
+    };
+
+    [[nodiscard]] uint32_t find_or_add_scope(const std::string& name);
+    void collect_results(FrameQueries& frameQueries);
+
+    [[nodiscard]] int64_t to_host_ns(const FrameQueries& frameQueries, uint64_t timestamp) const;
+
+    const GfxDevice* m_pGfxDevice{nullptr};
+    VkDevice m_device{VK_NULL_HANDLE};
+    bool m_bSupported{false};
+    double m_timestampPeriodMs{0.0}; // Milliseconds per timestamp tick
+    uint64_t m_timestampMask{0}; // Only timestampValidBits of each result are meaningful
+    std::array<FrameQueries, MAX_FRAMES_IN_FLIGHT> m_frameQueries;
+    uint32_t m_currentFrame{0};
+    std::vector<Scope> m_scopes;
+    std::vector<uint64_t> m_queryResults; // Scratch for vkGetQueryPoolResults, value then availability per query
+    bool m_bCanCalibrate{false};
+    bool m_bCapturing{false};
+    std::vector<ProfilerTrackEvent> m_capturedEvents;
+};
+
+/* Times everything recorded into cmdBuffer during its lifetime */
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(GpuProfiler& profiler, VkCommandBuffer cmdBuffer, const std::string& name);
+    ~GpuProfileScope();
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    GpuProfiler& m_profiler;
+    VkCommandBuffer m_cmdBuffer;
+    uint32_t m_scopeHandle;
+};
@@ -0,0 +1,60 @@
+#include <Rendering/InstanceBatcher.h>
+#include <Rendering/FrameAllocator.h>
+#include <Mesh/RenderMeshComponent.h>
+#include <Mesh/Mesh.h>
+#include <Common/CpuProfiler.h>
+#include <algorithm>
+#include <tuple>
+
+[[nodiscard]] std::span<const InstanceBatch> InstanceBatcher::build(FrameAllocator& frameAllocator, std::span<const RenderMeshComponent> renderMeshComponents, std::span<const uint32_t> visibleIndices) {
+    MR_PROFILE_ZONE("Build instance batches");
+    m_batches.clear();
+    m_transforms.clear();
+    m_instanceTransformsAddress = 0;
+    if (visibleIndices.empty())
+    {
+        return m_batches;
+    }
+
+    // The component index breaks ties so batches (and the transforms inside them) come out in the same order every frame
+    m_sortedIndices.assign(visibleIndices.begin(), visibleIndices.end());
+    std::sort(m_sortedIndices.begin(), m_sortedIndices.end(), [renderMeshComponents](uint32_t a, uint32_t b) {
+        const RenderMeshComponent& componentA = renderMeshComponents[a];
+        const RenderMeshComponent& componentB = renderMeshComponents[b];
+        return std::tuple(componentA.get_mesh().pageIndex, componentA.get_mesh_id(), componentA.m_materialId, a)
+            < std::tuple(componentB.get_mesh().pageIndex, componentB.get_mesh_id(), componentB.m_materialId, b);
+    });
+
+    m_transforms.reserve(m_sortedIndices.size());
+    for (const uint32_t renderMeshIndex : m_sortedIndices)
+    {
+        const RenderMeshComponent& renderMeshComponent = renderMeshComponents[renderMeshIndex];
+        const bool bSameBatch = !m_batches.empty()
+            && m_batches.back().meshId == renderMeshComponent.get_mesh_id()
+            && m_batches.back().materialId == renderMeshComponent.m_materialId;
+        if (bSameBatch)
+        {
+            m_batches.back().instanceCount++;
+        }
+        else
+        {
+            m_batches.push_back({renderMeshComponent.get_mesh_id(), renderMeshComponent.m_materialId, static_cast<uint32_t>(m_transforms.size()), 1});
+        }
+        m_transforms.push_back(renderMeshComponent.m_transformMatrix);
+    }
+
+    m_instanceTransformsAddress = frameAllocator.push(std::span<const glm::mat4>(m_transforms)).gpuAddress;
+    return m_batches;
+}
+
+[[nodiscard]] VkDeviceAddress InstanceBatcher::get_instance_transforms_address() const {
+    return m_instanceTransformsAddress;
+}
+
+[[nodiscard]] uint32_t InstanceBatcher::get_batch_count() const {
+    return static_cast<uint32_t>(m_batches.size());
+}
+
+[[nodiscard]] uint32_t InstanceBatcher::get_instance_count() const {
+    return static_cast<uint32_t>(m_transforms.size());
+}
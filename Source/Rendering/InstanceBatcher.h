@@ -0,0 +1,47 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <Common/IdTypes.h>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+class FrameAllocator;
+struct RenderMeshComponent;
+
+/* One instanced draw, transforms firstInstance to firstInstance + instanceCount - 1 of the frame's instance transform buffer */
+struct InstanceBatch {
+    GPUMeshId meshId{0};
+    MaterialId materialId{0};
+    uint32_t firstInstance{0};
+    uint32_t instanceCount{0};
+};
+
+/*
+ * Groups the visible RenderMeshComponents of the CPU driven path by (mesh, material) so repeats of a mesh cost one draw.
+ * Batches are sorted by MeshCache page so page binds stay as rare as before, every batch's transforms are written back to back into a
+ * FrameAllocator buffer that the vertex shader indexes with gl_InstanceIndex.
+ */
+class InstanceBatcher
+{
+public:
+    InstanceBatcher() = default;
+    ~InstanceBatcher() = default;
+    InstanceBatcher(const InstanceBatcher&) = delete;
+    InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+    InstanceBatcher(InstanceBatcher&&) = delete;
+    InstanceBatcher& operator=(InstanceBatcher&&) = delete;
+
+    /* Call once per frame after culling and after the FrameAllocator began the frame, the batches are valid until the next call */
+    [[nodiscard]] std::span<const InstanceBatch> build(FrameAllocator& frameAllocator, std::span<const RenderMeshComponent> renderMeshComponents, std::span<const uint32_t> visibleIndices);
+
+    [[nodiscard]] VkDeviceAddress get_instance_transforms_address() const;
+    [[nodiscard]] uint32_t get_batch_count() const;
+    [[nodiscard]] uint32_t get_instance_count() const;
+
+private:
+    std::vector<uint32_t> m_sortedIndices;
+    std::vector<glm::mat4> m_transforms;
+    std::vector<InstanceBatch> m_batches;
+    VkDeviceAddress m_instanceTransformsAddress{0};
+};
@@ -0,0 +1,360 @@
+#include <Rendering/RenderGraph.h>
+#include <Rendering/GfxDevice.h>
+#include <Rendering/GpuProfiler.h>
+#include <Common/CpuProfiler.h>
+#include <cassert>
+
+struct RenderGraphUsageInfo {
+    VkPipelineStageFlags2 stages;
+    VkAccessFlags2 access;
+    VkImageLayout layout; // Ignored for buffers
+    bool bWrite;
+    bool bReadsContents; // Whether what was there before matters, decides which passes are kept alive
+};
+
+static constexpr VkAccessFlags2 WRITE_ACCESS_MASK =
+    VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+    | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+    | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+    | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+static RenderGraphUsageInfo get_usage_info(RenderGraphUsage usage) {
+    switch (usage)
+    {
+        case RenderGraphUsage::ColorAttachmentWrite:
+            return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true, false};
+        case RenderGraphUsage::ColorAttachmentReadWrite:
+            return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true, true};
+        case RenderGraphUsage::DepthAttachmentWrite:
+            return {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, true, false};
+        case RenderGraphUsage::FragmentSampled:
+            return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false, true};
+        case RenderGraphUsage::ComputeSampled:
+            return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false, true};
+        case RenderGraphUsage::ComputeStorageRead:
+            return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false, true};
+        case RenderGraphUsage::ComputeStorageWrite:
+            return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true, false};
+        case RenderGraphUsage::ComputeStorageReadWrite:
+            return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true, true};
+        case RenderGraphUsage::VertexStorageRead:
+            return {VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false, true};
+        case RenderGraphUsage::IndirectRead:
+            return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false, true};
+        case RenderGraphUsage::TransferSrc:
+            return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false, true};
+        case RenderGraphUsage::TransferDst:
+            return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true, false};
+    }
+    assert(false && "Unhandled RenderGraphUsage");
+    return {};
+}
+
+void RenderGraph::init(const GfxDevice& gfxDevice) {
+    m_vkCmdPipelineBarrier2 = gfxDevice.get_cmd_pipeline_barrier2();
+}
+
+void RenderGraph::set_profiler(GpuProfiler* pProfiler) {
+    m_pProfiler = pProfiler;
+}
+
+[[nodiscard]] RenderGraphResourceId RenderGraph::add_image(const std::string& name, VkImage image, VkImageAspectFlags aspect, bool bTransient, VkImageLayout finalLayout) {
+    Resource& resource = m_resources.emplace_back();
+    resource.name = name;
+    resource.bImage = true;
+    resource.image = image;
+    resource.aspect = aspect;
+    resource.bTransient = bTransient;
+    resource.finalLayout = finalLayout;
+    return static_cast<RenderGraphResourceId>(m_resources.size() - 1);
+}
+
+[[nodiscard]] RenderGraphResourceId RenderGraph::add_buffer(const std::string& name, VkBuffer buffer) {
+    Resource& resource = m_resources.emplace_back();
+    resource.name = name;
+    resource.bImage = false;
+    resource.buffer = buffer;
+    return static_cast<RenderGraphResourceId>(m_resources.size() - 1);
+}
+
+void RenderGraph::set_image(RenderGraphResourceId resourceId, VkImage image, VkPipelineStageFlags2 externalStages) {
+    Resource& resource = m_resources[resourceId];
+    assert(resource.bImage);
+    // A different image knows nothing of the old one's accesses, only whatever happened outside the graph
+    resource.image = image;
+    resource.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    resource.writeStages = externalStages;
+    resource.writeAccess = VK_ACCESS_2_NONE;
+    resource.readStages = VK_PIPELINE_STAGE_2_NONE;
+    resource.readAccess = VK_ACCESS_2_NONE;
+}
+
+void RenderGraph::set_buffer(RenderGraphResourceId resourceId, VkBuffer buffer) {
+    Resource& resource = m_resources[resourceId];
+    assert(!resource.bImage);
+    // The previous buffer's state is kept, at worst that's a dependency that wasn't needed
+    resource.buffer = buffer;
+}
+
+void RenderGraph::mark_output(RenderGraphResourceId resourceId) {
+    m_resources[resourceId].bOutput = true;
+}
+
+void RenderGraph::add_pass(const std::string& name, std::initializer_list<RenderGraphAccess> accesses, RecordFunction&& recordFunction) {
+    Pass& pass = m_passes.emplace_back();
+    pass.name = name;
+    pass.accesses = accesses;
+    pass.recordFunction = std::move(recordFunction);
+}
+
+void RenderGraph::cull_passes() {
+    // Walk backwards from the outputs, a pass survives if a later surviving pass (or an output) needs something it writes
+    std::vector<bool> neededResources(m_resources.size(), false);
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        neededResources[i] = m_resources[i].bOutput;
+    }
+
+    for (auto pass = m_passes.rbegin(); pass != m_passes.rend(); ++pass)
+    {
+        bool bNeeded = false;
+        for (const RenderGraphAccess& access : pass->accesses)
+        {
+            bNeeded = bNeeded || (get_usage_info(access.usage).bWrite && neededResources[access.resourceId]);
+        }
+        pass->bCulled = !bNeeded;
+        if (pass->bCulled)
+        {
+            continue;
+        }
+        for (const RenderGraphAccess& access : pass->accesses)
+        {
+            if (get_usage_info(access.usage).bWrite)
+            {
+                neededResources[access.resourceId] = false;
+            }
+        }
+        for (const RenderGraphAccess& access : pass->accesses)
+        {
+            if (get_usage_info(access.usage).bReadsContents)
+            {
+                neededResources[access.resourceId] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::add_barrier(Resource& resource, RenderGraphUsage usage) {
+    const RenderGraphUsageInfo usageInfo = get_usage_info(usage);
+
+    VkImageLayout oldLayout = resource.layout;
+    if (!resource.bUsedThisFrame)
+    {
+        if (resource.bImage && resource.bTransient)
+        {
+            oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+        resource.bUsedThisFrame = true;
+    }
+    const VkImageLayout newLayout = resource.bImage ? usageInfo.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+    const bool bLayoutChange = resource.bImage && (oldLayout != newLayout);
+
+    VkPipelineStageFlags2 srcStages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 srcAccess = VK_ACCESS_2_NONE;
+    bool bBarrier = false;
+    if (usageInfo.bWrite || bLayoutChange)
+    {
+        // Writes and layout transitions wait for the last write and every read since (WAR)
+        srcStages = resource.writeStages | resource.readStages;
+        srcAccess = resource.writeAccess;
+        bBarrier = bLayoutChange || (srcStages != VK_PIPELINE_STAGE_2_NONE);
+        if (usageInfo.bWrite)
+        {
+            resource.writeStages = usageInfo.stages;
+            resource.writeAccess = usageInfo.access & WRITE_ACCESS_MASK;
+            resource.readStages = VK_PIPELINE_STAGE_2_NONE;
+            resource.readAccess = VK_ACCESS_2_NONE;
+        }
+        else
+        {
+            // The transition only finished before these stages, readers elsewhere in the pipeline still need to chain off them
+            resource.writeStages = usageInfo.stages;
+            resource.writeAccess = VK_ACCESS_2_NONE;
+            resource.readStages = usageInfo.stages;
+            resource.readAccess = usageInfo.access;
+        }
+    }
+    else
+    {
+        // Read after write in the same layout, skipped when an earlier read barrier already covered these stages
+        const bool bCovered = ((usageInfo.stages & ~resource.readStages) == 0) && ((usageInfo.access & ~resource.readAccess) == 0);
+        srcStages = resource.writeStages;
+        srcAccess = resource.writeAccess;
+        bBarrier = (srcStages != VK_PIPELINE_STAGE_2_NONE) && !bCovered;
+        resource.readStages |= usageInfo.stages;
+        resource.readAccess |= usageInfo.access;
+    }
+    resource.layout = resource.bImage ? newLayout : resource.layout;
+
+    if (!bBarrier)
+    {
+        return;
+    }
+    if (resource.bImage)
+    {
+        VkImageMemoryBarrier2 imageBarrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+            .pNext = nullptr,
+            .srcStageMask = srcStages,
+            .srcAccessMask = srcAccess,
+            .dstStageMask = usageInfo.stages,
+            .dstAccessMask = usageInfo.access,
+            .oldLayout = oldLayout,
+            .newLayout = newLayout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = resource.image,
+            .subresourceRange = {
+                .aspectMask = resource.aspect,
+                .baseMipLevel = 0,
+                .levelCount = VK_REMAINING_MIP_LEVELS,
+                .baseArrayLayer = 0,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS
+            }
+        };
+        m_pendingImageBarriers.push_back(imageBarrier);
+    }
+    else
+    {
+        VkBufferMemoryBarrier2 bufferBarrier = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR,
+            .pNext = nullptr,
+            .srcStageMask = srcStages,
+            .srcAccessMask = srcAccess,
+            .dstStageMask = usageInfo.stages,
+            .dstAccessMask = usageInfo.access,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = resource.buffer,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE
+        };
+        m_pendingBufferBarriers.push_back(bufferBarrier);
+    }
+}
+
+void RenderGraph::flush_barriers(VkCommandBuffer cmdBuffer) {
+    if (m_pendingImageBarriers.empty() && m_pendingBufferBarriers.empty())
+    {
+        return;
+    }
+    VkDependencyInfoKHR dependencyInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+        .pNext = nullptr,
+        .dependencyFlags = {},
+        .memoryBarrierCount = 0,
+        .pMemoryBarriers = nullptr,
+        .bufferMemoryBarrierCount = static_cast<uint32_t>(m_pendingBufferBarriers.size()),
+        .pBufferMemoryBarriers = m_pendingBufferBarriers.data(),
+        .imageMemoryBarrierCount = static_cast<uint32_t>(m_pendingImageBarriers.size()),
+        .pImageMemoryBarriers = m_pendingImageBarriers.data()
+    };
+    m_vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+
+    m_barrierBatchCount++;
+    m_barrierCount += static_cast<uint32_t>(m_pendingImageBarriers.size() + m_pendingBufferBarriers.size());
+    m_pendingImageBarriers.clear();
+    m_pendingBufferBarriers.clear();
+}
+
+void RenderGraph::execute(VkCommandBuffer cmdBuffer) {
+    assert(m_vkCmdPipelineBarrier2 && "RenderGraph::init() was never called");
+    MR_PROFILE_ZONE("Execute render graph");
+    m_executedPassCount = 0;
+    m_culledPassCount = 0;
+    m_barrierBatchCount = 0;
+    m_barrierCount = 0;
+    for (Resource& resource : m_resources)
+    {
+        resource.bUsedThisFrame = false;
+    }
+
+    cull_passes();
+    for (Pass& pass : m_passes)
+    {
+        if (pass.bCulled)
+        {
+            m_culledPassCount++;
+            continue;
+        }
+        for (const RenderGraphAccess& access : pass.accesses)
+        {
+            add_barrier(m_resources[access.resourceId], access.usage);
+        }
+        flush_barriers(cmdBuffer);
+        if (m_pProfiler)
+        {
+            GpuProfileScope passScope(*m_pProfiler, cmdBuffer, pass.name);
+            pass.recordFunction(cmdBuffer);
+        }
+        else
+        {
+            pass.recordFunction(cmdBuffer);
+        }
+        m_executedPassCount++;
+    }
+
+    // Everything that has to leave the graph in a particular layout (e.g. for presenting) goes in one last batch
+    for (Resource& resource : m_resources)
+    {
+        if (!resource.bImage || !resource.bUsedThisFrame || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.layout == resource.finalLayout)
+        {
+            continue;
+        }
+        VkImageMemoryBarrier2 imageBarrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+            .pNext = nullptr,
+            .srcStageMask = resource.writeStages | resource.readStages,
+            .srcAccessMask = resource.writeAccess,
+            .dstStageMask = VK_PIPELINE_STAGE_2_NONE, // Whatever comes next (e.g. present) waits on a semaphore signalled after this
+            .dstAccessMask = VK_ACCESS_2_NONE,
+            .oldLayout = resource.layout,
+            .newLayout = resource.finalLayout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = resource.image,
+            .subresourceRange = {
+                .aspectMask = resource.aspect,
+                .baseMipLevel = 0,
+                .levelCount = VK_REMAINING_MIP_LEVELS,
+                .baseArrayLayer = 0,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS
+            }
+        };
+        m_pendingImageBarriers.push_back(imageBarrier);
+        resource.layout = resource.finalLayout;
+        resource.writeStages = VK_PIPELINE_STAGE_2_NONE;
+        resource.writeAccess = VK_ACCESS_2_NONE;
+        resource.readStages = VK_PIPELINE_STAGE_2_NONE;
+        resource.readAccess = VK_ACCESS_2_NONE;
+    }
+    flush_barriers(cmdBuffer);
+
+    m_passes.clear();
+}
+
+[[nodiscard]] uint32_t RenderGraph::get_executed_pass_count() const {
+    return m_executedPassCount;
+}
+
+[[nodiscard]] uint32_t RenderGraph::get_culled_pass_count() const {
+    return m_culledPassCount;
+}
+
+[[nodiscard]] uint32_t RenderGraph::get_barrier_batch_count() const {
+    return m_barrierBatchCount;
+}
+
+[[nodiscard]] uint32_t RenderGraph::get_barrier_count() const {
+    return m_barrierCount;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include <functional>
+#include <initializer_list>
+#include <cstdint>
+
+class GfxDevice;
+class GpuProfiler;
+
+using RenderGraphResourceId = uint32_t;
+inline constexpr RenderGraphResourceId NULL_RENDER_GRAPH_RESOURCE_ID = UINT32_MAX;
+
+/* How a pass touches a resource, each one maps to the exact stages, accesses and (for images) layout it needs */
+enum class RenderGraphUsage {
+    ColorAttachmentWrite, // Cleared or fully overwritten
+    ColorAttachmentReadWrite, // Loaded then written (e.g. UI drawn over the lit image)
+    DepthAttachmentWrite,
+    FragmentSampled,
+    ComputeSampled,
+    ComputeStorageRead,
+    ComputeStorageWrite,
+    ComputeStorageReadWrite,
+    VertexStorageRead,
+    IndirectRead,
+    TransferSrc,
+    TransferDst,
+};
+
+struct RenderGraphAccess {
+    RenderGraphResourceId resourceId;
+    RenderGraphUsage usage;
+};
+
+/*
+ * Passes declare the images and buffers they read and write, the graph works out every barrier between them.
+ * Resources are registered once and keep their state from frame to frame, so the first barrier of a frame waits on exactly what the last frame did.
+ * Passes are re-added every frame (their record functions usually capture per frame values) and run in the order they were added.
+ * On execute() passes whose writes never reach an output are skipped,
+ * and all transitions needed before a pass are merged into a single vkCmdPipelineBarrier2 call.
+ */
+class RenderGraph
+{
+public:
+    using RecordFunction = std::function<void(VkCommandBuffer cmdBuffer)>;
+
+    RenderGraph() = default;
+    ~RenderGraph() = default;
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+    RenderGraph(RenderGraph&&) = delete;
+    RenderGraph& operator=(RenderGraph&&) = delete;
+
+    void init(const GfxDevice& gfxDevice);
+    /* When set every executed pass is timed as a GPU scope named after the pass */
+    void set_profiler(GpuProfiler* pProfiler);
+    /* bTransient images are fully rewritten each frame, so their old contents are discarded (UNDEFINED) on the first use of a frame.
+     * finalLayout, if not UNDEFINED, is transitioned to at the end of execute() (e.g. PRESENT_SRC_KHR) */
+    [[nodiscard]] RenderGraphResourceId add_image(const std::string& name, VkImage image, VkImageAspectFlags aspect, bool bTransient = true, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+    [[nodiscard]] RenderGraphResourceId add_buffer(const std::string& name, VkBuffer buffer);
+    /* For resources that change every frame (swapchain image, per frame in flight buffers).
+     * externalStages are stages outside the graph the new handle has to wait on, e.g. the acquire semaphore's wait stage */
+    void set_image(RenderGraphResourceId resourceId, VkImage image, VkPipelineStageFlags2 externalStages = VK_PIPELINE_STAGE_2_NONE);
+    void set_buffer(RenderGraphResourceId resourceId, VkBuffer buffer);
+    /* Outputs are what keeps passes alive, anything that doesn't contribute to one is culled */
+    void mark_output(RenderGraphResourceId resourceId);
+
+    void add_pass(const std::string& name, std::initializer_list<RenderGraphAccess> accesses, RecordFunction&& recordFunction);
+    /* Records the surviving passes and their barriers, then forgets the passes */
+    void execute(VkCommandBuffer cmdBuffer);
+
+    [[nodiscard]] uint32_t get_executed_pass_count() const;
+    [[nodiscard]] uint32_t get_culled_pass_count() const;
+    [[nodiscard]] uint32_t get_barrier_batch_count() const;
+    [[nodiscard]] uint32_t get_barrier_count() const;
+
+private:
+    struct Resource {
+        std::string name;
+        bool bImage;
+        VkImage image{VK_NULL_HANDLE};
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VkImageAspectFlags aspect{0};
+        bool bTransient{true};
+        bool bOutput{false};
+        VkImageLayout finalLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+        // State left by the last access, carried across frames
+        VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+        VkPipelineStageFlags2 writeStages{VK_PIPELINE_STAGE_2_NONE};
+        VkAccessFlags2 writeAccess{VK_ACCESS_2_NONE};
+        VkPipelineStageFlags2 readStages{VK_PIPELINE_STAGE_2_NONE}; // Reads since the last write, a later write must wait on them
+        VkAccessFlags2 readAccess{VK_ACCESS_2_NONE}; // Reads that already saw the last write, only for skipping redundant barriers
+        bool bUsedThisFrame{false};
+    };
+    struct Pass {
+        std::string name;
+        std::vector<RenderGraphAccess> accesses;
+        RecordFunction recordFunction;
+        bool bCulled{false};
+    };
+
+    void cull_passes();
+    /* Appends the barrier (if any) that access needs to the pending batch and updates the resource's state */
+    void add_barrier(Resource& resource, RenderGraphUsage usage);
+    void flush_barriers(VkCommandBuffer cmdBuffer);
+
+    PFN_vkCmdPipelineBarrier2KHR m_vkCmdPipelineBarrier2{nullptr};
+    GpuProfiler* m_pProfiler{nullptr};
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    std::vector<VkImageMemoryBarrier2> m_pendingImageBarriers;
+    std::vector<VkBufferMemoryBarrier2> m_pendingBufferBarriers;
+
+    uint32_t m_executedPassCount{0};
+    uint32_t m_culledPassCount{0};
+    uint32_t m_barrierBatchCount{0};
+    uint32_t m_barrierCount{0};
+};
@@ -16,18 +16,24 @@
 #include <cstdlib>
 #include <span>
 #include <array>
+#include <utility>
+#include <random>
+#include <chrono>
 #include <Common/RootDir.h>
 #include <Common/Platform.h>
 #include <Common/Compiler/Unused.h>
+#include <Common/CpuProfiler.h>
+#include <Rendering/Screenshot.h>
+#include <Rendering/Benchmark.h>
 
 #include <Camera/Camera.h>
+#include <Camera/Frustum.h>
 #include <Common/Log.h>
 #include <DeletionQueue.h>
 #include <Mesh/Mesh.h>
 #include <Model/Model.h>
 
 #include <Wrappers/Image.h>
-#include <Wrappers/ImageMemoryBarrier.h>
 #include <Wrappers/DynamicRendering.h>
 
 #include <Common/Defaults.h>
@@ -52,10 +58,48 @@ float cameraSpeed = 0.0f;
 bool firstMouse = true;
 float lastX = WINDOW_WIDTH / 2, lastY = WINDOW_HEIGHT / 2; // Initial mouse positions
 
+Renderer::Renderer(const RendererOptions& _options) : m_options(_options) {}
+
 void Renderer::run() {
-    initWindow();
-    init_graphics();
-    mainLoop();
+    CpuProfiler::get().set_thread_name("Main");
+    // MR_PROFILE_STARTUP_SECONDS=N traces startup (asset import, pipeline builds) and the frames after it for N seconds
+    if (const char* startupSeconds = std::getenv("MR_PROFILE_STARTUP_SECONDS"))
+    {
+        const double seconds = std::atof(startupSeconds);
+        if (seconds > 0.0)
+        {
+            CpuProfiler::get().begin_capture(seconds);
+        }
+    }
+    if (m_options.bHeadless)
+    {
+        init_graphics();
+        if (m_options.bBenchmark)
+        {
+            run_benchmark();
+        }
+        else
+        {
+            run_headless();
+        }
+        if (!m_options.screenshotPath.empty())
+        {
+            UNUSED(save_screenshot(m_GfxDevice, m_GfxDevice.m_swapChainImages[m_lastImageIndex], m_options.screenshotPath)); // Logs the outcome itself
+        }
+    }
+    else
+    {
+        initWindow();
+        init_graphics();
+        if (m_options.bBenchmark)
+        {
+            run_benchmark();
+        }
+        else
+        {
+            mainLoop();
+        }
+    }
     cleanup();
 }
 
@@ -63,27 +107,39 @@ void Renderer::initWindow() {
     // We initialize SDL and create a window with it.
     SDL_Init(SDL_INIT_VIDEO);
 
-    m_window = SDL_CreateWindow("Magic Red", WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_VULKAN);
+    m_window = SDL_CreateWindow("Magic Red", static_cast<int>(m_options.renderExtent.width), static_cast<int>(m_options.renderExtent.height), SDL_WINDOW_VULKAN);
     SDL_SetRelativeMouseMode(SDL_TRUE);
 }
 
 void Renderer::init_graphics() {
-    m_GfxDevice.init(m_window);
+    MR_PROFILE_ZONE("Init graphics");
+    m_GfxDevice.init(m_window, m_options.renderExtent);
     init_lights();
     create_samplers();
     init_bindless_descriptors();
     init_assets();
     init_material_data();
+    m_GPUScene.init(m_GfxDevice, m_MeshCache, m_sceneRenderMeshComponents);
+    // Textures, meshes and materials above were only recorded, push them all to the GPU in one submission
+    m_GfxDevice.get_upload_batcher().flush();
     init_scene_data();
 
     init_global_descriptor_pool();
 
     init_render_textures();
+    const auto stagesStart = std::chrono::steady_clock::now();
     init_render_stages();
+    const auto stagesEnd = std::chrono::steady_clock::now();
+    MRLOG("Created render stages in " << std::chrono::duration_cast<std::chrono::milliseconds>(stagesEnd - stagesStart).count() << "ms ("
+        << (m_GfxDevice.get_pipeline_cache().is_warm() ? "warm" : "cold") << " pipeline cache)");
+    init_render_graph();
 
     update_texture_descriptors();
 
-    init_imgui();
+    if (!m_GfxDevice.is_headless())
+    {
+        init_imgui();
+    }
 }
 
 void Renderer::init_lights() {
@@ -98,29 +154,27 @@ void Renderer::init_lights() {
     m_CPUPointLights.emplace_back(glm::vec3(0.0f, 3.5f, -4.0f), 1.0f, glm::vec3(1.0f, 223.0f/255.0f, 188.0f/255.0f), 1.0f, 0.09f, 0.032f);
     m_CPUPointLights.emplace_back(glm::vec3(0.0f, 3.5f, 1.0f), 1.0f, glm::vec3(45.0f/255.0f, 25.0f/255.0f, 188.0f/255.0f), 1.0f, 0.09f, 0.032f);
 
-    if (m_CPUPointLights.size() > 0)
-    {
-        m_pointLightsExist = true;
-        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-        {
-            upload_buffer(
-                m_GPUPointLightsBuffers[i],
-                m_CPUPointLights.size() * sizeof(PointLight),
-                m_CPUPointLights.data(),
-                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR,
-                m_GfxDevice.m_vmaAllocator
-            );
-        }
+    m_basePointLightCount = m_CPUPointLights.size();
+    m_pointLightsExist = m_CPUPointLights.size() > 0;
+}
 
-        for (auto& lightBuffer : m_GPUPointLightsBuffers)
-        {
-            VkBufferDeviceAddressInfoKHR addressInfo{
-                .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR,
-                .buffer = lightBuffer.buffer
-            };
-            lightBuffer.gpuAddress = vkGetBufferDeviceAddress(m_GfxDevice, &addressInfo);
-        }
+void Renderer::spawn_extra_point_lights() {
+    m_CPUPointLights.erase(m_CPUPointLights.begin() + static_cast<std::ptrdiff_t>(m_basePointLightCount), m_CPUPointLights.end());
+
+    // Fixed seed so the same count always gives the same lights
+    std::mt19937 rng(1337);
+    std::uniform_real_distribution<float> xzDistribution(-15.0f, 15.0f);
+    std::uniform_real_distribution<float> yDistribution(0.0f, 8.0f);
+    std::uniform_real_distribution<float> colorDistribution(0.2f, 1.0f);
+    for (int i = 0; i < m_extraPointLightCount; i++)
+    {
+        const glm::vec3 position(xzDistribution(rng), yDistribution(rng), xzDistribution(rng));
+        const glm::vec3 color(colorDistribution(rng), colorDistribution(rng), colorDistribution(rng));
+        // Steep falloff (~12 unit radius) so each light only reaches a handful of tiles
+        m_CPUPointLights.emplace_back(position, 1.0f, color, 1.0f, 0.7f, 1.8f);
     }
+
+    m_pointLightsExist = m_CPUPointLights.size() > 0;
 }
 
 void Renderer::create_samplers() {
@@ -131,6 +185,8 @@ void Renderer::create_samplers() {
             .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
             .anisotropyEnable = VK_FALSE,
             // .maxAnisotropy = maxAnisotropy,
+            .minLod = 0.0f,
+            .maxLod = VK_LOD_CLAMP_NONE, // Sample every mip level the view exposes
         };
     vkCreateSampler(m_GfxDevice, &linearCI, nullptr, &m_linearSampler);
     VkSamplerCreateInfo nearestCI = {
@@ -251,15 +307,11 @@ void Renderer::init_assets() {
 
     {
        // Sponza mesh
-       CPUModel sponzaModel(ROOT_DIR "/Assets/Meshes/sponza-gltf/Sponza.gltf", false, m_MaterialCache, m_TextureCache, m_GfxDevice);
+       CPUModel sponzaModel(ROOT_DIR "/Assets/Meshes/sponza-gltf/Sponza.gltf", false, m_MaterialCache, m_TextureCache, m_GfxDevice, m_ThreadPool, m_options.vertexFormat);
        glm::mat4 translate = glm::translate(glm::mat4{ 1.0f }, glm::vec3(0.0f, 0.0f, 0.0f));
     //    glm::mat4 rotate = glm::rotate(translate, rm, glm::vec3(0.0, 0.0, 1.0));
        glm::mat4 scale = glm::scale(glm::mat4{ 1.0 }, glm::vec3(550.0f, 550.0f, 550.0f));
-       for (CPUMesh& mesh : sponzaModel.m_cpuMeshes)
-       {
-           GPUMeshId sponzaMeshId = m_MeshCache.add_mesh(m_GfxDevice, mesh);
-           m_sceneRenderMeshComponents.emplace_back(sponzaMeshId, m_MeshCache, translate * scale);
-       }
+       add_model_to_scene(sponzaModel, translate * scale);
     }
 
     glm::mat4 translate = glm::translate(glm::mat4{ 1.0f }, glm::vec3(0.0f, 2.0f, 2.0f));
@@ -270,7 +322,7 @@ void Renderer::init_assets() {
 
     // {
     //     // A beautiful game
-    //     CPUModel beautifulGameModel(ROOT_DIR "/Assets/Meshes/ABeautifulGame/ABeautifulGame.gltf", false, m_MaterialCache, m_TextureCache, m_GfxDevice);
+    //     CPUModel beautifulGameModel(ROOT_DIR "/Assets/Meshes/ABeautifulGame/ABeautifulGame.gltf", false, m_MaterialCache, m_TextureCache, m_GfxDevice, m_ThreadPool);
     //     for (CPUMesh& mesh : beautifulGameModel.m_cpuMeshes)
     //     {
     //         GPUMeshId beautifulGameMeshId = m_MeshCache.add_mesh(m_GfxDevice, mesh);
@@ -298,7 +350,7 @@ void Renderer::init_assets() {
 
     //  {
     //      // Orientation test model
-    //      CPUModel orientationTestModel(ROOT_DIR "/Assets/Meshes/OrientationTest.glb", true, m_MaterialCache, m_TextureCache, m_GfxDevice);
+    //      CPUModel orientationTestModel(ROOT_DIR "/Assets/Meshes/OrientationTest.glb", true, m_MaterialCache, m_TextureCache, m_GfxDevice, m_ThreadPool);
     //      for (CPUMesh& mesh : orientationTestModel.m_cpuMeshes)
     //      {
     //         GPUMeshId orientationTestMeshId = m_MeshCache.add_mesh(m_GfxDevice, mesh);
@@ -337,40 +389,51 @@ void Renderer::init_assets() {
 
     {
         // Helmet mesh
-        CPUModel helmetModel(ROOT_DIR "/Assets/Meshes/DamagedHelmet.glb", true, m_MaterialCache, m_TextureCache, m_GfxDevice);
+        CPUModel helmetModel(ROOT_DIR "/Assets/Meshes/DamagedHelmet.glb", true, m_MaterialCache, m_TextureCache, m_GfxDevice, m_ThreadPool, m_options.vertexFormat);
 
+        glm::mat4 helmetTransform = glm::translate(glm::mat4{ 1.0f }, glm::vec3(0.0f, 3.0f, 0.0f));
+        helmetTransform = glm::rotate(helmetTransform, glm::radians(90.0f), glm::vec3(1.0, 0.0, 0.0));
+        add_model_to_scene(helmetModel, helmetTransform);
+    }
+    MRLOG("Mesh vertices use " << m_MeshCache.get_vertex_memory_size() / (1024 * 1024) << "MB ("
+        << (m_options.vertexFormat == VertexFormat::Compact ? "compact" : "full") << " vertex format), indices "
+        << m_MeshCache.get_index_memory_size() / (1024 * 1024) << "MB");
+}
 
-        for (CPUMesh& mesh : helmetModel.m_cpuMeshes)
-        {
-            GPUMeshId helmetMeshId = m_MeshCache.add_mesh(m_GfxDevice, mesh);
-
-            glm::mat4 helmetTransform = glm::translate(glm::mat4{ 1.0f }, glm::vec3(0.0f, 3.0f, 0.0f));
-            helmetTransform = glm::rotate(helmetTransform, glm::radians(90.0f), glm::vec3(1.0, 0.0, 0.0));
-
-            m_sceneRenderMeshComponents.emplace_back(helmetMeshId, m_MeshCache, helmetTransform);
-        }
+void Renderer::add_model_to_scene(const CPUModel& model, const glm::mat4& modelTransform) {
+    std::vector<GPUMeshId> meshIds;
+    meshIds.reserve(model.m_cpuMeshes.size());
+    for (const CPUMesh& mesh : model.m_cpuMeshes)
+    {
+        meshIds.push_back(m_MeshCache.add_mesh(m_GfxDevice, mesh));
+    }
+    for (const CPUMeshInstance& instance : model.m_instances)
+    {
+        m_sceneRenderMeshComponents.emplace_back(meshIds[instance.m_meshIndex], m_MeshCache, modelTransform * instance.m_transform);
     }
 }
 
 void Renderer::init_material_data() {
-    upload_buffer(
+    upload_static_buffer(
         m_materialDataBuffer,
         m_MaterialCache.get_material_count() * sizeof(Material),
         m_MaterialCache.get_material_data(),
         VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR,
-        m_GfxDevice.m_vmaAllocator
+        m_GfxDevice
     );
 }
 
 void Renderer::init_global_descriptor_pool() {
     constexpr size_t MAX_RENDER_TEXTURES = 100;
-    std::array<VkDescriptorPoolSize, 1> globalDescriptorPoolSizes {{
-        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, MAX_RENDER_TEXTURES}
+    constexpr size_t MAX_STORAGE_RENDER_TEXTURES = 10;
+    std::array<VkDescriptorPoolSize, 2> globalDescriptorPoolSizes {{
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, MAX_RENDER_TEXTURES},
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MAX_STORAGE_RENDER_TEXTURES}
     }};
     VkDescriptorPoolCreateInfo poolCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
         .pNext = nullptr,
-        .maxSets = 1,
+        .maxSets = 2, // Fullscreen and tiled lighting
         .poolSizeCount = static_cast<uint32_t>(globalDescriptorPoolSizes.size()),
         .pPoolSizes = globalDescriptorPoolSizes.data()
     };
@@ -378,7 +441,8 @@ void Renderer::init_global_descriptor_pool() {
 }
 
 void Renderer::init_render_textures() {
-    VkExtent3D fullFrameBufferExtent = {.width = WINDOW_WIDTH, .height = WINDOW_HEIGHT, .depth = 1};
+    const VkExtent2D renderExtent = m_GfxDevice.get_render_extent();
+    VkExtent3D fullFrameBufferExtent = {.width = renderExtent.width, .height = renderExtent.height, .depth = 1};
 
     // G Buffer
     {
@@ -392,7 +456,7 @@ void Renderer::init_render_textures() {
             | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,    // TODO: Copy from to swapchain
             VK_IMAGE_TYPE_2D
         );
-        m_albedoRTId = m_TextureCache.add_render_texture_texture(m_GfxDevice, albedoRTFormat, albedoRTImage_ci);
+        m_albedoTransientIndex = m_TransientImageAllocator.add_image("Albedo", albedoRTImage_ci);
 
         VkFormat worldNormalsRTFormat = VK_FORMAT_A2R10G10B10_UNORM_PACK32;
         VkImageCreateInfo worldNormalsRTImage_ci = image_create_info(worldNormalsRTFormat, fullFrameBufferExtent,
@@ -401,7 +465,7 @@ void Renderer::init_render_textures() {
             // | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, // Input to deferred lighting // TODO: subpass
             VK_IMAGE_TYPE_2D
         );
-        m_worldNormalsRTId = m_TextureCache.add_render_texture_texture(m_GfxDevice, worldNormalsRTFormat, worldNormalsRTImage_ci);
+        m_worldNormalsTransientIndex = m_TransientImageAllocator.add_image("World normals", worldNormalsRTImage_ci);
 
         VkFormat metallicRoughnessRTFormat = VK_FORMAT_R8G8_UNORM;
         VkImageCreateInfo metallicRoughnessRTImage_ci = image_create_info(metallicRoughnessRTFormat, fullFrameBufferExtent,
@@ -410,19 +474,27 @@ void Renderer::init_render_textures() {
             // | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, // Input to deferred lighting // TODO: subpass
             VK_IMAGE_TYPE_2D
         );
-        m_metallicRoughnessRTId = m_TextureCache.add_render_texture_texture(m_GfxDevice, metallicRoughnessRTFormat, metallicRoughnessRTImage_ci);
+        m_metallicRoughnessTransientIndex = m_TransientImageAllocator.add_image("Metallic roughness", metallicRoughnessRTImage_ci);
     }
 
     // Lighting
     {
         VkFormat lightingRTFormat = VK_FORMAT_B8G8R8A8_UNORM; // TODO: SRGB?
+        m_bTiledLightingSupported = m_GfxDevice.supports_storage_image_write(lightingRTFormat);
         VkImageCreateInfo lightingRTImage_ci = image_create_info(lightingRTFormat, fullFrameBufferExtent,
             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT   // Output from lighting pass
+            | (m_bTiledLightingSupported ? VK_IMAGE_USAGE_STORAGE_BIT : 0) // Output from tiled compute lighting
             | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,    // TODO: Copy from to swapchain
             VK_IMAGE_TYPE_2D
         );
-        m_lightingRTId = m_TextureCache.add_render_texture_texture(m_GfxDevice, lightingRTFormat, lightingRTImage_ci);
+        m_lightingTransientIndex = m_TransientImageAllocator.add_image("Lighting", lightingRTImage_ci);
     }
+
+    m_TransientImageAllocator.allocate(m_GfxDevice);
+    m_albedoRTId = m_TextureCache.add_render_texture_texture(m_GfxDevice, m_TransientImageAllocator.get_image(m_albedoTransientIndex));
+    m_worldNormalsRTId = m_TextureCache.add_render_texture_texture(m_GfxDevice, m_TransientImageAllocator.get_image(m_worldNormalsTransientIndex));
+    m_metallicRoughnessRTId = m_TextureCache.add_render_texture_texture(m_GfxDevice, m_TransientImageAllocator.get_image(m_metallicRoughnessTransientIndex));
+    m_lightingRTId = m_TextureCache.add_render_texture_texture(m_GfxDevice, m_TransientImageAllocator.get_image(m_lightingTransientIndex));
 }
 
 
@@ -478,11 +550,59 @@ void Renderer::init_render_stages() {
             , m_metallicRoughnessRTId
         );
     }
+
+    if (m_bTiledLightingSupported)
+    {
+        m_pTiledLightingStage = std::make_unique<TiledLightingStage>(
+            m_GfxDevice
+            , m_TextureCache
+            , m_globalDescriptorPool
+            , m_albedoRTId
+            , m_worldNormalsRTId
+            , m_metallicRoughnessRTId
+            , m_lightingRTId
+        );
+    }
+    else
+    {
+        MRWARN("Lighting target can't be written as a storage image, tiled compute lighting is unavailable");
+    }
+
+    m_pCullingStage = std::make_unique<CullingStage>(m_GfxDevice);
+    if (!m_GfxDevice.supports_gpu_driven())
+    {
+        MRWARN("Device lacks multiDrawIndirect or drawIndirectFirstInstance, GPU driven rendering is unavailable");
+        m_bGpuDrivenRendering = false;
+    }
+
+    // parallel_for also runs chunks on the calling thread
+    m_SecondaryCommandRecorder.init(m_GfxDevice, m_ThreadPool.get_thread_count() + 1);
+}
+
+void Renderer::init_render_graph() {
+    m_renderGraph.init(m_GfxDevice);
+    m_GpuProfiler.init(m_GfxDevice);
+    m_renderGraph.set_profiler(&m_GpuProfiler);
+    m_GpuProfiler.set_capturing(CpuProfiler::get().is_capturing());
+
+    m_albedoResource = m_renderGraph.add_image("Albedo", m_TextureCache.get_render_texture_texture(m_albedoRTId).allocatedImage.image, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_worldNormalsResource = m_renderGraph.add_image("World normals", m_TextureCache.get_render_texture_texture(m_worldNormalsRTId).allocatedImage.image, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_metallicRoughnessResource = m_renderGraph.add_image("Metallic roughness", m_TextureCache.get_render_texture_texture(m_metallicRoughnessRTId).allocatedImage.image, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_depthResource = m_renderGraph.add_image("Depth", m_GfxDevice.m_depthImage.image, VK_IMAGE_ASPECT_DEPTH_BIT);
+    m_lightingResource = m_renderGraph.add_image("Lighting", m_TextureCache.get_render_texture_texture(m_lightingRTId).allocatedImage.image, VK_IMAGE_ASPECT_COLOR_BIT);
+    // Swapchain image and GPU scene buffers change every frame, they're set in drawFrame(). Headless images are left ready to be read back
+    const VkImageLayout swapchainFinalLayout = m_GfxDevice.is_headless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    m_swapchainResource = m_renderGraph.add_image("Swapchain", VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT, true, swapchainFinalLayout);
+    m_drawCommandsResource = m_renderGraph.add_buffer("Draw commands", VK_NULL_HANDLE);
+    m_drawCountsResource = m_renderGraph.add_buffer("Draw counts", VK_NULL_HANDLE);
+
+    m_renderGraph.mark_output(m_swapchainResource);
 }
 
 void Renderer::init_scene_data() {
     m_CPUSceneData.view = camera.get_view_matrix();
-    glm::mat4 projection = glm::perspective(glm::radians(70.f), (float)WINDOW_WIDTH/(float)WINDOW_HEIGHT, 0.1f, 200.0f);
+    const VkExtent2D renderExtent = m_GfxDevice.get_render_extent();
+    glm::mat4 projection = glm::perspective(glm::radians(70.f), (float)renderExtent.width/(float)renderExtent.height, 0.1f, 200.0f);
     projection[1][1] *= -1; // flips the model because Vulkan uses positive Y downwards
     m_CPUSceneData.projection = projection;
     m_CPUSceneData.cameraWorldPosition = camera.get_world_position();
@@ -497,25 +617,8 @@ void Renderer::init_scene_data() {
     };
     m_CPUSceneData.materialBufferAddress = vkGetBufferDeviceAddress(m_GfxDevice, &materialBufferAddressInfo);
 
-    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        upload_buffer(
-            m_GPUSceneDataBuffers[i],
-            sizeof(CPUSceneData),
-            &m_CPUSceneData,
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR,
-            m_GfxDevice.m_vmaAllocator
-        );
-    }
-
-    for (auto &sceneDataBuffer : m_GPUSceneDataBuffers)
-    {
-        VkBufferDeviceAddressInfoKHR sceneDataBufferAddressInfo{
-            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR,
-            .buffer = sceneDataBuffer.buffer
-        };
-        sceneDataBuffer.gpuAddress  = vkGetBufferDeviceAddress(m_GfxDevice, &sceneDataBufferAddressInfo);
-    }
+    // Scene data and lights are written into the frame allocator every frame from here on
+    m_FrameAllocator.init(m_GfxDevice, FRAME_ALLOCATOR_CHUNK_SIZE);
 }
 
 void Renderer::update_texture_descriptors() {
@@ -605,6 +708,7 @@ void Renderer::init_imgui() {
         .PhysicalDevice = m_GfxDevice.get_physical_device(),
         .Device = m_GfxDevice,
         .Queue = m_GfxDevice.get_graphics_queue(),
+        .PipelineCache = m_GfxDevice.get_pipeline_cache().get_handle(),
         .DescriptorPool = m_imguiPool,
         .MinImageCount = 3,
         .ImageCount = 3,
@@ -630,7 +734,7 @@ void Renderer::draw_imgui(VkImageView targetImageView) {
     VkRenderingAttachmentInfoKHR colorAttachment = rendering_attachment_info(
         targetImageView, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, nullptr
     );
-    VkRenderingInfoKHR renderingInfo = rendering_info_fullscreen(1, &colorAttachment, nullptr);
+    VkRenderingInfoKHR renderingInfo = rendering_info_fullscreen(m_GfxDevice.get_render_extent(), 1, &colorAttachment, nullptr);
 
     PFN_vkCmdBeginRenderingKHR vkCmdBeginRenderingKHR = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(m_GfxDevice, "vkCmdBeginRenderingKHR"));
 
@@ -644,7 +748,8 @@ void Renderer::draw_imgui(VkImageView targetImageView) {
     vkCmdEndRenderingKHR(cmdBuffer);
 }
 
-void Renderer::update_lights(uint32_t frameInFlightIndex) {
+[[nodiscard]] VkDeviceAddress Renderer::update_lights() {
+    MR_PROFILE_ZONE("Update lights");
     if (m_pointLightsExist)
     {
         int lightCircleRadius = 2;
@@ -660,49 +765,62 @@ void Renderer::update_lights(uint32_t frameInFlightIndex) {
             lightCircleRadius * glm::cos(lightCircleSpeed * frameNumber)
         );
 
-
-        update_buffer(
-            m_GPUPointLightsBuffers[frameInFlightIndex],
-            m_CPUPointLights.size() * sizeof(PointLight),
-            m_CPUPointLights.data(),
-            m_GfxDevice.m_vmaAllocator
-        );
+        return m_FrameAllocator.push(std::span<const PointLight>(m_CPUPointLights)).gpuAddress;
     }
+    return 0;
 }
 
-void Renderer::update_scene_data(uint32_t frameInFlightIndex) {
+[[nodiscard]] VkDeviceAddress Renderer::update_scene_data(VkDeviceAddress lightBufferAddress) {
+    MR_PROFILE_ZONE("Update scene data");
     m_CPUSceneData.view = camera.get_view_matrix();
-    glm::mat4 projection = glm::perspective(glm::radians(70.f), (float)WINDOW_WIDTH/(float)WINDOW_HEIGHT, 0.1f, 200.0f);
+    const VkExtent2D renderExtent = m_GfxDevice.get_render_extent();
+    glm::mat4 projection = glm::perspective(glm::radians(70.f), (float)renderExtent.width/(float)renderExtent.height, 0.1f, 200.0f);
     projection[1][1] *= -1; // flips the model because Vulkan uses positive Y downwards
     m_CPUSceneData.projection = projection;
     m_CPUSceneData.cameraWorldPosition = camera.get_world_position();
-    m_CPUSceneData.lightBufferAddress = m_GPUPointLightsBuffers[frameInFlightIndex].gpuAddress;
+    m_CPUSceneData.lightBufferAddress = lightBufferAddress;
     m_CPUSceneData.numPointLights = static_cast<int>(m_CPUPointLights.size());
     m_CPUSceneData.directionalLight = m_directionalLight;
 
-    update_buffer(
-        m_GPUSceneDataBuffers[frameInFlightIndex],
-        sizeof(CPUSceneData),
-        &m_CPUSceneData,
-        m_GfxDevice.m_vmaAllocator
-    );
+    return m_FrameAllocator.push(m_CPUSceneData).gpuAddress;
 }
 
 void Renderer::drawFrame() {
+        MR_PROFILE_ZONE("Draw frame");
 
         // Wait for previous frame to finish rendering before allowing us to acquire another image
         VkFence renderFence = m_GfxDevice.get_frame_fence(m_currentFrame);
-        VkResult res = vkWaitForFences(m_GfxDevice, 1, &renderFence, true, (std::numeric_limits<uint64_t>::max)());
+        VkResult res;
+        {
+            MR_PROFILE_ZONE("Wait for frame fence");
+            const int64_t fenceWaitStartNs = CpuProfiler::now_ns();
+            res = vkWaitForFences(m_GfxDevice, 1, &renderFence, true, (std::numeric_limits<uint64_t>::max)());
+            m_lastFenceWaitMs = static_cast<double>(CpuProfiler::now_ns() - fenceWaitStartNs) / 1e6;
+        }
         vkResetFences(m_GfxDevice, 1, &renderFence);
-        update_lights(m_currentFrame); // Executes immediately
-        update_scene_data(m_currentFrame);
+        // The GPU is done with this frame's previous allocations, so they can be overwritten
+        m_FrameAllocator.begin_frame(m_currentFrame);
+        m_MeshCache.begin_frame(m_currentFrame);
+        m_GPUScene.begin_frame(m_currentFrame);
+        m_SecondaryCommandRecorder.begin_frame(m_currentFrame);
+        const VkDeviceAddress lightBufferAddress = update_lights();
+        const VkDeviceAddress sceneDataBufferAddress = update_scene_data(lightBufferAddress);
 
 
         VkSemaphore imageAvaliableSemaphore = m_GfxDevice.get_frame_imageAvailableSemaphore(m_currentFrame);
         VkSemaphore renderFinishedSemaphore = m_GfxDevice.get_frame_renderFinishedSemaphore(m_currentFrame);
 
         uint32_t imageIndex;
-        res = vkAcquireNextImageKHR(m_GfxDevice, m_GfxDevice.m_swapChain, std::numeric_limits<uint64_t>::max(), imageAvaliableSemaphore, VK_NULL_HANDLE, &imageIndex);
+        if (m_GfxDevice.is_headless())
+        {
+            // Headless images are only reused once the fence above says the frame that last used them is done
+            imageIndex = static_cast<uint32_t>(frameNumber) % static_cast<uint32_t>(m_GfxDevice.m_swapChainImages.size());
+        }
+        else
+        {
+            MR_PROFILE_ZONE("Acquire swapchain image");
+            res = vkAcquireNextImageKHR(m_GfxDevice, m_GfxDevice.m_swapChain, std::numeric_limits<uint64_t>::max(), imageAvaliableSemaphore, VK_NULL_HANDLE, &imageIndex);
+        }
         if (!((res == VK_SUCCESS) || (res == VK_SUBOPTIMAL_KHR))) {
             MRCERR(string_VkResult(res));
             MRCERR("Failed to acquire image from Swap Chain!");
@@ -713,356 +831,254 @@ void Renderer::drawFrame() {
         VkCommandBufferBeginInfo beginInfo = {};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
         vkBeginCommandBuffer(cmdBuffer, &beginInfo);
+        // The fence above has signalled, so this frame in flight's last timestamps are ready
+        m_GpuProfiler.begin_frame(cmdBuffer, m_currentFrame, static_cast<uint64_t>(frameNumber));
 
-
+        const Frustum frustum = extract_frustum(m_CPUSceneData.projection * m_CPUSceneData.view);
+        std::span<const InstanceBatch> instanceBatches;
+        if (!m_bGpuDrivenRendering)
         {
-            VkImageMemoryBarrier imb = image_memory_barrier(
-                m_GfxDevice.m_depthImage.image,
-                VK_ACCESS_NONE,
-                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
-                VK_IMAGE_ASPECT_DEPTH_BIT
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb
-            );
+            std::span<const uint32_t> visibleRenderMeshIndices = m_CPUFrustumCuller.cull(frustum, m_sceneRenderMeshComponents);
+            instanceBatches = m_InstanceBatcher.build(m_FrameAllocator, m_sceneRenderMeshComponents, visibleRenderMeshIndices);
         }
+        const VkDeviceAddress instanceTransformBufferAddress = m_InstanceBatcher.get_instance_transforms_address();
 
-        // Transition albedo and world normals RTs to color attachment
-        {
-            VkImageMemoryBarrier imb = image_memory_barrier(
-                m_TextureCache.get_render_texture_texture(m_albedoRTId).allocatedImage.image,
-                VK_ACCESS_NONE,
-                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb
-            );
-
-            VkImageMemoryBarrier imb2 = image_memory_barrier(
-                m_TextureCache.get_render_texture_texture(m_worldNormalsRTId).allocatedImage.image,
-                VK_ACCESS_NONE,
-                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb2
-            );
-
-            VkImageMemoryBarrier imb3 = image_memory_barrier(
-                m_TextureCache.get_render_texture_texture(m_metallicRoughnessRTId).allocatedImage.image,
-                VK_ACCESS_NONE,
-                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb3
-            );
-        }
+        // Per frame handles, the graph carries every resource's state over from the last frame that used it
+        m_renderGraph.set_image(m_swapchainResource, m_GfxDevice.m_swapChainImages[imageIndex], VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+        m_renderGraph.set_buffer(m_drawCommandsResource, m_GPUScene.get_draw_command_buffer().buffer);
+        m_renderGraph.set_buffer(m_drawCountsResource, m_GPUScene.get_draw_count_buffer().buffer);
 
         PFN_vkCmdBeginRenderingKHR vkCmdBeginRenderingKHR = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(m_GfxDevice, "vkCmdBeginRenderingKHR"));
         PFN_vkCmdEndRenderingKHR vkCmdEndRenderingKHR = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(m_GfxDevice, "vkCmdEndRenderingKHR"));
 
+        // GPU culling
+        if (m_bGpuDrivenRendering)
         {
-            VkRenderingAttachmentInfoKHR albedoAttachmentInfo = rendering_attachment_info(
-                m_TextureCache.get_render_texture_texture(m_albedoRTId).allocatedImage.imageView,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                &DEFAULT_CLEAR_VALUE_COLOR
-            );
-
-            VkRenderingAttachmentInfoKHR worldNormalsAttachmentInfo = rendering_attachment_info(
-                m_TextureCache.get_render_texture_texture(m_worldNormalsRTId).allocatedImage.imageView,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                &DEFAULT_CLEAR_VALUE_ZERO
-            );
-
-            VkRenderingAttachmentInfoKHR metallicRoughnessAttachmentInfo = rendering_attachment_info(
-                m_TextureCache.get_render_texture_texture(m_metallicRoughnessRTId).allocatedImage.imageView,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                &DEFAULT_CLEAR_VALUE_ZERO
-            );
-
-            constexpr uint32_t colorAttachmentCount = 3;
-
-            VkRenderingAttachmentInfoKHR colorAttachmentInfos[colorAttachmentCount] = { albedoAttachmentInfo, worldNormalsAttachmentInfo, metallicRoughnessAttachmentInfo };
-
-            VkRenderingAttachmentInfoKHR depthAttachmentInfo  = rendering_attachment_info(
-                m_GfxDevice.m_depthImage.imageView,
-                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                &DEFAULT_CLEAR_VALUE_DEPTH
-            );
-
-            VkRenderingInfoKHR renderingInfo = rendering_info_fullscreen(
-                colorAttachmentCount, colorAttachmentInfos, &depthAttachmentInfo
-            );
-            vkCmdBeginRenderingKHR(cmdBuffer, &renderingInfo);
-
-            m_pGbufferStage->Draw(cmdBuffer, m_GPUSceneDataBuffers[m_currentFrame].gpuAddress, m_sceneRenderMeshComponents);
-
-            vkCmdEndRenderingKHR(cmdBuffer);
+            if (m_pCullingStage->is_compacting())
+            {
+                m_renderGraph.add_pass("Clear draw counts", {{m_drawCountsResource, RenderGraphUsage::TransferDst}},
+                    [&](VkCommandBuffer passCmdBuffer) {
+                        m_pCullingStage->ClearDrawCounts(passCmdBuffer, m_GPUScene);
+                    });
+                m_renderGraph.add_pass("Culling", {
+                        {m_drawCountsResource, RenderGraphUsage::ComputeStorageReadWrite},
+                        {m_drawCommandsResource, RenderGraphUsage::ComputeStorageWrite}},
+                    [&](VkCommandBuffer passCmdBuffer) {
+                        m_pCullingStage->Dispatch(passCmdBuffer, m_FrameAllocator, m_GPUScene, frustum);
+                    });
+            }
+            else
+            {
+                m_renderGraph.add_pass("Culling", {{m_drawCommandsResource, RenderGraphUsage::ComputeStorageWrite}},
+                    [&](VkCommandBuffer passCmdBuffer) {
+                        m_pCullingStage->Dispatch(passCmdBuffer, m_FrameAllocator, m_GPUScene, frustum);
+                    });
+            }
         }
 
-
-
-
-
-
-        // Transition gbuffer + depth image to sampled images
+        // G Buffer
         {
-            VkImageMemoryBarrier imb = image_memory_barrier(
-                m_TextureCache.get_render_texture_texture(m_albedoRTId).allocatedImage.image,
-                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                VK_ACCESS_SHADER_READ_BIT,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb
-            );
-
-            VkImageMemoryBarrier imb2 = image_memory_barrier(
-                m_TextureCache.get_render_texture_texture(m_worldNormalsRTId).allocatedImage.image,
-                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                VK_ACCESS_SHADER_READ_BIT,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb2
-            );
-
-            VkImageMemoryBarrier imb3 = image_memory_barrier(
-                m_TextureCache.get_render_texture_texture(m_metallicRoughnessRTId).allocatedImage.image,
-                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                VK_ACCESS_SHADER_READ_BIT,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb3
-            );
-
-            VkImageMemoryBarrier imb4 = image_memory_barrier(
-                m_GfxDevice.m_depthImage.image,
-                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-                // VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_ACCESS_SHADER_READ_BIT,
-                VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
-                // VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                VK_IMAGE_ASPECT_DEPTH_BIT
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb4
-            );
-        }
+            auto recordGBuffer = [&](VkCommandBuffer passCmdBuffer) {
+                VkRenderingAttachmentInfoKHR albedoAttachmentInfo = rendering_attachment_info(
+                    m_TextureCache.get_render_texture_texture(m_albedoRTId).allocatedImage.imageView,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    &DEFAULT_CLEAR_VALUE_COLOR
+                );
+
+                VkRenderingAttachmentInfoKHR worldNormalsAttachmentInfo = rendering_attachment_info(
+                    m_TextureCache.get_render_texture_texture(m_worldNormalsRTId).allocatedImage.imageView,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    &DEFAULT_CLEAR_VALUE_ZERO
+                );
+
+                VkRenderingAttachmentInfoKHR metallicRoughnessAttachmentInfo = rendering_attachment_info(
+                    m_TextureCache.get_render_texture_texture(m_metallicRoughnessRTId).allocatedImage.imageView,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    &DEFAULT_CLEAR_VALUE_ZERO
+                );
+
+                constexpr uint32_t colorAttachmentCount = 3;
+
+                VkRenderingAttachmentInfoKHR colorAttachmentInfos[colorAttachmentCount] = { albedoAttachmentInfo, worldNormalsAttachmentInfo, metallicRoughnessAttachmentInfo };
+
+                VkRenderingAttachmentInfoKHR depthAttachmentInfo  = rendering_attachment_info(
+                    m_GfxDevice.m_depthImage.imageView,
+                    VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+                    &DEFAULT_CLEAR_VALUE_DEPTH
+                );
+
+                VkRenderingInfoKHR renderingInfo = rendering_info_fullscreen(
+                    m_GfxDevice.get_render_extent(), colorAttachmentCount, colorAttachmentInfos, &depthAttachmentInfo
+                );
+
+                if (m_bGpuDrivenRendering)
+                {
+                    vkCmdBeginRenderingKHR(passCmdBuffer, &renderingInfo);
+                    m_pGbufferStage->DrawIndirect(passCmdBuffer, sceneDataBufferAddress, m_MeshCache, m_GPUScene);
+                }
+                else if (m_bMultithreadedRecording)
+                {
+                    // Worker threads each record a slice of the instanced draws, the primary only executes them in order
+                    renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR;
+                    vkCmdBeginRenderingKHR(passCmdBuffer, &renderingInfo);
+
+                    VkFormat colorAttachmentFormats[colorAttachmentCount] = {
+                        m_TextureCache.get_render_texture_texture(m_albedoRTId).allocatedImage.imageFormat,
+                        m_TextureCache.get_render_texture_texture(m_worldNormalsRTId).allocatedImage.imageFormat,
+                        m_TextureCache.get_render_texture_texture(m_metallicRoughnessRTId).allocatedImage.imageFormat
+                    };
+                    VkCommandBufferInheritanceRenderingInfoKHR inheritanceRenderingInfo = {
+                        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR,
+                        .pNext = nullptr,
+                        .flags = {},
+                        .viewMask = 0,
+                        .colorAttachmentCount = colorAttachmentCount,
+                        .pColorAttachmentFormats = colorAttachmentFormats,
+                        .depthAttachmentFormat = m_GfxDevice.m_depthImage.imageFormat,
+                        .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+                        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+                    };
+                    std::span<const VkCommandBuffer> secondaryCmdBuffers = m_SecondaryCommandRecorder.record(
+                        m_ThreadPool, inheritanceRenderingInfo, instanceBatches.size(),
+                        [&](VkCommandBuffer secondaryCmdBuffer, size_t first, size_t count) {
+                            m_pGbufferStage->Draw(secondaryCmdBuffer, sceneDataBufferAddress, instanceTransformBufferAddress, m_MeshCache, instanceBatches.subspan(first, count));
+                        });
+                    vkCmdExecuteCommands(passCmdBuffer, static_cast<uint32_t>(secondaryCmdBuffers.size()), secondaryCmdBuffers.data());
+                }
+                else
+                {
+                    vkCmdBeginRenderingKHR(passCmdBuffer, &renderingInfo);
+                    m_pGbufferStage->Draw(passCmdBuffer, sceneDataBufferAddress, instanceTransformBufferAddress, m_MeshCache, instanceBatches);
+                }
 
+                vkCmdEndRenderingKHR(passCmdBuffer);
+            };
 
-        // Transition lighting outut image to color attachment
-        {
-            VkImageMemoryBarrier imb = image_memory_barrier(
-                m_TextureCache.get_render_texture_texture(m_lightingRTId).allocatedImage.image,
-                VK_ACCESS_NONE,
-                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb
-            );
+            if (m_bGpuDrivenRendering)
+            {
+                m_renderGraph.add_pass("G Buffer", {
+                        {m_drawCommandsResource, RenderGraphUsage::IndirectRead},
+                        {m_drawCountsResource, RenderGraphUsage::IndirectRead},
+                        {m_albedoResource, RenderGraphUsage::ColorAttachmentWrite},
+                        {m_worldNormalsResource, RenderGraphUsage::ColorAttachmentWrite},
+                        {m_metallicRoughnessResource, RenderGraphUsage::ColorAttachmentWrite},
+                        {m_depthResource, RenderGraphUsage::DepthAttachmentWrite}},
+                    std::move(recordGBuffer));
+            }
+            else
+            {
+                m_renderGraph.add_pass("G Buffer", {
+                        {m_albedoResource, RenderGraphUsage::ColorAttachmentWrite},
+                        {m_worldNormalsResource, RenderGraphUsage::ColorAttachmentWrite},
+                        {m_metallicRoughnessResource, RenderGraphUsage::ColorAttachmentWrite},
+                        {m_depthResource, RenderGraphUsage::DepthAttachmentWrite}},
+                    std::move(recordGBuffer));
+            }
         }
 
-
-
         // Lighting Pass
+        if (m_bTiledLighting && m_pTiledLightingStage)
         {
-            VkRenderingAttachmentInfoKHR lightingAttachmentInfo = rendering_attachment_info(
-                m_TextureCache.get_render_texture_texture(m_lightingRTId).allocatedImage.imageView,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                &DEFAULT_CLEAR_VALUE_COLOR
-            );
-            constexpr uint32_t lightingColorAttachmentCount = 1;
-            VkRenderingAttachmentInfoKHR lightingColorAttachmentInfos[lightingColorAttachmentCount] = { lightingAttachmentInfo };
-            VkRenderingInfoKHR lightingRenderingInfo = rendering_info_fullscreen(
-                lightingColorAttachmentCount, lightingColorAttachmentInfos, nullptr
-            );
-            vkCmdBeginRenderingKHR(cmdBuffer, &lightingRenderingInfo);
-
-            m_pLightingStage->Draw(cmdBuffer, m_GPUSceneDataBuffers[m_currentFrame].gpuAddress);
-
-            vkCmdEndRenderingKHR(cmdBuffer);
+            m_renderGraph.add_pass("Lighting", {
+                    {m_albedoResource, RenderGraphUsage::ComputeSampled},
+                    {m_worldNormalsResource, RenderGraphUsage::ComputeSampled},
+                    {m_metallicRoughnessResource, RenderGraphUsage::ComputeSampled},
+                    {m_depthResource, RenderGraphUsage::ComputeSampled},
+                    {m_lightingResource, RenderGraphUsage::ComputeStorageWrite}},
+                [&](VkCommandBuffer passCmdBuffer) {
+                    m_pTiledLightingStage->Dispatch(passCmdBuffer, m_FrameAllocator, sceneDataBufferAddress,
+                        m_CPUSceneData.view, m_CPUSceneData.projection, m_bShowTileLightCounts);
+                });
         }
-
-
-
-        // Draw imgui
-        draw_imgui(m_TextureCache.get_render_texture_texture(m_lightingRTId).allocatedImage.imageView);
-
-        // Transition lighting mage to copy src
+        else
         {
-            VkImageMemoryBarrier imb = image_memory_barrier(
-                m_TextureCache.get_render_texture_texture(m_lightingRTId).allocatedImage.image,
-                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                VK_ACCESS_TRANSFER_READ_BIT,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                VK_PIPELINE_STAGE_TRANSFER_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb
-            );
+            m_renderGraph.add_pass("Lighting", {
+                    {m_albedoResource, RenderGraphUsage::FragmentSampled},
+                    {m_worldNormalsResource, RenderGraphUsage::FragmentSampled},
+                    {m_metallicRoughnessResource, RenderGraphUsage::FragmentSampled},
+                    {m_depthResource, RenderGraphUsage::FragmentSampled},
+                    {m_lightingResource, RenderGraphUsage::ColorAttachmentWrite}},
+                [&](VkCommandBuffer passCmdBuffer) {
+                    VkRenderingAttachmentInfoKHR lightingAttachmentInfo = rendering_attachment_info(
+                        m_TextureCache.get_render_texture_texture(m_lightingRTId).allocatedImage.imageView,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        &DEFAULT_CLEAR_VALUE_COLOR
+                    );
+                    constexpr uint32_t lightingColorAttachmentCount = 1;
+                    VkRenderingAttachmentInfoKHR lightingColorAttachmentInfos[lightingColorAttachmentCount] = { lightingAttachmentInfo };
+                    VkRenderingInfoKHR lightingRenderingInfo = rendering_info_fullscreen(
+                        m_GfxDevice.get_render_extent(), lightingColorAttachmentCount, lightingColorAttachmentInfos, nullptr
+                    );
+                    vkCmdBeginRenderingKHR(passCmdBuffer, &lightingRenderingInfo);
+
+                    m_pLightingStage->Draw(passCmdBuffer, sceneDataBufferAddress);
+
+                    vkCmdEndRenderingKHR(passCmdBuffer);
+                });
         }
 
-
-        // Transition swapchain to copy dst
+        // Draw imgui, there's no UI when headless
+        if (!m_GfxDevice.is_headless())
         {
-            VkImageMemoryBarrier imb = image_memory_barrier(
-                m_GfxDevice.m_swapChainImages[imageIndex],
-                VK_ACCESS_NONE,
-                VK_ACCESS_TRANSFER_WRITE_BIT,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_TRANSFER_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1, &imb
-            );
-
+            m_renderGraph.add_pass("ImGui", {{m_lightingResource, RenderGraphUsage::ColorAttachmentReadWrite}},
+                [&](VkCommandBuffer) {
+                    draw_imgui(m_TextureCache.get_render_texture_texture(m_lightingRTId).allocatedImage.imageView);
+                });
         }
 
-        // Copy albedo image to swapchain
-        const VkImageCopy imageCopy= {
-            .srcSubresource = {
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1
-            },
-            .srcOffset = {
-                .x = 0,
-                .y = 0,
-                .z = 0
-            },
-            .dstSubresource = {
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1
-            },
-            .dstOffset = {
-                .x = 0,
-                .y = 0,
-                .z = 0
-            },
-            .extent = {
-                .width = WINDOW_WIDTH,
-                .height = WINDOW_HEIGHT,
-                .depth = 1
-            }
-        };
-
-        vkCmdCopyImage(
-            cmdBuffer,
-            //m_TextureCache.get_render_texture_texture(m_albedoRTId).allocatedImage.image,
-            m_TextureCache.get_render_texture_texture(m_lightingRTId).allocatedImage.image,
-            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-            m_GfxDevice.m_swapChainImages[imageIndex],
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            1,
-            &imageCopy
-        );
-
-
+        // Copy lighting image to swapchain
+        m_renderGraph.add_pass("Copy to swapchain", {
+                {m_lightingResource, RenderGraphUsage::TransferSrc},
+                {m_swapchainResource, RenderGraphUsage::TransferDst}},
+            [&](VkCommandBuffer passCmdBuffer) {
+                const VkImageCopy imageCopy= {
+                    .srcSubresource = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1
+                    },
+                    .srcOffset = {
+                        .x = 0,
+                        .y = 0,
+                        .z = 0
+                    },
+                    .dstSubresource = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1
+                    },
+                    .dstOffset = {
+                        .x = 0,
+                        .y = 0,
+                        .z = 0
+                    },
+                    .extent = {
+                        .width = m_GfxDevice.get_render_extent().width,
+                        .height = m_GfxDevice.get_render_extent().height,
+                        .depth = 1
+                    }
+                };
+
+                vkCmdCopyImage(
+                    passCmdBuffer,
+                    m_TextureCache.get_render_texture_texture(m_lightingRTId).allocatedImage.image,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    m_GfxDevice.m_swapChainImages[imageIndex],
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    1,
+                    &imageCopy
+                );
+            });
+
+        // Barriers, the swapchain's final transition to PRESENT_SRC_KHR included, come from the passes' declared accesses
         {
-            // Transition swapchain to correct presentation layout
-            VkImageMemoryBarrier imb = image_memory_barrier(
-                m_GfxDevice.m_swapChainImages[imageIndex],
-                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                {},
-                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-            );
-            vkCmdPipelineBarrier(
-                cmdBuffer,
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                {},
-                0, nullptr,
-                0, nullptr,
-                1,&imb
-            );
+            GpuProfileScope frameScope(m_GpuProfiler, cmdBuffer, "Frame");
+            m_renderGraph.execute(cmdBuffer);
         }
 
         vkEndCommandBuffer(cmdBuffer);
 
 
         // Submit graphics workload
-        VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT; // The swapchain image is first touched by the copy
         VkSubmitInfo submitInfo = {};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submitInfo.waitSemaphoreCount = 1;
@@ -1072,7 +1088,17 @@ void Renderer::drawFrame() {
         submitInfo.pCommandBuffers = &cmdBuffer;
         submitInfo.signalSemaphoreCount = 1;
         submitInfo.pSignalSemaphores = &renderFinishedSemaphore;
-        vkQueueSubmit(m_GfxDevice.get_graphics_queue(), 1, &submitInfo, renderFence);
+        if (m_GfxDevice.is_headless())
+        {
+            // Nothing was acquired and nothing will be presented
+            submitInfo.waitSemaphoreCount = 0;
+            submitInfo.signalSemaphoreCount = 0;
+        }
+        {
+            MR_PROFILE_ZONE("Submit");
+            vkQueueSubmit(m_GfxDevice.get_graphics_queue(), 1, &submitInfo, renderFence);
+        }
+        m_lastImageIndex = imageIndex;
 
 
         // Present frame
@@ -1084,7 +1110,11 @@ void Renderer::drawFrame() {
         presentInfo.pSwapchains = &m_GfxDevice.m_swapChain;
         presentInfo.pImageIndices = &imageIndex;
         // res = vkQueuePresentKHR(presentQueue, &presentInfo);
-        res = vkQueuePresentKHR(m_GfxDevice.get_graphics_queue(), &presentInfo);
+        if (!m_GfxDevice.is_headless())
+        {
+            MR_PROFILE_ZONE("Present");
+            res = vkQueuePresentKHR(m_GfxDevice.get_graphics_queue(), &presentInfo);
+        }
 
 
         m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
@@ -1092,12 +1122,123 @@ void Renderer::drawFrame() {
 
 }
 
+void Renderer::run_headless() {
+    MRLOG("Rendering " << m_options.headlessFrameCount << " headless frames");
+    const auto renderStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < m_options.headlessFrameCount; i++)
+    {
+        if (CpuProfiler::get().is_capture_due())
+        {
+            write_profiler_trace();
+        }
+        MR_PROFILE_ZONE("Frame");
+        drawFrame();
+    }
+    vkDeviceWaitIdle(m_GfxDevice);
+    const auto renderEnd = std::chrono::steady_clock::now();
+    MRLOG("Rendered " << m_options.headlessFrameCount << " headless frames in " << std::chrono::duration_cast<std::chrono::milliseconds>(renderEnd - renderStart).count() << "ms");
+}
+
+void Renderer::run_benchmark() {
+    const CameraPath cameraPath = make_benchmark_camera_path();
+    const uint32_t recordedFrameCount = static_cast<uint32_t>(cameraPath.get_duration() / BENCHMARK_TIMESTEP_SECONDS) + 1;
+    BenchmarkRecorder recorder(static_cast<uint64_t>(frameNumber) + BENCHMARK_WARMUP_FRAMES, recordedFrameCount);
+    MRLOG("Benchmark: " << BENCHMARK_WARMUP_FRAMES << " warm up frames then " << recordedFrameCount << " recorded frames along the camera path");
+
+    // Only the path moves the camera, and every frame advances the simulation by the same step however long it really took.
+    // Lights animate from frameNumber, so each run sees the same scene on the same frame
+    camera.freeze_camera();
+    deltaTime = BENCHMARK_TIMESTEP_SECONDS;
+    SDL_Event sdlEvent;
+    bool bQuit = false;
+    for (uint32_t i = 0; i < BENCHMARK_WARMUP_FRAMES + recordedFrameCount && !bQuit; i++)
+    {
+        if (CpuProfiler::get().is_capture_due())
+        {
+            write_profiler_trace();
+        }
+        const uint64_t currentFrameNumber = static_cast<uint64_t>(frameNumber);
+        const int64_t frameStartNs = CpuProfiler::now_ns();
+        {
+            MR_PROFILE_ZONE("Frame");
+            if (!m_GfxDevice.is_headless())
+            {
+                while (SDL_PollEvent(&sdlEvent) != 0)
+                {
+                    if (sdlEvent.type == SDL_EVENT_QUIT)
+                    {
+                        bQuit = true;
+                    }
+                }
+                // The ImGui pass still runs, just with nothing in it
+                ImGui_ImplVulkan_NewFrame();
+                ImGui_ImplSDL3_NewFrame();
+                ImGui::NewFrame();
+                ImGui::Render();
+            }
+            const float pathTime = i < BENCHMARK_WARMUP_FRAMES ? 0.0f : static_cast<float>(i - BENCHMARK_WARMUP_FRAMES) * BENCHMARK_TIMESTEP_SECONDS;
+            const CameraKeyframe pose = cameraPath.sample(pathTime);
+            camera.set_pose(pose.position, pose.yaw, pose.pitch);
+            drawFrame();
+        }
+        recorder.record_frame(currentFrameNumber, static_cast<double>(CpuProfiler::now_ns() - frameStartNs) / 1e6, m_lastFenceWaitMs);
+        // A frame's GPU time arrives MAX_FRAMES_IN_FLIGHT frames later, the history is long enough that none are missed between calls
+        for (const GpuProfiler::Sample& sample : m_GpuProfiler.get_samples("Frame"))
+        {
+            recorder.set_gpu_time(sample.frameNumber, sample.ms);
+        }
+    }
+    vkDeviceWaitIdle(m_GfxDevice);
+    m_GpuProfiler.collect_pending();
+    for (const GpuProfiler::Sample& sample : m_GpuProfiler.get_samples("Frame"))
+    {
+        recorder.set_gpu_time(sample.frameNumber, sample.ms);
+    }
+    camera.unfreeze_camera();
+    if (bQuit)
+    {
+        MRWARN("Benchmark was interrupted, the results only cover the frames rendered so far");
+    }
+
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(m_GfxDevice.get_physical_device(), &physicalDeviceProperties);
+    const VkExtent2D renderExtent = m_GfxDevice.get_render_extent();
+    const BenchmarkInfo benchmarkInfo = {
+        .deviceName = physicalDeviceProperties.deviceName,
+        .width = renderExtent.width,
+        .height = renderExtent.height,
+        .bGpuDrivenRendering = m_bGpuDrivenRendering,
+        .bTiledLighting = m_bTiledLighting && m_pTiledLightingStage != nullptr
+    };
+    const std::string outputPath = m_options.benchmarkOutputPath.empty() ? std::string(ROOT_DIR "benchmark.json") : m_options.benchmarkOutputPath;
+    UNUSED(recorder.write_json(outputPath, benchmarkInfo)); // Logs the outcome itself
+}
+
+void Renderer::write_profiler_trace() {
+    m_bTraceRequested = false;
+    m_GpuProfiler.set_capturing(false);
+    // Without calibration GPU timestamps can't be placed on the CPU timeline, the trace only has CPU zones then
+    std::vector<ProfilerTrack> extraTracks;
+    if (m_GpuProfiler.can_calibrate())
+    {
+        extraTracks.push_back(m_GpuProfiler.take_capture());
+    }
+    const std::string tracePath = ROOT_DIR "trace_frame" + std::to_string(frameNumber) + ".json";
+    UNUSED(CpuProfiler::get().end_capture(tracePath, extraTracks)); // Logs the outcome itself
+}
+
 void Renderer::mainLoop() {
     SDL_Event sdlEvent;
     bool bQuit = false;
     ImGuiIO& io = ImGui::GetIO();
     UNUSED(io);
     while (!bQuit) {
+        // Between frames, so no zone is open on any thread
+        if (CpuProfiler::get().is_capture_due() || m_bTraceRequested)
+        {
+            write_profiler_trace();
+        }
+        MR_PROFILE_ZONE("Frame");
         // Handle events on queue
         while (SDL_PollEvent(&sdlEvent) != 0) {
             ImGui_ImplSDL3_ProcessEvent(&sdlEvent);
@@ -1150,6 +1291,88 @@ void Renderer::mainLoop() {
         ImGui::SliderFloat("Directional Light y", &m_directionalLight.direction.y, -1.0f, 1.0f);
         ImGui::SliderFloat("Directional Light z", &m_directionalLight.direction.z, -1.0f, 1.0f);
         ImGui::SliderFloat("Directional Light power", &m_directionalLight.power,  0.0f, 1.0f);
+        if (ImGui::SliderInt("Extra point lights", &m_extraPointLightCount, 0, 8192))
+        {
+            spawn_extra_point_lights();
+        }
+        if (m_pTiledLightingStage)
+        {
+            ImGui::Checkbox("Tiled compute lighting", &m_bTiledLighting);
+            if (m_bTiledLighting)
+            {
+                ImGui::Checkbox("Show tile light counts", &m_bShowTileLightCounts);
+                if (m_CPUPointLights.size() > TiledLightingStage::MAX_LIGHTS_PER_TILE)
+                {
+                    ImGui::Text("Tiles touched by more than %u lights drop the rest, they show magenta in the light counts", TiledLightingStage::MAX_LIGHTS_PER_TILE);
+                }
+            }
+        }
+
+        ImGui::Text("Textures: %u, mip levels: %u (GPU blit chains: %u, CPU chains: %u)",
+            m_TextureCache.get_texture_count(), m_TextureCache.get_total_mip_level_count(),
+            m_TextureCache.get_gpu_generated_mip_chain_count(), m_TextureCache.get_cpu_generated_mip_chain_count());
+        ImGui::Text("Cooked (BCn) textures: %u, texture memory: %.1f MB",
+            m_TextureCache.get_cooked_texture_count(), m_TextureCache.get_texture_memory_size() / (1024.0 * 1024.0));
+        ImGui::Text("Frame allocator: %.1f KB used / %.1f KB reserved", m_FrameAllocator.get_frame_bytes_used() / 1024.0, m_FrameAllocator.get_total_bytes_reserved() / 1024.0);
+        ImGui::Text("Render targets: %.1f MB heap, %u lazily allocated (%.1f MB)",
+            m_TransientImageAllocator.get_heap_size() / (1024.0 * 1024.0), m_TransientImageAllocator.get_lazily_allocated_count(),
+            m_TransientImageAllocator.get_lazily_allocated_size() / (1024.0 * 1024.0));
+        if (m_GfxDevice.supports_gpu_driven())
+        {
+            ImGui::Checkbox("GPU driven rendering", &m_bGpuDrivenRendering);
+        }
+        ImGui::Text("GPU scene objects: %u, written this frame: %u", m_GPUScene.get_object_count(), m_GPUScene.get_objects_written_this_frame());
+        if (!m_bGpuDrivenRendering)
+        {
+            ImGui::Text("CPU frustum culling: %u visible, %u culled", m_CPUFrustumCuller.get_visible_count(), m_CPUFrustumCuller.get_culled_count());
+            ImGui::Text("Instanced draws: %u for %u instances", m_InstanceBatcher.get_batch_count(), m_InstanceBatcher.get_instance_count());
+            ImGui::Checkbox("Multithreaded command recording", &m_bMultithreadedRecording);
+            ImGui::Text("Secondary command buffers: %u", m_bMultithreadedRecording ? m_SecondaryCommandRecorder.get_chunk_count() : 0);
+        }
+        ImGui::Text("Render graph: %u passes (%u culled), %u barriers in %u batches",
+            m_renderGraph.get_executed_pass_count(), m_renderGraph.get_culled_pass_count(),
+            m_renderGraph.get_barrier_count(), m_renderGraph.get_barrier_batch_count());
+        if (m_GpuProfiler.is_supported() && ImGui::CollapsingHeader("GPU timings", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            if (ImGui::BeginTable("GPU timings", 4))
+            {
+                ImGui::TableSetupColumn("Scope");
+                ImGui::TableSetupColumn("Avg (ms)");
+                ImGui::TableSetupColumn("Min (ms)");
+                ImGui::TableSetupColumn("Max (ms)");
+                ImGui::TableHeadersRow();
+                for (const GpuProfiler::ScopeStats& scopeStats : m_GpuProfiler.get_scope_stats())
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(scopeStats.name.c_str());
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", scopeStats.averageMs);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", scopeStats.minMs);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", scopeStats.maxMs);
+                }
+                ImGui::EndTable();
+            }
+            ImGui::Text("Over the last %u frames", GPU_PROFILER_HISTORY_SIZE);
+            if (ImGui::Button("Export GPU timings to CSV"))
+            {
+                UNUSED(m_GpuProfiler.export_csv(ROOT_DIR "gpu_timings.csv")); // Logs the outcome itself
+            }
+        }
+        if (ImGui::CollapsingHeader("CPU/GPU trace"))
+        {
+            if (!CpuProfiler::get().is_capturing())
+            {
+                if (ImGui::Button("Start trace capture"))
+                {
+                    CpuProfiler::get().begin_capture();
+                    m_GpuProfiler.set_capturing(true);
+                }
+            }
+            else if (ImGui::Button("Write trace"))
+            {
+                m_bTraceRequested = true;
+            }
+            ImGui::Text("GPU track: %s", m_GpuProfiler.can_calibrate() ? "calibrated" : "unavailable (needs VK_EXT_calibrated_timestamps)");
+        }
 
         ImGui::SliderFloat("rx", &rx,  -1.0f, 1.0f);
         ImGui::SliderFloat("ry", &ry,  -1.0f, 1.0f);
@@ -1162,6 +1385,7 @@ void Renderer::mainLoop() {
                 glm::mat4 rotate = glm::rotate(translate, rm, glm::vec3(rx, ry, rz));
                 glm::mat4 scale = glm::scale(rotate, glm::vec3(1.0f, 1.0f, 1.0f));
                 renderMeshComponent.m_transformMatrix = scale;
+                m_GPUScene.set_transform(static_cast<uint32_t>(m_sceneRenderMeshComponents.size() - 1), scale);
         // }
         ImGui::End();
         ImGui::Render();
@@ -1205,31 +1429,35 @@ void Renderer::mainLoop() {
 
 void Renderer::cleanup() {
     vkDeviceWaitIdle(m_GfxDevice);
+    if (CpuProfiler::get().is_capturing())
+    {
+        write_profiler_trace();
+    }
 
-    ImGui_ImplVulkan_Shutdown();
-    ImGui_ImplSDL3_Shutdown();
-    ImGui::DestroyContext();
-    vkDestroyDescriptorPool(m_GfxDevice, m_imguiPool, nullptr);
+    if (!m_GfxDevice.is_headless())
+    {
+        ImGui_ImplVulkan_Shutdown();
+        ImGui_ImplSDL3_Shutdown();
+        ImGui::DestroyContext();
+        vkDestroyDescriptorPool(m_GfxDevice, m_imguiPool, nullptr);
+    }
 
     vkDestroyDescriptorSetLayout(m_GfxDevice, m_bindlessDescriptorSetLayout, nullptr);
     vkDestroyDescriptorPool(m_GfxDevice, m_bindlessPool, nullptr);
 
     m_materialDataBuffer.cleanup(m_GfxDevice.m_vmaAllocator);
 
-    if (m_pointLightsExist)
-    {
-        for (auto buffer: m_GPUPointLightsBuffers)
-        {
-            buffer.cleanup(m_GfxDevice.m_vmaAllocator);
-        }
-    }
+    m_FrameAllocator.cleanup(m_GfxDevice);
+    m_GPUScene.cleanup(m_GfxDevice);
+    m_SecondaryCommandRecorder.cleanup();
+    m_GpuProfiler.cleanup();
 
-    for (auto buffer: m_GPUSceneDataBuffers)
+    m_pCullingStage->Cleanup();
+    m_pLightingStage->Cleanup();
+    if (m_pTiledLightingStage)
     {
-        buffer.cleanup(m_GfxDevice.m_vmaAllocator);
+        m_pTiledLightingStage->Cleanup();
     }
-
-    m_pLightingStage->Cleanup();
     m_pGbufferStage->Cleanup();
     vkDestroyDescriptorPool(m_GfxDevice, m_globalDescriptorPool, nullptr);
 
@@ -1238,8 +1466,12 @@ void Renderer::cleanup() {
     vkDestroySampler(m_GfxDevice, m_nearestSampler, nullptr);
 
     m_TextureCache.cleanup(m_GfxDevice);
+    m_TransientImageAllocator.cleanup(m_GfxDevice); // After the render targets bound to it are destroyed
     m_MeshCache.cleanup(m_GfxDevice);
     m_GfxDevice.cleanup();
 
-    SDL_DestroyWindow(m_window);
+    if (m_window)
+    {
+        SDL_DestroyWindow(m_window);
+    }
 }
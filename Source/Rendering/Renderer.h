@@ -17,32 +17,56 @@
 #include <Wrappers/Buffer.h>
 #include <Rendering/SceneData.h>
 #include <Common/Config.h>
+#include <Common/ThreadPool.h>
+#include <Rendering/FrameAllocator.h>
+#include <Rendering/GPUScene.h>
+#include <Rendering/CPUFrustumCuller.h>
+#include <Rendering/InstanceBatcher.h>
+#include <Rendering/SecondaryCommandRecorder.h>
+#include <Rendering/RenderGraph.h>
+#include <Rendering/TransientImageAllocator.h>
+#include <Rendering/GpuProfiler.h>
+#include <Rendering/RendererOptions.h>
 
 #include <Rendering/GBufferStage.h>
 #include <Rendering/BlinnPhongLightingStage.h>
+#include <Rendering/TiledLightingStage.h>
+#include <Rendering/CullingStage.h>
 
 class SDL_window;
+struct CPUModel;
 
 class Renderer {
 public:
-    Renderer() = default;
+    explicit Renderer(const RendererOptions& _options);
     void run();
 private:
-    SDL_Window *m_window;
+    const RendererOptions m_options;
+    SDL_Window *m_window{nullptr}; // Stays null when headless
     GfxDevice m_GfxDevice;
     MeshCache m_MeshCache;
     MaterialCache m_MaterialCache;
     TextureCache m_TextureCache;
+    ThreadPool m_ThreadPool;
+    FrameAllocator m_FrameAllocator;
+    GPUScene m_GPUScene;
+    CPUFrustumCuller m_CPUFrustumCuller;
+    InstanceBatcher m_InstanceBatcher;
+    SecondaryCommandRecorder m_SecondaryCommandRecorder;
+    GpuProfiler m_GpuProfiler;
 
     VkDescriptorPool m_imguiPool;
     uint32_t m_currentFrame = 0;
+    uint32_t m_lastImageIndex = 0; // Swapchain (or headless) image the last drawFrame() rendered to
+    double m_lastFenceWaitMs = 0.0; // How long the last drawFrame() blocked on its frame in flight's fence
 
     std::vector<RenderMeshComponent> m_sceneRenderMeshComponents;
 
     // Lights
     std::vector<PointLight> m_CPUPointLights;
-    std::array<AllocatedBuffer, MAX_FRAMES_IN_FLIGHT> m_GPUPointLightsBuffers;
     bool m_pointLightsExist = false;
+    size_t m_basePointLightCount = 0; // Animated lights from init_lights(), the extra lights come after them
+    int m_extraPointLightCount = 0;
     DirectionalLight m_directionalLight;
 
     // MaterialData
@@ -50,7 +74,6 @@ private:
 
     // SceneData
     CPUSceneData m_CPUSceneData;
-    std::array<AllocatedBuffer, MAX_FRAMES_IN_FLIGHT> m_GPUSceneDataBuffers;
 
     // Descriptors
     VkDescriptorPool m_bindlessPool;
@@ -66,17 +89,41 @@ private:
     // Imgui
     bool m_bShowRenderingMenu = true;
     bool m_bInteractableUI = false;
+    bool m_bGpuDrivenRendering = true;
+    bool m_bMultithreadedRecording = true;
+    bool m_bTiledLightingSupported = false;
+    bool m_bTiledLighting = true;
+    bool m_bShowTileLightCounts = false;
+    bool m_bTraceRequested = false; // Write the running profiler capture at the start of the next frame
 
     // RTs TODO:
+    TransientImageAllocator m_TransientImageAllocator;
+    uint32_t m_albedoTransientIndex{0};
+    uint32_t m_worldNormalsTransientIndex{0};
+    uint32_t m_metallicRoughnessTransientIndex{0};
+    uint32_t m_lightingTransientIndex{0};
     GPUTextureId m_albedoRTId{NULL_GPU_TEXTURE_ID};
     GPUTextureId m_worldNormalsRTId{NULL_GPU_TEXTURE_ID};
     GPUTextureId m_metallicRoughnessRTId{NULL_GPU_TEXTURE_ID};
 
     GPUTextureId m_lightingRTId{NULL_GPU_TEXTURE_ID};
+
+    // Render graph
+    RenderGraph m_renderGraph;
+    RenderGraphResourceId m_albedoResource{NULL_RENDER_GRAPH_RESOURCE_ID};
+    RenderGraphResourceId m_worldNormalsResource{NULL_RENDER_GRAPH_RESOURCE_ID};
+    RenderGraphResourceId m_metallicRoughnessResource{NULL_RENDER_GRAPH_RESOURCE_ID};
+    RenderGraphResourceId m_depthResource{NULL_RENDER_GRAPH_RESOURCE_ID};
+    RenderGraphResourceId m_lightingResource{NULL_RENDER_GRAPH_RESOURCE_ID};
+    RenderGraphResourceId m_swapchainResource{NULL_RENDER_GRAPH_RESOURCE_ID};
+    RenderGraphResourceId m_drawCommandsResource{NULL_RENDER_GRAPH_RESOURCE_ID};
+    RenderGraphResourceId m_drawCountsResource{NULL_RENDER_GRAPH_RESOURCE_ID};
     
     // std::vector<std::unique_ptr<StageBase>> m_pRenderStages;
     std::unique_ptr<GBufferStage> m_pGbufferStage;
     std::unique_ptr<BlinnPhongLightingStage> m_pLightingStage;
+    std::unique_ptr<TiledLightingStage> m_pTiledLightingStage; // Null if the lighting target can't be a storage image
+    std::unique_ptr<CullingStage> m_pCullingStage;
 
     float rx{1.0f};
     float ry{0.0f};
@@ -88,9 +135,13 @@ private:
 
     
     void init_lights();
+    /* Replaces the extra point lights with m_extraPointLightCount static ones scattered through the scene */
+    void spawn_extra_point_lights();
     void create_samplers();
     void init_bindless_descriptors();
     void init_assets();
+    /* Uploads each of the model's meshes once and adds a RenderMeshComponent per instance, placed by modelTransform */
+    void add_model_to_scene(const CPUModel& model, const glm::mat4& modelTransform);
     void init_material_data();
     void init_scene_data();
 
@@ -98,15 +149,25 @@ private:
 
     void init_render_textures();
     void init_render_stages();
+    /* Registers the render targets and per frame buffers the passes in drawFrame() declare accesses to */
+    void init_render_graph();
 
     void update_texture_descriptors();
     
     void init_imgui();
     
     void draw_imgui(VkImageView targetImageView);
-    void update_lights(uint32_t frameInFlightIndex);
-    void update_scene_data(uint32_t frameInFlightIndex);
+    /* Returns the device address of this frame's point light array, 0 if there are none */
+    [[nodiscard]] VkDeviceAddress update_lights();
+    /* Returns the device address of this frame's CPUSceneData */
+    [[nodiscard]] VkDeviceAddress update_scene_data(VkDeviceAddress lightBufferAddress);
     void drawFrame();
+    /* Ends the running capture and writes CPU zones plus calibrated GPU scopes to ROOT_DIR trace_frame<N>.json */
+    void write_profiler_trace();
     void mainLoop();
+    /* Draws m_options.headlessFrameCount frames without any input */
+    void run_headless();
+    /* Flies the benchmark camera path at a fixed timestep and writes CPU, fence wait and GPU frame time percentiles as JSON */
+    void run_benchmark();
     void cleanup();
 };
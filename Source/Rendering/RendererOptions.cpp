@@ -0,0 +1,75 @@
+#include "RendererOptions.h"
+#include <Common/Log.h>
+#include <cstdlib>
+#include <cstring>
+
+// Positive integer following argv[i], advances i past it
+static void parse_uint_argument(int argc, char* argv[], int& i, uint32_t& value) {
+    if (i + 1 >= argc)
+    {
+        MRWARN(argv[i] << " expects a value");
+        return;
+    }
+    char* end = nullptr;
+    const unsigned long parsed = std::strtoul(argv[i + 1], &end, 10);
+    if (end == argv[i + 1] || *end != '\0' || parsed == 0 || parsed > UINT32_MAX)
+    {
+        MRWARN(argv[i] << " expects a positive integer, got \"" << argv[i + 1] << "\"");
+        i++;
+        return;
+    }
+    value = static_cast<uint32_t>(parsed);
+    i++;
+}
+
+[[nodiscard]] RendererOptions parse_renderer_options(int argc, char* argv[]) {
+    RendererOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            options.bHeadless = true;
+        }
+        else if (std::strcmp(argv[i], "--width") == 0)
+        {
+            parse_uint_argument(argc, argv, i, options.renderExtent.width);
+        }
+        else if (std::strcmp(argv[i], "--height") == 0)
+        {
+            parse_uint_argument(argc, argv, i, options.renderExtent.height);
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0)
+        {
+            parse_uint_argument(argc, argv, i, options.headlessFrameCount);
+        }
+        else if (std::strcmp(argv[i], "--screenshot") == 0 && i + 1 < argc)
+        {
+            options.screenshotPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--benchmark") == 0)
+        {
+            options.bBenchmark = true;
+        }
+        else if (std::strcmp(argv[i], "--benchmark-output") == 0 && i + 1 < argc)
+        {
+            options.benchmarkOutputPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--compact-vertices") == 0)
+        {
+            options.vertexFormat = VertexFormat::Compact;
+        }
+        else
+        {
+            MRWARN("Ignoring unknown argument " << argv[i]);
+        }
+    }
+    if (!options.bHeadless && !options.screenshotPath.empty())
+    {
+        MRWARN("--screenshot only applies to --headless runs");
+    }
+    if (!options.bBenchmark && !options.benchmarkOutputPath.empty())
+    {
+        MRWARN("--benchmark-output only applies to --benchmark runs");
+    }
+    return options;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <Common/Config.h>
+#include <Vertex/Vertex.h>
+#include <cstdint>
+#include <string>
+
+/* Command line switches for the renderer, everything defaults to the interactive windowed app */
+struct RendererOptions {
+    bool bHeadless{false}; // No window, surface or swapchain. Renders offscreen for headlessFrameCount frames then exits
+    VkExtent2D renderExtent{WINDOW_WIDTH, WINDOW_HEIGHT};
+    uint32_t headlessFrameCount{300};
+    std::string screenshotPath; // Headless only, the last frame is written here as a PNG if set
+    bool bBenchmark{false}; // Flies the scripted camera path once instead of taking input (or headlessFrameCount), then writes frame time statistics
+    std::string benchmarkOutputPath; // ROOT_DIR benchmark.json if empty
+    VertexFormat vertexFormat{VertexFormat::Full}; // Models are packed into this when they are loaded
+};
+
+/* --headless, --width <px>, --height <px>, --frames <count>, --screenshot <path.png>, --benchmark, --benchmark-output <path.json>, --compact-vertices.
+ * Unknown or malformed arguments are warned about and ignored */
+[[nodiscard]] RendererOptions parse_renderer_options(int argc, char* argv[]);
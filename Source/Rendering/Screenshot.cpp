@@ -0,0 +1,83 @@
+#include <Common/Compiler/DisableWarnings.h>
+#include "Screenshot.h"
+#include <Rendering/GfxDevice.h>
+#include <Wrappers/Buffer.h>
+#include <Common/Log.h>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+
+PUSH_MSVC_WARNINGS
+DISABLE_MSVC_WARNING(4996) // stb_image_write uses sprintf and fopen
+PUSH_CLANG_WARNINGS
+DISABLE_CLANG_WARNING("-Wmissing-field-initializers")
+DISABLE_CLANG_WARNING("-Wshorten-64-to-32")
+// Define this only in *one* .cpp file.
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <External/tinygltf/stb_image_write.h>
+POP_CLANG_WARNINGS
+POP_MSVC_WARNINGS
+
+[[nodiscard]] bool save_screenshot(const GfxDevice& gfxDevice, VkImage image, const std::filesystem::path& path) {
+    const VkExtent2D extent = gfxDevice.get_render_extent();
+    const size_t imageSize = static_cast<size_t>(extent.width) * extent.height * 4;
+
+    AllocatedBuffer readbackBuffer;
+    create_buffer(readbackBuffer, imageSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU, gfxDevice.m_vmaAllocator);
+
+    gfxDevice.immediate_submit([&](VkCommandBuffer cmd) {
+        // Make the last frame's writes available to the copy, the layout stays TRANSFER_SRC_OPTIMAL
+        const VkImageMemoryBarrier imageBarrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange = default_image_subresource_range(VK_IMAGE_ASPECT_COLOR_BIT)
+        };
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+        const VkBufferImageCopy copyRegion = {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1
+            },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {extent.width, extent.height, 1}
+        };
+        vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer.buffer, 1, &copyRegion);
+    });
+
+    // BGRA to RGBA, alpha is forced opaque since nothing meaningful is written to it
+    std::vector<uint8_t> pixels(imageSize);
+    void* mappedData = nullptr;
+    vmaMapMemory(gfxDevice.m_vmaAllocator, readbackBuffer.allocation, &mappedData);
+    vmaInvalidateAllocation(gfxDevice.m_vmaAllocator, readbackBuffer.allocation, 0, VK_WHOLE_SIZE);
+    std::memcpy(pixels.data(), mappedData, imageSize);
+    vmaUnmapMemory(gfxDevice.m_vmaAllocator, readbackBuffer.allocation);
+    vmaDestroyBuffer(gfxDevice.m_vmaAllocator, readbackBuffer.buffer, readbackBuffer.allocation);
+    for (size_t i = 0; i < imageSize; i += 4)
+    {
+        std::swap(pixels[i], pixels[i + 2]);
+        pixels[i + 3] = 255;
+    }
+
+    const bool bWritten = stbi_write_png(path.string().c_str(), static_cast<int>(extent.width), static_cast<int>(extent.height), 4, pixels.data(), static_cast<int>(extent.width) * 4) != 0;
+    if (bWritten)
+    {
+        MRLOG("Saved screenshot to " << path.string());
+    }
+    else
+    {
+        MRWARN("Failed to write screenshot to " << path.string());
+    }
+    return bWritten;
+}
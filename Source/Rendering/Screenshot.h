@@ -0,0 +1,9 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <filesystem>
+
+class GfxDevice;
+
+/* Reads back a B8G8R8A8 image of the device's render extent and writes it as an RGBA PNG. Blocks on the GPU,
+ * image must be in TRANSFER_SRC_OPTIMAL and no longer written by any submitted work */
+[[nodiscard]] bool save_screenshot(const GfxDevice& gfxDevice, VkImage image, const std::filesystem::path& path);
@@ -0,0 +1,102 @@
+#include <Rendering/SecondaryCommandRecorder.h>
+#include <Rendering/GfxDevice.h>
+#include <Common/ThreadPool.h>
+#include <Common/Log.h>
+#include <Common/CpuProfiler.h>
+#include <vulkan/vk_enum_string_helper.h> // Doesn't work on linux?
+#include <algorithm>
+#include <cassert>
+
+void SecondaryCommandRecorder::init(const GfxDevice& gfxDevice, uint32_t maxChunkCount) {
+    assert(maxChunkCount > 0);
+    m_device = gfxDevice;
+    for (FrameCommands& frame : m_frames)
+    {
+        frame.commandPools.resize(maxChunkCount, VK_NULL_HANDLE);
+        frame.commandBuffers.resize(maxChunkCount, VK_NULL_HANDLE);
+        for (uint32_t chunkIndex = 0; chunkIndex < maxChunkCount; chunkIndex++)
+        {
+            // Transient since everything is rerecorded every frame, pools are reset as a whole so buffers don't need RESET_COMMAND_BUFFER
+            VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, nullptr,
+                VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                gfxDevice.get_graphics_queue_family_index()};
+            VkResult res = vkCreateCommandPool(m_device, &commandPoolCreateInfo, nullptr, &frame.commandPools[chunkIndex]);
+            if (res != VK_SUCCESS) {
+                MRCERR(string_VkResult(res));
+                MRCERR("Could not create secondary command pool!");
+                exit(1);
+            }
+
+            VkCommandBufferAllocateInfo cmdBufferAllocInfo = {};
+            cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            cmdBufferAllocInfo.commandPool = frame.commandPools[chunkIndex];
+            cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            cmdBufferAllocInfo.commandBufferCount = 1;
+            vkAllocateCommandBuffers(m_device, &cmdBufferAllocInfo, &frame.commandBuffers[chunkIndex]);
+        }
+    }
+}
+
+void SecondaryCommandRecorder::begin_frame(uint32_t frameInFlightIndex) {
+    m_frameIndex = frameInFlightIndex;
+    FrameCommands& frame = m_frames[m_frameIndex];
+    for (VkCommandPool commandPool : frame.commandPools)
+    {
+        vkResetCommandPool(m_device, commandPool, {});
+    }
+    frame.recordedCount = 0;
+}
+
+[[nodiscard]] std::span<const VkCommandBuffer> SecondaryCommandRecorder::record(
+    ThreadPool& threadPool,
+    const VkCommandBufferInheritanceRenderingInfoKHR& inheritanceRenderingInfo,
+    size_t itemCount,
+    const RecordFunction& recordFunction)
+{
+    FrameCommands& frame = m_frames[m_frameIndex];
+    assert(frame.recordedCount == 0 && "Only one record() per frame, the pools are only reset in begin_frame()");
+
+    const size_t maxChunkCount = frame.commandBuffers.size();
+    const size_t chunkCount = std::clamp<size_t>((itemCount + MIN_ITEMS_PER_CHUNK - 1) / MIN_ITEMS_PER_CHUNK, 1, maxChunkCount);
+    const size_t itemsPerChunk = (itemCount + chunkCount - 1) / chunkCount;
+
+    threadPool.parallel_for(chunkCount, [&](size_t chunkIndex) {
+        MR_PROFILE_ZONE("Record secondary commands");
+        VkCommandBuffer cmdBuffer = frame.commandBuffers[chunkIndex];
+
+        VkCommandBufferInheritanceInfo inheritanceInfo = {};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.pNext = &inheritanceRenderingInfo;
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+        vkBeginCommandBuffer(cmdBuffer, &beginInfo);
+
+        const size_t first = std::min(chunkIndex * itemsPerChunk, itemCount);
+        const size_t count = std::min(itemsPerChunk, itemCount - first);
+        recordFunction(cmdBuffer, first, count);
+
+        vkEndCommandBuffer(cmdBuffer);
+    });
+
+    frame.recordedCount = static_cast<uint32_t>(chunkCount);
+    return std::span<const VkCommandBuffer>(frame.commandBuffers.data(), chunkCount);
+}
+
+void SecondaryCommandRecorder::cleanup() {
+    for (FrameCommands& frame : m_frames)
+    {
+        for (VkCommandPool commandPool : frame.commandPools)
+        {
+            vkDestroyCommandPool(m_device, commandPool, nullptr);
+        }
+        frame.commandPools.clear();
+        frame.commandBuffers.clear();
+    }
+}
+
+[[nodiscard]] uint32_t SecondaryCommandRecorder::get_chunk_count() const {
+    return m_frames[m_frameIndex].recordedCount;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <Common/Config.h>
+#include <array>
+#include <vector>
+#include <span>
+#include <functional>
+
+class GfxDevice;
+class ThreadPool;
+
+/*
+ * Splits recording of a long list of draws across the ThreadPool, each chunk goes into its own secondary command buffer.
+ * Every frame in flight owns one command pool per chunk, a pool is only ever touched by the task recording that chunk,
+ * so no locking is needed and begin_frame() can reset whole pools instead of individual buffers.
+ * The secondaries continue a dynamic rendering instance, begin it on the primary with VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR.
+ */
+class SecondaryCommandRecorder
+{
+public:
+    /* Record items [first, first + count) into cmdBuffer, which is already begun */
+    using RecordFunction = std::function<void(VkCommandBuffer cmdBuffer, size_t first, size_t count)>;
+
+    SecondaryCommandRecorder() = default;
+    ~SecondaryCommandRecorder() = default;
+    SecondaryCommandRecorder(const SecondaryCommandRecorder&) = delete;
+    SecondaryCommandRecorder& operator=(const SecondaryCommandRecorder&) = delete;
+    SecondaryCommandRecorder(SecondaryCommandRecorder&&) = delete;
+    SecondaryCommandRecorder& operator=(SecondaryCommandRecorder&&) = delete;
+
+    /* maxChunkCount is usually the thread pool size plus the calling thread */
+    void init(const GfxDevice& gfxDevice, uint32_t maxChunkCount);
+    /* Only call once the frame's fence has signalled */
+    void begin_frame(uint32_t frameInFlightIndex);
+    /* Returns the recorded secondaries in item order, pass them to vkCmdExecuteCommands. Valid until the next begin_frame() for this frame index */
+    [[nodiscard]] std::span<const VkCommandBuffer> record(
+        ThreadPool& threadPool,
+        const VkCommandBufferInheritanceRenderingInfoKHR& inheritanceRenderingInfo,
+        size_t itemCount,
+        const RecordFunction& recordFunction
+        );
+    void cleanup();
+
+    [[nodiscard]] uint32_t get_chunk_count() const;
+
+private:
+    inline static constexpr size_t MIN_ITEMS_PER_CHUNK = 64; // Below this a worker costs more than it saves
+
+    struct FrameCommands {
+        std::vector<VkCommandPool> commandPools; // One per chunk
+        std::vector<VkCommandBuffer> commandBuffers; // Secondary, one per pool
+        uint32_t recordedCount{0};
+    };
+
+    VkDevice m_device{VK_NULL_HANDLE};
+    std::array<FrameCommands, MAX_FRAMES_IN_FLIGHT> m_frames;
+    uint32_t m_frameIndex{0};
+};
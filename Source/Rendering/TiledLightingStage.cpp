@@ -0,0 +1,117 @@
+#include "TiledLightingStage.h"
+#include <Rendering/GfxDevice.h>
+#include <Rendering/FrameAllocator.h>
+#include <Texture/TextureCache.h>
+#include <vector>
+
+// G buffer inputs then the lighting output, the binding is the index
+inline static constexpr std::array<VkDescriptorType, 5> tiledLightingDescriptorTypes {{
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, // Albedo
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, // World normals
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, // Metallic roughness
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, // Depth
+    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  // Lighting
+}};
+
+TiledLightingStage::TiledLightingStage(
+    const GfxDevice& _gfxDevice,
+    const TextureCache& _textureCache,
+    const VkDescriptorPool _globalDescriptorPool,
+    GPUTextureId _albedoRTId,
+    GPUTextureId _worldNormalsRTId,
+    GPUTextureId _metallicRoughnessRTId,
+    GPUTextureId _lightingRTId
+    )
+    : StageBase(_gfxDevice)
+    , m_extent(_gfxDevice.get_render_extent())
+    , m_textureCache(_textureCache)
+    , m_globalDescriptorPool(_globalDescriptorPool)
+    , m_pipeline(m_gfxDevice)
+    {
+        {
+            // Build a descriptor set layout
+            std::vector<VkDescriptorSetLayoutBinding> tiledLightingDescriptorSetLayoutBindings;
+            for (uint32_t bindingIndex = 0; bindingIndex < tiledLightingDescriptorTypes.size(); bindingIndex++)
+            {
+                VkDescriptorSetLayoutBinding newBinding = {
+                    .binding = bindingIndex,
+                    .descriptorType = tiledLightingDescriptorTypes[bindingIndex],
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                    .pImmutableSamplers = nullptr
+                };
+                tiledLightingDescriptorSetLayoutBindings.push_back(newBinding);
+            }
+            VkDescriptorSetLayoutCreateInfo tiledLightingSetLayoutCreateInfo {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                .bindingCount = static_cast<uint32_t>(tiledLightingDescriptorSetLayoutBindings.size()),
+                .pBindings = tiledLightingDescriptorSetLayoutBindings.data()
+            };
+            vkCreateDescriptorSetLayout(m_gfxDevice, &tiledLightingSetLayoutCreateInfo, nullptr, &m_tiledLightingDescriptorSetLayout);
+
+            // Allocate the descriptor set
+            VkDescriptorSetAllocateInfo allocateInfo = {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool = m_globalDescriptorPool,
+                .descriptorSetCount = 1,
+                .pSetLayouts = &m_tiledLightingDescriptorSetLayout
+            };
+
+            vkAllocateDescriptorSets(m_gfxDevice, &allocateInfo, &m_tiledLightingDescriptorSet);
+        }
+
+        // Kept alive until vkUpdateDescriptorSets because of pImageInfo
+        const std::array<VkDescriptorImageInfo, tiledLightingDescriptorTypes.size()> imageInfos {{
+            { .imageView = m_textureCache.get_render_texture_texture(_albedoRTId).allocatedImage.imageView, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+            { .imageView = m_textureCache.get_render_texture_texture(_worldNormalsRTId).allocatedImage.imageView, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+            { .imageView = m_textureCache.get_render_texture_texture(_metallicRoughnessRTId).allocatedImage.imageView, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+            { .imageView = m_gfxDevice.m_depthImage.imageView, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+            { .imageView = m_textureCache.get_render_texture_texture(_lightingRTId).allocatedImage.imageView, .imageLayout = VK_IMAGE_LAYOUT_GENERAL }
+        }};
+        std::vector<VkWriteDescriptorSet> tiledLightingDescriptorWrites;
+        for (uint32_t bindingIndex = 0; bindingIndex < imageInfos.size(); bindingIndex++)
+        {
+            VkWriteDescriptorSet writeDescriptor = {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = m_tiledLightingDescriptorSet,
+                .dstBinding = bindingIndex,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = tiledLightingDescriptorTypes[bindingIndex],
+                .pImageInfo = &imageInfos[bindingIndex]
+            };
+            tiledLightingDescriptorWrites.push_back(writeDescriptor);
+        }
+        vkUpdateDescriptorSets(m_gfxDevice, static_cast<uint32_t>(tiledLightingDescriptorWrites.size()), tiledLightingDescriptorWrites.data(), 0, nullptr);
+
+        std::array<VkDescriptorSetLayout, 1> descriptorSetLayouts = {{m_tiledLightingDescriptorSetLayout}};
+        m_pipeline.BuildPipeline(m_computeShaderPath, m_pushConstantRanges, descriptorSetLayouts);
+    }
+
+TiledLightingStage::~TiledLightingStage() {}
+
+void TiledLightingStage::Dispatch(VkCommandBuffer cmdBuffer, FrameAllocator& frameAllocator, VkDeviceAddress sceneDataBufferAddress, const glm::mat4& view, const glm::mat4& projection, bool bShowLightCounts) {
+    TiledLightingData tiledLightingData;
+    tiledLightingData.inverseProjection = glm::inverse(projection);
+    tiledLightingData.inverseView = glm::inverse(view);
+    tiledLightingData.screenWidth = m_extent.width;
+    tiledLightingData.screenHeight = m_extent.height;
+    tiledLightingData.bShowLightCounts = bShowLightCounts ? 1 : 0;
+
+    TiledLightingPushConstants pushConstants;
+    pushConstants.sceneDataBufferAddress = sceneDataBufferAddress;
+    pushConstants.tiledLightingDataAddress = frameAllocator.push(tiledLightingData).gpuAddress;
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline.get_pipeline_handle());
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+      m_pipeline.get_pipeline_layout(),
+      0, 1, &m_tiledLightingDescriptorSet, 0, nullptr);
+    vkCmdPushConstants(cmdBuffer, m_pipeline.get_pipeline_layout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(cmdBuffer, (m_extent.width + TILE_SIZE - 1) / TILE_SIZE, (m_extent.height + TILE_SIZE - 1) / TILE_SIZE, 1);
+}
+
+void TiledLightingStage::Cleanup() {
+    vkDestroyDescriptorSetLayout(m_gfxDevice, m_tiledLightingDescriptorSetLayout, nullptr);
+    vkDestroyPipelineLayout(m_gfxDevice, m_pipeline.get_pipeline_layout(), nullptr);
+    vkDestroyPipeline(m_gfxDevice, m_pipeline.get_pipeline_handle(), nullptr);
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <Pipeline/ComputePipeline.h>
+#include <Rendering/StageBase.h>
+#include <Common/IdTypes.h>
+#include <Common/Config.h>
+#include <glm/glm.hpp>
+#include <array>
+
+class GfxDevice;
+class TextureCache;
+class FrameAllocator;
+
+/* Per frame tiled lighting parameters, matches TiledLightingDataBuffer in tiled_lighting.comp (scalar layout) */
+struct TiledLightingData {
+    glm::mat4 inverseProjection;
+    glm::mat4 inverseView;
+    uint32_t screenWidth;
+    uint32_t screenHeight;
+    uint32_t bShowLightCounts;
+};
+
+struct TiledLightingPushConstants {
+    VkDeviceAddress sceneDataBufferAddress;
+    VkDeviceAddress tiledLightingDataAddress;
+
+    static constexpr VkPushConstantRange range() {
+        VkPushConstantRange tiledLightingPushConstantRange = {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset = 0,
+            .size = sizeof(TiledLightingPushConstants)
+        };
+        return tiledLightingPushConstantRange;
+    }
+};
+
+/*
+ * Deferred lighting in a compute shader, the alternative to BlinnPhongLightingStage for scenes with many point lights.
+ * Each 16x16 tile takes the depth bounds of its pixels, culls every point light against that sub-frustum into shared memory,
+ * then shades its pixels with only the lights that touch it. Reads the same G buffer targets, writes the lighting target as a storage image.
+ */
+class TiledLightingStage final : public StageBase {
+
+    inline static constexpr std::array<VkPushConstantRange, 1> m_pushConstantRanges = {TiledLightingPushConstants::range()};
+    inline static constexpr uint32_t TILE_SIZE = 16; // local_size_x and local_size_y in tiled_lighting.comp
+
+public:
+    /* Lights a tile can hold in tiled_lighting.comp's shared memory, any more touching the tile are dropped (magenta in the light count view) */
+    inline static constexpr uint32_t MAX_LIGHTS_PER_TILE = 1024;
+
+    TiledLightingStage(
+        const GfxDevice& _gfxDevice,
+        const TextureCache& _textureCache,
+        const VkDescriptorPool _globalDescriptorPool,
+        GPUTextureId _albedoRTId,
+        GPUTextureId _worldNormalsRTId,
+        GPUTextureId _metallicRoughnessRTId,
+        GPUTextureId _lightingRTId
+    );
+    ~TiledLightingStage();
+    TiledLightingStage(const TiledLightingStage&) = delete;
+    TiledLightingStage& operator=(const TiledLightingStage&) = delete;
+
+    /* The G buffer targets must be in SHADER_READ_ONLY_OPTIMAL and the lighting target in GENERAL */
+    void Dispatch(VkCommandBuffer cmdBuffer, FrameAllocator& frameAllocator, VkDeviceAddress sceneDataBufferAddress, const glm::mat4& view, const glm::mat4& projection, bool bShowLightCounts);
+    void Cleanup() override;
+
+private:
+    const std::string m_computeShaderPath = std::string("Shaders/tiled_lighting.comp.spv");
+    const VkExtent2D m_extent;
+
+    const TextureCache& m_textureCache;
+    const VkDescriptorPool m_globalDescriptorPool;
+    VkDescriptorSetLayout m_tiledLightingDescriptorSetLayout;
+    VkDescriptorSet m_tiledLightingDescriptorSet;
+public:
+    ComputePipeline m_pipeline;
+};
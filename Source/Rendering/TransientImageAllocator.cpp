@@ -0,0 +1,139 @@
+#include <Rendering/TransientImageAllocator.h>
+#include <Rendering/GfxDevice.h>
+#include <Common/Log.h>
+#include <vulkan/vk_enum_string_helper.h> // Doesn't work on linux?
+#include <algorithm>
+#include <cassert>
+
+[[nodiscard]] uint32_t TransientImageAllocator::add_image(const std::string& name, const VkImageCreateInfo& imageCreateInfo) {
+    assert(m_heapAllocation == VK_NULL_HANDLE && "Images can only be added before allocate()");
+    TransientImage& image = m_images.emplace_back();
+    image.name = name;
+    image.createInfo = imageCreateInfo;
+    image.allocatedImage.imageExtent = imageCreateInfo.extent;
+    image.allocatedImage.imageFormat = imageCreateInfo.format;
+    image.allocatedImage.mipLevels = imageCreateInfo.mipLevels;
+    return static_cast<uint32_t>(m_images.size() - 1);
+}
+
+[[nodiscard]] bool TransientImageAllocator::is_attachment_only(VkImageUsageFlags usage) {
+    constexpr VkImageUsageFlags attachmentUsages = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+    return (usage & ~attachmentUsages) == 0;
+}
+
+void TransientImageAllocator::allocate(const GfxDevice& gfxDevice) {
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(gfxDevice.get_physical_device(), &memoryProperties);
+    bool bLazyMemory = false;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        bLazyMemory = bLazyMemory || (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+    }
+
+    std::vector<TransientImage*> heapImages;
+    for (TransientImage& image : m_images)
+    {
+        image.bLazilyAllocated = bLazyMemory && is_attachment_only(image.createInfo.usage);
+        if (image.bLazilyAllocated)
+        {
+            image.createInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+            VmaAllocationCreateInfo vmaAllocInfo = {};
+            vmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+            VkResult res = vmaCreateImage(gfxDevice.m_vmaAllocator, &image.createInfo, &vmaAllocInfo, &image.allocatedImage.image, &image.allocatedImage.allocation, nullptr);
+            if (res != VK_SUCCESS) {
+                MRCERR(string_VkResult(res));
+                MRCERR("Could not create lazily allocated image " << image.name << "!");
+                exit(1);
+            }
+            vkGetImageMemoryRequirements(gfxDevice, image.allocatedImage.image, &image.memoryRequirements);
+            m_lazilyAllocatedSize += image.memoryRequirements.size;
+            m_lazilyAllocatedCount++;
+            continue;
+        }
+
+        VkResult res = vkCreateImage(gfxDevice, &image.createInfo, nullptr, &image.allocatedImage.image);
+        if (res != VK_SUCCESS) {
+            MRCERR(string_VkResult(res));
+            MRCERR("Could not create transient image " << image.name << "!");
+            exit(1);
+        }
+        image.allocatedImage.allocation = VK_NULL_HANDLE; // The heap allocation is shared, only freed here
+        vkGetImageMemoryRequirements(gfxDevice, image.allocatedImage.image, &image.memoryRequirements);
+        heapImages.push_back(&image);
+    }
+
+    if (heapImages.empty())
+    {
+        MRLOG("Transient images: no heap, " << m_lazilyAllocatedCount << " lazily allocated (" << m_lazilyAllocatedSize / (1024 * 1024) << " MB)");
+        return;
+    }
+
+    // Biggest first wastes the least on alignment, every image has to be happy with the one memory type the heap ends up in
+    std::sort(heapImages.begin(), heapImages.end(), [](const TransientImage* a, const TransientImage* b) {
+        return a->memoryRequirements.size > b->memoryRequirements.size;
+    });
+    VkMemoryRequirements heapRequirements = {.size = 0, .alignment = 1, .memoryTypeBits = ~0u};
+    for (TransientImage* image : heapImages)
+    {
+        const VkDeviceSize alignment = image->memoryRequirements.alignment;
+        image->heapOffset = (heapRequirements.size + alignment - 1) / alignment * alignment;
+        heapRequirements.size = image->heapOffset + image->memoryRequirements.size;
+        heapRequirements.alignment = std::max(heapRequirements.alignment, image->memoryRequirements.alignment);
+        heapRequirements.memoryTypeBits &= image->memoryRequirements.memoryTypeBits;
+    }
+    if (heapRequirements.memoryTypeBits == 0)
+    {
+        MRCERR("Transient images have no memory type in common, they can't share a heap!");
+        exit(1);
+    }
+
+    VmaAllocationCreateInfo vmaAllocInfo = {};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    vmaAllocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    VkResult res = vmaAllocateMemory(gfxDevice.m_vmaAllocator, &heapRequirements, &vmaAllocInfo, &m_heapAllocation, nullptr);
+    if (res != VK_SUCCESS) {
+        MRCERR(string_VkResult(res));
+        MRCERR("Could not allocate transient image heap!");
+        exit(1);
+    }
+    m_heapSize = heapRequirements.size;
+
+    for (TransientImage* image : heapImages)
+    {
+        res = vmaBindImageMemory2(gfxDevice.m_vmaAllocator, m_heapAllocation, image->heapOffset, image->allocatedImage.image, nullptr);
+        if (res != VK_SUCCESS) {
+            MRCERR(string_VkResult(res));
+            MRCERR("Could not bind transient image " << image->name << "!");
+            exit(1);
+        }
+    }
+    MRLOG("Transient images: " << m_heapSize / (1024 * 1024) << " MB heap, " << m_lazilyAllocatedCount << " lazily allocated (" << m_lazilyAllocatedSize / (1024 * 1024) << " MB)");
+}
+
+[[nodiscard]] const AllocatedImage& TransientImageAllocator::get_image(uint32_t index) const {
+    return m_images[index].allocatedImage;
+}
+
+[[nodiscard]] uint32_t TransientImageAllocator::get_image_count() const {
+    return static_cast<uint32_t>(m_images.size());
+}
+
+void TransientImageAllocator::cleanup(const GfxDevice& gfxDevice) {
+    if (m_heapAllocation != VK_NULL_HANDLE)
+    {
+        vmaFreeMemory(gfxDevice.m_vmaAllocator, m_heapAllocation);
+        m_heapAllocation = VK_NULL_HANDLE;
+    }
+}
+
+[[nodiscard]] VkDeviceSize TransientImageAllocator::get_lazily_allocated_size() const {
+    return m_lazilyAllocatedSize;
+}
+
+[[nodiscard]] VkDeviceSize TransientImageAllocator::get_heap_size() const {
+    return m_heapSize;
+}
+
+[[nodiscard]] uint32_t TransientImageAllocator::get_lazily_allocated_count() const {
+    return m_lazilyAllocatedCount;
+}
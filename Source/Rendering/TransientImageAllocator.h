@@ -0,0 +1,58 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <Wrappers/Image.h>
+#include <IncludeHelpers/VmaIncludes.h>
+#include <vector>
+#include <string>
+
+class GfxDevice;
+
+/*
+ * Places the frame's render targets back to back in one shared allocation.
+ * Attachment only images (never sampled, stored or copied) get TRANSIENT_ATTACHMENT and lazily allocated memory instead
+ * when the device has it, so tilers never back them with real memory.
+ * Images don't alias each other, the render graph has no way to order a handover between two images sharing memory.
+ * Ownership of the images goes to whoever registers them (e.g. TextureCache), images in the shared heap have a null allocation.
+ */
+class TransientImageAllocator
+{
+public:
+    TransientImageAllocator() = default;
+    ~TransientImageAllocator() = default;
+    TransientImageAllocator(const TransientImageAllocator&) = delete;
+    TransientImageAllocator& operator=(const TransientImageAllocator&) = delete;
+    TransientImageAllocator(TransientImageAllocator&&) = delete;
+    TransientImageAllocator& operator=(TransientImageAllocator&&) = delete;
+
+    /* Returns the index to pass to get_image() */
+    [[nodiscard]] uint32_t add_image(const std::string& name, const VkImageCreateInfo& imageCreateInfo);
+    /* Creates every image added so far and binds its memory */
+    void allocate(const GfxDevice& gfxDevice);
+    [[nodiscard]] const AllocatedImage& get_image(uint32_t index) const;
+    [[nodiscard]] uint32_t get_image_count() const;
+    void cleanup(const GfxDevice& gfxDevice);
+
+    /* Size of the shared allocation the images that aren't lazily allocated live in */
+    [[nodiscard]] VkDeviceSize get_heap_size() const;
+    /* What the lazily allocated images would take if they were backed up front, tilers may never commit it */
+    [[nodiscard]] VkDeviceSize get_lazily_allocated_size() const;
+    [[nodiscard]] uint32_t get_lazily_allocated_count() const;
+
+private:
+    struct TransientImage {
+        std::string name;
+        VkImageCreateInfo createInfo;
+        AllocatedImage allocatedImage{};
+        VkMemoryRequirements memoryRequirements{};
+        VkDeviceSize heapOffset{0};
+        bool bLazilyAllocated{false};
+    };
+
+    [[nodiscard]] static bool is_attachment_only(VkImageUsageFlags usage);
+
+    std::vector<TransientImage> m_images;
+    VmaAllocation m_heapAllocation{VK_NULL_HANDLE};
+    VkDeviceSize m_lazilyAllocatedSize{0};
+    VkDeviceSize m_heapSize{0};
+    uint32_t m_lazilyAllocatedCount{0};
+};
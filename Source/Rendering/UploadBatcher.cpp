@@ -0,0 +1,279 @@
+#include <Rendering/UploadBatcher.h>
+#include <Common/Log.h>
+#include <Common/CpuProfiler.h>
+#include <vulkan/vk_enum_string_helper.h> // Doesn't work on linux?
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+// Covers the offset requirements of every copy we record (buffer copies and 4 byte / 16 byte block texel formats)
+static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static void create_staging_buffer(AllocatedBuffer& stagingBuffer, void*& mappedData, VkDeviceSize size, VmaAllocator allocator) {
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = size;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+    // Persistently mapped so we never have to map/unmap per upload
+    VmaAllocationCreateInfo vmaAllocInfo = {};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+    vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo = {};
+    VkResult res = vmaCreateBuffer(allocator, &bufferCreateInfo, &vmaAllocInfo, &stagingBuffer.buffer, &stagingBuffer.allocation, &allocationInfo);
+    if (res != VK_SUCCESS) {
+        MRCERR(string_VkResult(res));
+        MRCERR("Could not allocate staging buffer!");
+        exit(1);
+    }
+    mappedData = allocationInfo.pMappedData;
+}
+
+static void transition_mip_level(VkCommandBuffer cmd, VkImage image, uint32_t mipLevel, VkImageLayout currentLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask) {
+    VkImageMemoryBarrier imageBarrier {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = srcAccessMask,
+        .dstAccessMask = dstAccessMask,
+        .oldLayout = currentLayout,
+        .newLayout = newLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 1, 0, 1 }
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, {}, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+}
+
+void UploadBatcher::init(VkDevice device, VkQueue queue, uint32_t queueFamilyIndex, VmaAllocator allocator, VkDeviceSize stagingCapacity) {
+    m_device = device;
+    m_queue = queue;
+    m_allocator = allocator;
+    m_stagingCapacity = stagingCapacity;
+
+    VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, nullptr, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, queueFamilyIndex };
+    vkCreateCommandPool(m_device, &commandPoolCreateInfo, nullptr, &m_commandPool);
+
+    VkCommandBufferAllocateInfo cmdBufferAllocInfo = {};
+    cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufferAllocInfo.commandPool = m_commandPool;
+    cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufferAllocInfo.commandBufferCount = 1;
+    vkAllocateCommandBuffers(m_device, &cmdBufferAllocInfo, &m_commandBuffer);
+
+    VkFenceCreateInfo fenceCreateInfo = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, {}};
+    vkCreateFence(m_device, &fenceCreateInfo, nullptr, &m_fence);
+
+    create_staging_buffer(m_stagingBuffer, m_pStagingData, m_stagingCapacity, m_allocator);
+}
+
+void UploadBatcher::upload_buffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    assert(size > 0);
+
+    VkBuffer stagingBuffer;
+    const VkDeviceSize stagingOffset = stage(data, size, stagingBuffer);
+
+    VkBufferCopy copyRegion = {
+        .srcOffset = stagingOffset,
+        .dstOffset = dstOffset,
+        .size = size
+    };
+    vkCmdCopyBuffer(m_commandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+    m_pendingCopyCount++;
+}
+
+void UploadBatcher::upload_image(const AllocatedImage& dstImage, const void* data, VkDeviceSize size) {
+    assert(size > 0);
+
+    VkBuffer stagingBuffer;
+    const VkDeviceSize stagingOffset = stage(data, size, stagingBuffer);
+
+    transition_image(m_commandBuffer, dstImage.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    VkBufferImageCopy copyRegion = {};
+    copyRegion.bufferOffset = stagingOffset;
+    copyRegion.bufferRowLength = 0;
+    copyRegion.bufferImageHeight = 0;
+
+    copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copyRegion.imageSubresource.mipLevel = 0;
+    copyRegion.imageSubresource.baseArrayLayer = 0;
+    copyRegion.imageSubresource.layerCount = 1;
+    copyRegion.imageExtent = dstImage.imageExtent;
+    vkCmdCopyBufferToImage(m_commandBuffer, stagingBuffer, dstImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+    if (dstImage.mipLevels > 1)
+    {
+        record_blit_mip_chain(dstImage);
+    }
+    else
+    {
+        transition_image(m_commandBuffer, dstImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    m_pendingCopyCount++;
+}
+
+void UploadBatcher::upload_image_levels(const AllocatedImage& dstImage, std::span<const ImageLevelData> levels) {
+    assert(!levels.empty() && levels.size() <= dstImage.mipLevels);
+
+    // Each level is copied right after it is staged. If staging has to flush part way through, the copies recorded so far are
+    // submitted with the image still in TRANSFER_DST, and the rest continue in the next command buffer on the same queue
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        VkBuffer stagingBuffer;
+        const VkDeviceSize stagingOffset = stage(levels[i].data, levels[i].size, stagingBuffer);
+        if (i == 0)
+        {
+            transition_image(m_commandBuffer, dstImage.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        }
+
+        VkBufferImageCopy copyRegion = {};
+        copyRegion.bufferOffset = stagingOffset;
+        copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegion.imageSubresource.mipLevel = static_cast<uint32_t>(i);
+        copyRegion.imageSubresource.baseArrayLayer = 0;
+        copyRegion.imageSubresource.layerCount = 1;
+        copyRegion.imageExtent = levels[i].extent;
+        vkCmdCopyBufferToImage(m_commandBuffer, stagingBuffer, dstImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+    }
+    transition_image(m_commandBuffer, dstImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    m_pendingCopyCount++;
+}
+
+void UploadBatcher::flush() {
+    if (!m_bRecording)
+    {
+        return;
+    }
+    MR_PROFILE_ZONE("Flush uploads");
+
+    // Make the transfer writes visible to whatever reads these resources next (vertex input, index fetch, shaders)
+    VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT
+    };
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    vkEndCommandBuffer(m_commandBuffer);
+
+    VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &m_commandBuffer
+    };
+    VkResult res = vkQueueSubmit(m_queue, 1, &submitInfo, m_fence);
+    if (res != VK_SUCCESS) {
+        MRCERR(string_VkResult(res));
+        MRCERR("Failed to submit upload batch!");
+        exit(1);
+    }
+    vkWaitForFences(m_device, 1, &m_fence, true, (std::numeric_limits<uint64_t>::max)());
+    vkResetFences(m_device, 1, &m_fence);
+
+    for (AllocatedBuffer& buffer : m_oversizedStagingBuffers)
+    {
+        buffer.cleanup(m_allocator);
+    }
+    m_oversizedStagingBuffers.clear();
+
+    MRLOG("Flushed upload batch: " << m_pendingCopyCount << " copies, " << m_stagingHead << " bytes staged");
+    m_stagingHead = 0;
+    m_pendingCopyCount = 0;
+    m_bRecording = false;
+    m_flushCount++;
+}
+
+void UploadBatcher::cleanup() {
+    flush();
+    m_stagingBuffer.cleanup(m_allocator);
+    vkDestroyFence(m_device, m_fence, nullptr);
+    vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+}
+
+[[nodiscard]] uint32_t UploadBatcher::get_flush_count() const {
+    return m_flushCount;
+}
+
+[[nodiscard]] VkDeviceSize UploadBatcher::stage(const void* data, VkDeviceSize size, VkBuffer& stagingBuffer) {
+    if (size > m_stagingCapacity)
+    {
+        begin_recording();
+        AllocatedBuffer& oversizedBuffer = m_oversizedStagingBuffers.emplace_back();
+        void* mappedData;
+        create_staging_buffer(oversizedBuffer, mappedData, size, m_allocator);
+        memcpy(mappedData, data, size);
+        stagingBuffer = oversizedBuffer.buffer;
+        return 0;
+    }
+
+    VkDeviceSize offset = align_up(m_stagingHead, STAGING_ALIGNMENT);
+    if (offset + size > m_stagingCapacity)
+    {
+        // Out of room, submit what we have so the staging buffer can be reused from the start
+        flush();
+        offset = 0;
+    }
+    begin_recording();
+
+    memcpy(static_cast<char*>(m_pStagingData) + offset, data, size);
+    m_stagingHead = offset + size;
+    stagingBuffer = m_stagingBuffer.buffer;
+    return offset;
+}
+
+void UploadBatcher::record_blit_mip_chain(const AllocatedImage& dstImage) {
+    // Every level is in TRANSFER_DST here, mip 0 holds the uploaded data
+    int32_t mipWidth = static_cast<int32_t>(dstImage.imageExtent.width);
+    int32_t mipHeight = static_cast<int32_t>(dstImage.imageExtent.height);
+    for (uint32_t level = 1; level < dstImage.mipLevels; level++)
+    {
+        transition_mip_level(m_commandBuffer, dstImage.image, level - 1,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+        const int32_t nextWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+        const int32_t nextHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+        VkImageBlit blitRegion = {};
+        blitRegion.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 };
+        blitRegion.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+        blitRegion.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+        blitRegion.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+        vkCmdBlitImage(m_commandBuffer,
+            dstImage.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            dstImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &blitRegion, VK_FILTER_LINEAR);
+
+        // The source level is final now
+        transition_mip_level(m_commandBuffer, dstImage.image, level - 1,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+        mipWidth = nextWidth;
+        mipHeight = nextHeight;
+    }
+    transition_mip_level(m_commandBuffer, dstImage.image, dstImage.mipLevels - 1,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+}
+
+void UploadBatcher::begin_recording() {
+    if (m_bRecording)
+    {
+        return;
+    }
+    vkResetCommandPool(m_device, m_commandPool, {});
+
+    VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr
+    };
+    vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
+    m_bRecording = true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <Wrappers/Buffer.h>
+#include <Wrappers/Image.h>
+#include <IncludeHelpers/VmaIncludes.h>
+#include <vector>
+#include <span>
+
+/* Tightly packed texel data for one mip level */
+struct ImageLevelData {
+    const void* data;
+    VkDeviceSize size;
+    VkExtent3D extent;
+};
+
+/*
+ * Collects buffer and image uploads into a single command buffer backed by one reusable, persistently mapped staging buffer.
+ * Nothing reaches the GPU until flush() (or the staging buffer fills up), which submits everything recorded so far and waits once.
+ */
+class UploadBatcher
+{
+public:
+    UploadBatcher() = default;
+    ~UploadBatcher() = default;
+    UploadBatcher(const UploadBatcher&) = delete;
+    UploadBatcher& operator=(const UploadBatcher&) = delete;
+    UploadBatcher(UploadBatcher&&) = delete;
+    UploadBatcher& operator=(UploadBatcher&&) = delete;
+
+    void init(VkDevice device, VkQueue queue, uint32_t queueFamilyIndex, VmaAllocator allocator, VkDeviceSize stagingCapacity);
+    /* Copy size bytes of data into dstBuffer at dstOffset, dstBuffer must have been created with TRANSFER_DST usage */
+    void upload_buffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+    /* Copy tightly packed texel data into mip 0 of the image, leaving it in SHADER_READ_ONLY_OPTIMAL.
+     * Any further mip levels are filled by blitting down from mip 0, so the format must support linear filtered blits */
+    void upload_image(const AllocatedImage& dstImage, const void* data, VkDeviceSize size);
+    /* Copy every level given (level i of the span goes to mip i), for mip chains built on the CPU or loaded from disk */
+    void upload_image_levels(const AllocatedImage& dstImage, std::span<const ImageLevelData> levels);
+    /* Submit all recorded copies and block until they are complete */
+    void flush();
+    void cleanup();
+
+    [[nodiscard]] uint32_t get_flush_count() const;
+
+private:
+    /* Returns the offset into the staging buffer that size bytes were written to, may flush first if there is not enough room */
+    [[nodiscard]] VkDeviceSize stage(const void* data, VkDeviceSize size, VkBuffer& stagingBuffer);
+    void begin_recording();
+    void record_blit_mip_chain(const AllocatedImage& dstImage);
+
+    VkDevice m_device{VK_NULL_HANDLE};
+    VkQueue m_queue{VK_NULL_HANDLE};
+    VmaAllocator m_allocator{VK_NULL_HANDLE};
+
+    VkCommandPool m_commandPool{VK_NULL_HANDLE};
+    VkCommandBuffer m_commandBuffer{VK_NULL_HANDLE};
+    VkFence m_fence{VK_NULL_HANDLE};
+    bool m_bRecording = false;
+
+    AllocatedBuffer m_stagingBuffer{};
+    void* m_pStagingData{nullptr};
+    VkDeviceSize m_stagingCapacity{0};
+    VkDeviceSize m_stagingHead{0};
+    std::vector<AllocatedBuffer> m_oversizedStagingBuffers; // Uploads larger than the whole staging buffer get their own, freed on flush
+
+    uint32_t m_pendingCopyCount{0};
+    uint32_t m_flushCount{0};
+};
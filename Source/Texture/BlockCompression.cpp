@@ -0,0 +1,395 @@
+#include "BlockCompression.h"
+#include <Common/Log.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+using Block = std::array<std::array<float, 4>, 16>; // 16 RGBA texels in [0, 255]
+
+/* Principal axis of the texels over the first channelCount channels, found with a few rounds of power iteration */
+static std::array<float, 4> principal_axis(const Block& texels, uint32_t channelCount, const std::array<float, 4>& mean)
+{
+    float covariance[4][4] = {};
+    for (const auto& texel : texels)
+    {
+        for (uint32_t i = 0; i < channelCount; i++)
+        {
+            for (uint32_t j = 0; j < channelCount; j++)
+            {
+                covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+            }
+        }
+    }
+
+    std::array<float, 4> axis{1.0f, 1.0f, 1.0f, channelCount > 3 ? 1.0f : 0.0f};
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        std::array<float, 4> next{};
+        for (uint32_t i = 0; i < channelCount; i++)
+        {
+            for (uint32_t j = 0; j < channelCount; j++)
+            {
+                next[i] += covariance[i][j] * axis[j];
+            }
+        }
+        float length = 0.0f;
+        for (uint32_t i = 0; i < channelCount; i++)
+        {
+            length = std::max(length, std::abs(next[i]));
+        }
+        if (length < 1e-6f)
+        {
+            break; // Flat block, any axis works
+        }
+        for (uint32_t i = 0; i < channelCount; i++)
+        {
+            axis[i] = next[i] / length;
+        }
+    }
+    return axis;
+}
+
+/* Endpoints at the extremes of the texels projected onto their principal axis */
+static void find_endpoints(const Block& texels, uint32_t channelCount, std::array<float, 4>& endpoint0, std::array<float, 4>& endpoint1)
+{
+    std::array<float, 4> mean{};
+    for (const auto& texel : texels)
+    {
+        for (uint32_t i = 0; i < channelCount; i++)
+        {
+            mean[i] += texel[i] / 16.0f;
+        }
+    }
+    const std::array<float, 4> axis = principal_axis(texels, channelCount, mean);
+
+    float minProjection = 0.0f;
+    float maxProjection = 0.0f;
+    for (const auto& texel : texels)
+    {
+        float projection = 0.0f;
+        for (uint32_t i = 0; i < channelCount; i++)
+        {
+            projection += (texel[i] - mean[i]) * axis[i];
+        }
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    float axisLengthSquared = 0.0f;
+    for (uint32_t i = 0; i < channelCount; i++)
+    {
+        axisLengthSquared += axis[i] * axis[i];
+    }
+    axisLengthSquared = std::max(axisLengthSquared, 1e-6f);
+    for (uint32_t i = 0; i < channelCount; i++)
+    {
+        endpoint0[i] = std::clamp(mean[i] + axis[i] * minProjection / axisLengthSquared, 0.0f, 255.0f);
+        endpoint1[i] = std::clamp(mean[i] + axis[i] * maxProjection / axisLengthSquared, 0.0f, 255.0f);
+    }
+}
+
+/* Appends bits LSB first into a 128 bit block */
+class BitWriter
+{
+public:
+    explicit BitWriter(unsigned char* _out) : m_out(_out) { std::memset(m_out, 0, 16); }
+    void write(uint32_t value, uint32_t bitCount)
+    {
+        for (uint32_t i = 0; i < bitCount; i++, m_bitPosition++)
+        {
+            if ((value >> i) & 1u)
+            {
+                m_out[m_bitPosition / 8] |= static_cast<unsigned char>(1u << (m_bitPosition % 8));
+            }
+        }
+    }
+private:
+    unsigned char* m_out;
+    uint32_t m_bitPosition{0};
+};
+
+static uint16_t pack_565(const std::array<float, 4>& color)
+{
+    const uint32_t r = static_cast<uint32_t>(std::lround(color[0] * 31.0f / 255.0f));
+    const uint32_t g = static_cast<uint32_t>(std::lround(color[1] * 63.0f / 255.0f));
+    const uint32_t b = static_cast<uint32_t>(std::lround(color[2] * 31.0f / 255.0f));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static std::array<float, 4> unpack_565(uint16_t color)
+{
+    const uint32_t r = (color >> 11) & 31u;
+    const uint32_t g = (color >> 5) & 63u;
+    const uint32_t b = color & 31u;
+    return {static_cast<float>((r << 3) | (r >> 2)), static_cast<float>((g << 2) | (g >> 4)), static_cast<float>((b << 3) | (b >> 2)), 255.0f};
+}
+
+static void compress_bc1_block(const Block& texels, unsigned char* out)
+{
+    std::array<float, 4> endpoint0{};
+    std::array<float, 4> endpoint1{};
+    find_endpoints(texels, 3, endpoint0, endpoint1);
+
+    uint16_t color0 = pack_565(endpoint1);
+    uint16_t color1 = pack_565(endpoint0);
+    if (color0 < color1)
+    {
+        std::swap(color0, color1); // color0 > color1 selects the opaque four color mode
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        const std::array<float, 4> c0 = unpack_565(color0);
+        const std::array<float, 4> c1 = unpack_565(color1);
+        std::array<std::array<float, 4>, 4> palette{c0, c1, {}, {}};
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            palette[2][i] = (2.0f * c0[i] + c1[i]) / 3.0f;
+            palette[3][i] = (c0[i] + 2.0f * c1[i]) / 3.0f;
+        }
+        for (uint32_t texelIndex = 0; texelIndex < 16; texelIndex++)
+        {
+            uint32_t bestIndex = 0;
+            float bestError = INFINITY;
+            for (uint32_t paletteIndex = 0; paletteIndex < 4; paletteIndex++)
+            {
+                float error = 0.0f;
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    const float difference = texels[texelIndex][i] - palette[paletteIndex][i];
+                    error += difference * difference;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = paletteIndex;
+                }
+            }
+            indices |= bestIndex << (texelIndex * 2);
+        }
+    }
+
+    out[0] = static_cast<unsigned char>(color0 & 0xFF);
+    out[1] = static_cast<unsigned char>(color0 >> 8);
+    out[2] = static_cast<unsigned char>(color1 & 0xFF);
+    out[3] = static_cast<unsigned char>(color1 >> 8);
+    std::memcpy(out + 4, &indices, sizeof(indices)); // Little endian, like every platform we build for
+}
+
+/* Single channel block, shared by BC3 alpha, BC4 and both halves of BC5 */
+static void compress_bc4_block(const Block& texels, uint32_t channel, unsigned char* out)
+{
+    float minValue = 255.0f;
+    float maxValue = 0.0f;
+    for (const auto& texel : texels)
+    {
+        minValue = std::min(minValue, texel[channel]);
+        maxValue = std::max(maxValue, texel[channel]);
+    }
+    const uint32_t value0 = static_cast<uint32_t>(std::lround(maxValue));
+    const uint32_t value1 = static_cast<uint32_t>(std::lround(minValue));
+
+    uint64_t indices = 0;
+    if (value0 > value1) // Eight value mode, otherwise every index stays 0 which decodes to value0
+    {
+        std::array<float, 8> palette{};
+        palette[0] = static_cast<float>(value0);
+        palette[1] = static_cast<float>(value1);
+        for (uint32_t i = 2; i < 8; i++)
+        {
+            palette[i] = (static_cast<float>(8 - i) * palette[0] + static_cast<float>(i - 1) * palette[1]) / 7.0f;
+        }
+        for (uint32_t texelIndex = 0; texelIndex < 16; texelIndex++)
+        {
+            uint64_t bestIndex = 0;
+            float bestError = INFINITY;
+            for (uint32_t paletteIndex = 0; paletteIndex < 8; paletteIndex++)
+            {
+                const float error = std::abs(texels[texelIndex][channel] - palette[paletteIndex]);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = paletteIndex;
+                }
+            }
+            indices |= bestIndex << (texelIndex * 3);
+        }
+    }
+
+    out[0] = static_cast<unsigned char>(value0);
+    out[1] = static_cast<unsigned char>(value1);
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        out[2 + i] = static_cast<unsigned char>((indices >> (i * 8)) & 0xFF);
+    }
+}
+
+/* BC7 mode 6: one subset, 7 bit RGBA endpoints with a shared p-bit each and 4 bit indices */
+static void compress_bc7_block(const Block& texels, unsigned char* out)
+{
+    static constexpr uint32_t weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    std::array<float, 4> endpoints[2]{};
+    find_endpoints(texels, 4, endpoints[0], endpoints[1]);
+
+    // Quantize each endpoint to 7 bits plus whichever p-bit lands closer
+    uint32_t quantized[2][4] = {};
+    uint32_t pBits[2] = {};
+    uint32_t expanded[2][4] = {};
+    for (uint32_t e = 0; e < 2; e++)
+    {
+        float bestError = INFINITY;
+        for (uint32_t p = 0; p < 2; p++)
+        {
+            float error = 0.0f;
+            uint32_t candidate[4];
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                const float value = (endpoints[e][i] - static_cast<float>(p)) / 2.0f;
+                candidate[i] = static_cast<uint32_t>(std::clamp(std::lround(value), 0l, 127l));
+                const float difference = static_cast<float>((candidate[i] << 1) | p) - endpoints[e][i];
+                error += difference * difference;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                pBits[e] = p;
+                std::copy(std::begin(candidate), std::end(candidate), quantized[e]);
+            }
+        }
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            expanded[e][i] = (quantized[e][i] << 1) | pBits[e];
+        }
+    }
+
+    uint32_t indices[16] = {};
+    for (uint32_t texelIndex = 0; texelIndex < 16; texelIndex++)
+    {
+        float bestError = INFINITY;
+        for (uint32_t weightIndex = 0; weightIndex < 16; weightIndex++)
+        {
+            float error = 0.0f;
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                const uint32_t value = ((64 - weights[weightIndex]) * expanded[0][i] + weights[weightIndex] * expanded[1][i] + 32) >> 6;
+                const float difference = texels[texelIndex][i] - static_cast<float>(value);
+                error += difference * difference;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                indices[texelIndex] = weightIndex;
+            }
+        }
+    }
+
+    // The first index is stored with its top bit implied to be 0, swap the endpoints if it isn't
+    if (indices[0] >= 8)
+    {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(pBits[0], pBits[1]);
+        for (uint32_t& index : indices)
+        {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer(out);
+    writer.write(1u << 6, 7); // Mode 6
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        writer.write(quantized[0][i], 7);
+        writer.write(quantized[1][i], 7);
+    }
+    writer.write(pBits[0], 1);
+    writer.write(pBits[1], 1);
+    writer.write(indices[0], 3);
+    for (uint32_t texelIndex = 1; texelIndex < 16; texelIndex++)
+    {
+        writer.write(indices[texelIndex], 4);
+    }
+}
+
+[[nodiscard]] uint32_t block_compressed_block_size(VkFormat format) {
+    switch (format)
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            return 8;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+[[nodiscard]] bool is_block_compressed(VkFormat format) {
+    return block_compressed_block_size(format) != 0;
+}
+
+[[nodiscard]] uint64_t compressed_level_size(VkFormat format, uint32_t width, uint32_t height) {
+    if (!is_block_compressed(format))
+    {
+        return static_cast<uint64_t>(width) * height * 4;
+    }
+    const uint64_t blocksWide = (width + 3) / 4;
+    const uint64_t blocksHigh = (height + 3) / 4;
+    return blocksWide * blocksHigh * block_compressed_block_size(format);
+}
+
+[[nodiscard]] std::vector<unsigned char> compress_rgba8(VkFormat format, const unsigned char* rgba, uint32_t width, uint32_t height) {
+    const uint32_t blockSize = block_compressed_block_size(format);
+    if (blockSize == 0)
+    {
+        MRCERR("Tried to block compress into a format that isn't supported by the encoder: " << format);
+        exit(1);
+    }
+
+    std::vector<unsigned char> compressed(compressed_level_size(format, width, height));
+    unsigned char* out = compressed.data();
+    for (uint32_t blockY = 0; blockY < height; blockY += 4)
+    {
+        for (uint32_t blockX = 0; blockX < width; blockX += 4)
+        {
+            Block texels;
+            for (uint32_t y = 0; y < 4; y++)
+            {
+                for (uint32_t x = 0; x < 4; x++)
+                {
+                    const uint32_t sourceX = std::min(blockX + x, width - 1);
+                    const uint32_t sourceY = std::min(blockY + y, height - 1);
+                    const unsigned char* texel = rgba + (static_cast<size_t>(sourceY) * width + sourceX) * 4;
+                    for (uint32_t i = 0; i < 4; i++)
+                    {
+                        texels[y * 4 + x][i] = static_cast<float>(texel[i]);
+                    }
+                }
+            }
+
+            switch (format)
+            {
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                    compress_bc1_block(texels, out);
+                    break;
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                    compress_bc4_block(texels, 3, out);
+                    compress_bc1_block(texels, out + 8);
+                    break;
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                    compress_bc4_block(texels, 0, out);
+                    compress_bc4_block(texels, 1, out + 8);
+                    break;
+                case VK_FORMAT_BC7_UNORM_BLOCK:
+                default:
+                    compress_bc7_block(texels, out);
+                    break;
+            }
+            out += blockSize;
+        }
+    }
+    return compressed;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Small CPU block compressors used by the AssetCooker, each works on 4x4 blocks of RGBA8 texels.
+ * Supports VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC3_UNORM_BLOCK, VK_FORMAT_BC5_UNORM_BLOCK and VK_FORMAT_BC7_UNORM_BLOCK (mode 6 only).
+ * These favour simplicity over quality, a dedicated encoder will do better but the formats are identical.
+ */
+
+/* Bytes per 4x4 block, 0 for formats that aren't block compressed */
+[[nodiscard]] uint32_t block_compressed_block_size(VkFormat format);
+[[nodiscard]] bool is_block_compressed(VkFormat format);
+/* Bytes needed for one level of the given size, in either a block compressed format or RGBA8 */
+[[nodiscard]] uint64_t compressed_level_size(VkFormat format, uint32_t width, uint32_t height);
+
+/* Compress a tightly packed RGBA8 image, edge blocks of sizes that aren't a multiple of 4 repeat their last row/column */
+[[nodiscard]] std::vector<unsigned char> compress_rgba8(VkFormat format, const unsigned char* rgba, uint32_t width, uint32_t height);
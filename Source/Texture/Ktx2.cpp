@@ -0,0 +1,242 @@
+#include "Ktx2.h"
+#include <Texture/BlockCompression.h>
+#include <Texture/MipChain.h>
+#include <Common/Log.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+static constexpr unsigned char KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+struct Ktx2Header {
+    unsigned char identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+static_assert(sizeof(Ktx2Header) == 80);
+
+// Khronos Data Format basic descriptor block values, see the Khronos Data Format Specification 1.3
+static constexpr uint32_t KDF_MODEL_RGBSDA = 1;
+static constexpr uint32_t KDF_MODEL_BC1A = 128;
+static constexpr uint32_t KDF_MODEL_BC3 = 130;
+static constexpr uint32_t KDF_MODEL_BC5 = 132;
+static constexpr uint32_t KDF_MODEL_BC7 = 134;
+static constexpr uint32_t KDF_PRIMARIES_BT709 = 1;
+static constexpr uint32_t KDF_TRANSFER_LINEAR = 1;
+static constexpr uint32_t KDF_CHANNEL_RED = 0;
+static constexpr uint32_t KDF_CHANNEL_GREEN = 1;
+static constexpr uint32_t KDF_CHANNEL_BLUE = 2;
+static constexpr uint32_t KDF_CHANNEL_ALPHA = 15;
+static constexpr uint32_t KDF_CHANNEL_COLOR = 0; // Block compressed color models just call their main channel "color"
+
+struct DfdSample {
+    uint32_t bitOffset;
+    uint32_t bitLength;
+    uint32_t channelType;
+    uint32_t upper;
+};
+
+/* Basic data format descriptor, every KTX2 file needs one even though we only look at vkFormat when reading */
+static std::vector<uint32_t> build_dfd(VkFormat format) {
+    uint32_t colorModel = KDF_MODEL_RGBSDA;
+    uint32_t texelBlockDimension = 0; // Each dimension stored minus one
+    uint32_t bytesPlane0 = 4;
+    std::vector<DfdSample> samples;
+    switch (format)
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            colorModel = KDF_MODEL_BC1A;
+            samples = {{0, 64, KDF_CHANNEL_COLOR, UINT32_MAX}};
+            break;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+            colorModel = KDF_MODEL_BC3;
+            samples = {{0, 64, KDF_CHANNEL_ALPHA, UINT32_MAX}, {64, 64, KDF_CHANNEL_COLOR, UINT32_MAX}};
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            colorModel = KDF_MODEL_BC5;
+            samples = {{0, 64, KDF_CHANNEL_RED, UINT32_MAX}, {64, 64, KDF_CHANNEL_GREEN, UINT32_MAX}};
+            break;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            colorModel = KDF_MODEL_BC7;
+            samples = {{0, 128, KDF_CHANNEL_COLOR, UINT32_MAX}};
+            break;
+        default: // RGBA8
+            samples = {{0, 8, KDF_CHANNEL_RED, 255}, {8, 8, KDF_CHANNEL_GREEN, 255}, {16, 8, KDF_CHANNEL_BLUE, 255}, {24, 8, KDF_CHANNEL_ALPHA, 255}};
+            break;
+    }
+    if (is_block_compressed(format))
+    {
+        texelBlockDimension = 3 | (3 << 8);
+        bytesPlane0 = block_compressed_block_size(format);
+    }
+
+    const uint32_t descriptorBlockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+    std::vector<uint32_t> dfd;
+    dfd.push_back(4 + descriptorBlockSize); // dfdTotalSize
+    dfd.push_back(0); // vendorId = Khronos, descriptorType = basic
+    dfd.push_back(2 | (descriptorBlockSize << 16)); // versionNumber = 1.3
+    dfd.push_back(colorModel | (KDF_PRIMARIES_BT709 << 8) | (KDF_TRANSFER_LINEAR << 16)); // flags = 0, straight alpha
+    dfd.push_back(texelBlockDimension);
+    dfd.push_back(bytesPlane0);
+    dfd.push_back(0);
+    for (const DfdSample& sample : samples)
+    {
+        dfd.push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channelType << 24));
+        dfd.push_back(0); // samplePosition
+        dfd.push_back(0); // sampleLower
+        dfd.push_back(sample.upper);
+    }
+    return dfd;
+}
+
+static uint64_t align_offset(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+[[nodiscard]] bool write_ktx2(const std::filesystem::path& outputPath, VkFormat format, uint32_t width, uint32_t height, std::span<const std::vector<unsigned char>> levels) {
+    const std::vector<uint32_t> dfd = build_dfd(format);
+
+    Ktx2Header header = {};
+    std::memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    header.vkFormat = static_cast<uint32_t>(format);
+    header.typeSize = 1;
+    header.pixelWidth = width;
+    header.pixelHeight = height;
+    header.faceCount = 1;
+    header.levelCount = static_cast<uint32_t>(levels.size());
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(Ktx2Header) + levels.size() * sizeof(uint64_t) * 3);
+    header.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+    // Mip data is stored smallest level first, each level aligned to lcm(texel block size, 4)
+    const uint64_t levelAlignment = is_block_compressed(format) ? block_compressed_block_size(format) : 4;
+    std::vector<uint64_t> levelIndex(levels.size() * 3);
+    uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        offset = align_offset(offset, levelAlignment);
+        levelIndex[level * 3 + 0] = offset;
+        levelIndex[level * 3 + 1] = levels[level].size();
+        levelIndex[level * 3 + 2] = levels[level].size();
+        offset += levels[level].size();
+    }
+
+    std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        MRCERR("Could not open " << outputPath.string() << " for writing");
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(levelIndex.data()), static_cast<std::streamsize>(levelIndex.size() * sizeof(uint64_t)));
+    file.write(reinterpret_cast<const char*>(dfd.data()), static_cast<std::streamsize>(dfd.size() * sizeof(uint32_t)));
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        static constexpr char padding[16] = {};
+        const uint64_t position = static_cast<uint64_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(levelIndex[level * 3] - position));
+        file.write(reinterpret_cast<const char*>(levels[level].data()), static_cast<std::streamsize>(levels[level].size()));
+    }
+    return static_cast<bool>(file);
+}
+
+[[nodiscard]] bool Ktx2View::open(const std::filesystem::path& path) {
+    m_levels.clear();
+    if (!m_file.open(path))
+    {
+        return false;
+    }
+
+    Ktx2Header header;
+    if (m_file.size() < sizeof(header))
+    {
+        MRWARN("Cooked texture " << path.string() << " is truncated, ignoring it");
+        m_file.close();
+        return false;
+    }
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0 || header.supercompressionScheme != 0 ||
+        header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.levelCount == 0 || header.pixelWidth == 0 || header.pixelHeight == 0)
+    {
+        MRWARN("Cooked texture " << path.string() << " is not a plain 2D KTX2 file, ignoring it");
+        m_file.close();
+        return false;
+    }
+    // Also keeps the per level shifts below 32 bits
+    if (header.levelCount > mip_level_count(header.pixelWidth, header.pixelHeight))
+    {
+        MRWARN("Cooked texture " << path.string() << " has more levels than its size allows, ignoring it");
+        m_file.close();
+        return false;
+    }
+
+    const uint64_t levelIndexSize = static_cast<uint64_t>(header.levelCount) * sizeof(LevelIndex);
+    if (sizeof(header) + levelIndexSize > m_file.size())
+    {
+        MRWARN("Cooked texture " << path.string() << " is truncated, ignoring it");
+        m_file.close();
+        return false;
+    }
+    m_levels.resize(header.levelCount);
+    std::memcpy(m_levels.data(), m_file.data() + sizeof(header), levelIndexSize);
+
+    const VkFormat format = static_cast<VkFormat>(header.vkFormat);
+    if (format != VK_FORMAT_R8G8B8A8_UNORM && !is_block_compressed(format))
+    {
+        MRWARN("Cooked texture " << path.string() << " uses unsupported format " << header.vkFormat << ", ignoring it");
+        m_levels.clear();
+        m_file.close();
+        return false;
+    }
+    for (uint32_t level = 0; level < header.levelCount; level++)
+    {
+        const uint32_t levelWidth = std::max(header.pixelWidth >> level, 1u);
+        const uint32_t levelHeight = std::max(header.pixelHeight >> level, 1u);
+        const LevelIndex& levelIndex = m_levels[level];
+        const bool bInFile = levelIndex.byteOffset <= m_file.size() && levelIndex.byteLength <= m_file.size() - levelIndex.byteOffset;
+        if (!bInFile || levelIndex.byteLength != compressed_level_size(format, levelWidth, levelHeight))
+        {
+            MRWARN("Cooked texture " << path.string() << " has a bad level " << level << ", ignoring it");
+            m_levels.clear();
+            m_file.close();
+            return false;
+        }
+    }
+
+    m_format = format;
+    m_width = header.pixelWidth;
+    m_height = header.pixelHeight;
+    return true;
+}
+
+[[nodiscard]] VkFormat Ktx2View::get_format() const {
+    return m_format;
+}
+
+[[nodiscard]] uint32_t Ktx2View::get_width() const {
+    return m_width;
+}
+
+[[nodiscard]] uint32_t Ktx2View::get_height() const {
+    return m_height;
+}
+
+[[nodiscard]] uint32_t Ktx2View::get_level_count() const {
+    return static_cast<uint32_t>(m_levels.size());
+}
+
+[[nodiscard]] std::span<const unsigned char> Ktx2View::get_level_data(uint32_t level) const {
+    return {m_file.data() + m_levels[level].byteOffset, m_levels[level].byteLength};
+}
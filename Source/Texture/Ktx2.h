@@ -0,0 +1,50 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <Common/MappedFile.h>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+/*
+ * Minimal KTX2 (https://registry.khronos.org/KTX/specs/2.0/ktxspec.html) support for the cooked texture pipeline.
+ * Only single layer, single face 2D textures without supercompression are written and accepted.
+ */
+
+/* Level i of levels is mip i, each tightly packed in format */
+[[nodiscard]] bool write_ktx2(const std::filesystem::path& outputPath, VkFormat format, uint32_t width, uint32_t height, std::span<const std::vector<unsigned char>> levels);
+
+/*
+ * Memory mapped, validated view of a KTX2 file. Level spans point straight into the mapping and stay valid while this object lives.
+ */
+class Ktx2View
+{
+public:
+    Ktx2View() = default;
+    Ktx2View(const Ktx2View&) = delete;
+    Ktx2View& operator=(const Ktx2View&) = delete;
+    Ktx2View(Ktx2View&&) = delete;
+    Ktx2View& operator=(Ktx2View&&) = delete;
+
+    /* Fails (without logging an error) if the file is missing, and with a warning if it is malformed or uses features we don't read */
+    [[nodiscard]] bool open(const std::filesystem::path& path);
+
+    [[nodiscard]] VkFormat get_format() const;
+    [[nodiscard]] uint32_t get_width() const;
+    [[nodiscard]] uint32_t get_height() const;
+    [[nodiscard]] uint32_t get_level_count() const;
+    [[nodiscard]] std::span<const unsigned char> get_level_data(uint32_t level) const;
+
+private:
+    struct LevelIndex {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    MappedFile m_file;
+    VkFormat m_format{VK_FORMAT_UNDEFINED};
+    uint32_t m_width{0};
+    uint32_t m_height{0};
+    std::vector<LevelIndex> m_levels;
+};
@@ -0,0 +1,51 @@
+#include "MipChain.h"
+#include <algorithm>
+#include <bit>
+
+[[nodiscard]] uint32_t mip_level_count(uint32_t width, uint32_t height) {
+    return static_cast<uint32_t>(std::bit_width(std::max(std::max(width, height), 1u)));
+}
+
+[[nodiscard]] std::vector<MipLevel> build_mip_chain_rgba8(const unsigned char* data, uint32_t width, uint32_t height) {
+    std::vector<MipLevel> levels;
+    const uint32_t levelCount = mip_level_count(width, height);
+    if (levelCount <= 1)
+    {
+        return levels;
+    }
+    levels.reserve(levelCount - 1);
+
+    const unsigned char* src = data;
+    uint32_t srcWidth = width;
+    uint32_t srcHeight = height;
+    for (uint32_t level = 1; level < levelCount; level++)
+    {
+        MipLevel& mip = levels.emplace_back();
+        mip.width = std::max(srcWidth / 2, 1u);
+        mip.height = std::max(srcHeight / 2, 1u);
+        mip.pixels.resize(static_cast<size_t>(mip.width) * mip.height * 4);
+
+        for (uint32_t y = 0; y < mip.height; y++)
+        {
+            // Clamp so odd / 1 pixel wide sources reuse their last row/column instead of reading past the end
+            const uint32_t y0 = std::min(y * 2, srcHeight - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (uint32_t x = 0; x < mip.width; x++)
+            {
+                const uint32_t x0 = std::min(x * 2, srcWidth - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    const uint32_t sum = src[(y0 * srcWidth + x0) * 4 + c] + src[(y0 * srcWidth + x1) * 4 + c]
+                                       + src[(y1 * srcWidth + x0) * 4 + c] + src[(y1 * srcWidth + x1) * 4 + c];
+                    mip.pixels[(y * mip.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+
+        src = mip.pixels.data();
+        srcWidth = mip.width;
+        srcHeight = mip.height;
+    }
+    return levels;
+}
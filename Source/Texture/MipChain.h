@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct MipLevel {
+    uint32_t width;
+    uint32_t height;
+    std::vector<unsigned char> pixels; // RGBA8, tightly packed
+};
+
+/* Number of levels in a full chain down to 1x1 */
+[[nodiscard]] uint32_t mip_level_count(uint32_t width, uint32_t height);
+
+/* Box filter RGBA8 data down to 1x1 on the CPU, returns levels 1..N (level 0 is the input itself) */
+[[nodiscard]] std::vector<MipLevel> build_mip_chain_rgba8(const unsigned char* data, uint32_t width, uint32_t height);
@@ -1,15 +1,29 @@
 #include "TextureCache.h"
 #include <Rendering/GfxDevice.h>
+#include <Texture/MipChain.h>
+#include <Texture/BlockCompression.h>
+#include <Texture/Ktx2.h>
+#include <algorithm>
 
 [[nodiscard]] GPUTextureId TextureCache::add_texture(const GfxDevice& gfxDevice, const TextureLoadingData& texLoadingData, const std::string& textureName) {
     const GPUTextureId textureId = static_cast<uint32_t>(m_gpuTextures.size());
     upload_texture(gfxDevice, texLoadingData);
+    return register_texture_name(textureId, textureName);
+}
+
+[[nodiscard]] GPUTextureId TextureCache::add_cooked_texture(const GfxDevice& gfxDevice, const Ktx2View& cookedTexture, const std::string& textureName) {
+    const GPUTextureId textureId = static_cast<uint32_t>(m_gpuTextures.size());
+    upload_cooked_texture(gfxDevice, cookedTexture);
+    return register_texture_name(textureId, textureName);
+}
+
+[[nodiscard]] GPUTextureId TextureCache::register_texture_name(GPUTextureId textureId, const std::string& textureName) {
     if (is_texture_loaded_already(textureName))
     {
         MRCERR("Already loaded this texture without checking is_texture_loaded_already(), did you mean to do this?");
         exit(1);
     }
-    m_texturesLoadedAlready.emplace(std::move(textureName), textureId);
+    m_texturesLoadedAlready.emplace(textureName, textureId);
     return textureId;
 }
 
@@ -36,11 +50,7 @@
 
     GPUTexture renderTexture;
 
-    VkExtent3D imageExtent; 
-    imageExtent.width = WINDOW_WIDTH;
-    imageExtent.height = WINDOW_HEIGHT;
-    imageExtent.depth = 1;
-    renderTexture.allocatedImage.imageExtent = imageExtent;
+    renderTexture.allocatedImage.imageExtent = imageCreateInfo.extent;
     renderTexture.allocatedImage.imageFormat = format;
 
     create_gpu_only_image(renderTexture.allocatedImage, imageCreateInfo, gfxDevice.m_vmaAllocator);
@@ -53,10 +63,41 @@
     return textureId;
 }
 
+[[nodiscard]] GPUTextureId TextureCache::add_render_texture_texture(const GfxDevice& gfxDevice, const AllocatedImage& allocatedImage) {
+    const GPUTextureId textureId = static_cast<uint32_t>(m_gpuRTTextures.size());
+
+    GPUTexture renderTexture;
+    renderTexture.allocatedImage = allocatedImage;
+    VkImageViewCreateInfo imageViewCreateInfo = imageview_create_info(renderTexture.allocatedImage.image, renderTexture.allocatedImage.imageFormat, {}, VK_IMAGE_ASPECT_COLOR_BIT);
+    vkCreateImageView(gfxDevice, &imageViewCreateInfo, nullptr, &renderTexture.allocatedImage.imageView);
+
+    m_gpuRTTextures.push_back(renderTexture);
+    return textureId;
+}
+
 [[nodiscard]] const GPUTexture& TextureCache::get_render_texture_texture(GPUTextureId id) const {
     return m_gpuRTTextures[id];
 }
 
+[[nodiscard]] uint32_t TextureCache::get_total_mip_level_count() const {
+    return m_totalMipLevelCount;
+}
+
+[[nodiscard]] uint32_t TextureCache::get_gpu_generated_mip_chain_count() const {
+    return m_gpuGeneratedMipChainCount;
+}
+
+[[nodiscard]] uint32_t TextureCache::get_cpu_generated_mip_chain_count() const {
+    return m_cpuGeneratedMipChainCount;
+}
+
+[[nodiscard]] uint32_t TextureCache::get_cooked_texture_count() const {
+    return m_cookedTextureCount;
+}
+
+[[nodiscard]] uint64_t TextureCache::get_texture_memory_size() const {
+    return m_textureMemorySize;
+}
 
 void TextureCache::cleanup(const GfxDevice& gfxDevice) {
     for (auto &texture : m_gpuTextures)
@@ -67,6 +108,7 @@ void TextureCache::cleanup(const GfxDevice& gfxDevice) {
 
     for (auto &texture : m_gpuRTTextures)
     {
+        // Render targets in the TransientImageAllocator heap have no allocation of their own, VMA then only destroys the image
         vkDestroyImageView(gfxDevice, texture.allocatedImage.imageView, nullptr);
         vmaDestroyImage(gfxDevice.m_vmaAllocator, texture.allocatedImage.image, texture.allocatedImage.allocation);
     }
@@ -90,9 +132,72 @@ void TextureCache::upload_texture(const GfxDevice& gfxDevice, const TextureLoadi
         exit(1);
     }
     gpuTexture.allocatedImage.imageFormat = format;
-    VkImageCreateInfo imageCreateInfo = image_create_info(format, imageExtent, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_TYPE_2D);
-    upload_image(static_cast<const void *>(texLoadingData.data), texLoadingData.texSize.ch, gpuTexture.allocatedImage, imageCreateInfo, gfxDevice);
-    VkImageViewCreateInfo imageViewCreateInfo = imageview_create_info(gpuTexture.allocatedImage.image, format, {}, VK_IMAGE_ASPECT_COLOR_BIT);
+
+    // Full chain down to 1x1
+    const uint32_t mipLevels = mip_level_count(imageExtent.width, imageExtent.height);
+    VkImageCreateInfo imageCreateInfo = image_create_info(format, imageExtent, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_IMAGE_TYPE_2D, mipLevels);
+    if (mipLevels == 1 || gfxDevice.supports_linear_blit(format))
+    {
+        // Upload mip 0 and let the GPU blit the rest down
+        upload_image(static_cast<const void *>(texLoadingData.data), texLoadingData.texSize.ch, gpuTexture.allocatedImage, imageCreateInfo, gfxDevice);
+        m_gpuGeneratedMipChainCount += mipLevels > 1 ? 1 : 0;
+    }
+    else
+    {
+        create_gpu_only_image(gpuTexture.allocatedImage, imageCreateInfo, gfxDevice.m_vmaAllocator);
+        gpuTexture.allocatedImage.mipLevels = mipLevels;
+
+        const std::vector<MipLevel> cpuMips = build_mip_chain_rgba8(static_cast<const unsigned char*>(texLoadingData.data), imageExtent.width, imageExtent.height);
+        std::vector<ImageLevelData> levels;
+        levels.reserve(mipLevels);
+        levels.push_back({texLoadingData.data, static_cast<VkDeviceSize>(imageExtent.width) * imageExtent.height * 4, imageExtent});
+        for (const MipLevel& mip : cpuMips)
+        {
+            levels.push_back({mip.pixels.data(), mip.pixels.size(), {mip.width, mip.height, 1}});
+        }
+        gfxDevice.get_upload_batcher().upload_image_levels(gpuTexture.allocatedImage, levels);
+        m_cpuGeneratedMipChainCount++;
+    }
+    m_totalMipLevelCount += mipLevels;
+    for (uint32_t level = 0; level < mipLevels; level++)
+    {
+        m_textureMemorySize += compressed_level_size(format, std::max(imageExtent.width >> level, 1u), std::max(imageExtent.height >> level, 1u));
+    }
+
+    VkImageViewCreateInfo imageViewCreateInfo = imageview_create_info(gpuTexture.allocatedImage.image, format, {}, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+    vkCreateImageView(gfxDevice, &imageViewCreateInfo, nullptr, &gpuTexture.allocatedImage.imageView);
+
+    m_gpuTextures.push_back(gpuTexture);
+}
+
+void TextureCache::upload_cooked_texture(const GfxDevice& gfxDevice, const Ktx2View& cookedTexture) {
+
+    GPUTexture gpuTexture;
+
+    const VkExtent3D imageExtent = {cookedTexture.get_width(), cookedTexture.get_height(), 1};
+    const VkFormat format = cookedTexture.get_format();
+    const uint32_t mipLevels = cookedTexture.get_level_count();
+    gpuTexture.allocatedImage.imageExtent = imageExtent;
+    gpuTexture.allocatedImage.imageFormat = format;
+    gpuTexture.allocatedImage.mipLevels = mipLevels;
+
+    VkImageCreateInfo imageCreateInfo = image_create_info(format, imageExtent, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_TYPE_2D, mipLevels);
+    create_gpu_only_image(gpuTexture.allocatedImage, imageCreateInfo, gfxDevice.m_vmaAllocator);
+
+    // Levels are staged straight out of the mapped file, compressed blocks are copied as is
+    std::vector<ImageLevelData> levels;
+    levels.reserve(mipLevels);
+    for (uint32_t level = 0; level < mipLevels; level++)
+    {
+        const std::span<const unsigned char> levelData = cookedTexture.get_level_data(level);
+        levels.push_back({levelData.data(), levelData.size(), {std::max(imageExtent.width >> level, 1u), std::max(imageExtent.height >> level, 1u), 1}});
+        m_textureMemorySize += levelData.size();
+    }
+    gfxDevice.get_upload_batcher().upload_image_levels(gpuTexture.allocatedImage, levels);
+    m_totalMipLevelCount += mipLevels;
+    m_cookedTextureCount++;
+
+    VkImageViewCreateInfo imageViewCreateInfo = imageview_create_info(gpuTexture.allocatedImage.image, format, {}, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
     vkCreateImageView(gfxDevice, &imageViewCreateInfo, nullptr, &gpuTexture.allocatedImage.imageView);
 
     m_gpuTextures.push_back(gpuTexture);
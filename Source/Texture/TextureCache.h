@@ -7,6 +7,7 @@
 #include <string>
 
 class GfxDevice;
+class Ktx2View;
 
 struct GPUTexture {
     AllocatedImage allocatedImage;
@@ -23,18 +24,35 @@ public:
     TextureCache& operator=(TextureCache&&) = delete;
 
     [[nodiscard]] GPUTextureId add_texture(const GfxDevice& gfxDevice, const TextureLoadingData& texLoadingData, const std::string& textureName);
+    /* Upload a cooked texture's levels as they are, the caller must check gfxDevice.supports_sampled_format() first */
+    [[nodiscard]] GPUTextureId add_cooked_texture(const GfxDevice& gfxDevice, const Ktx2View& cookedTexture, const std::string& textureName);
     [[nodiscard]] const GPUTexture& get_texture(GPUTextureId id) const;
     [[nodiscard]] GPUTextureId get_texture_id(const std::string&e) const;
     [[nodiscard]] uint32_t get_texture_count() const;
     [[nodiscard]] bool is_texture_loaded_already(const std::string&) const;
     [[nodiscard]] GPUTextureId add_render_texture_texture(const GfxDevice& gfxDevice, VkFormat format, VkImageCreateInfo imageCreateInfo);
+    /* For render targets created and bound elsewhere (TransientImageAllocator), only the view is made here. The cache still destroys the image */
+    [[nodiscard]] GPUTextureId add_render_texture_texture(const GfxDevice& gfxDevice, const AllocatedImage& allocatedImage);
     [[nodiscard]] const GPUTexture& get_render_texture_texture(GPUTextureId id) const;
+    [[nodiscard]] uint32_t get_total_mip_level_count() const;
+    [[nodiscard]] uint32_t get_gpu_generated_mip_chain_count() const;
+    [[nodiscard]] uint32_t get_cpu_generated_mip_chain_count() const;
+    [[nodiscard]] uint32_t get_cooked_texture_count() const;
+    [[nodiscard]] uint64_t get_texture_memory_size() const;
     void cleanup(const GfxDevice& gfxDevice);
 
 private:
     void upload_texture(const GfxDevice& gfxDevice, const TextureLoadingData& texLoadingData);
+    void upload_cooked_texture(const GfxDevice& gfxDevice, const Ktx2View& cookedTexture);
+    [[nodiscard]] GPUTextureId register_texture_name(GPUTextureId textureId, const std::string& textureName);
     std::vector<GPUTexture> m_gpuTextures;
     std::vector<GPUTexture> m_gpuRTTextures;
+    // Stats
+    uint32_t m_totalMipLevelCount{0};
+    uint32_t m_gpuGeneratedMipChainCount{0}; // Blit chain on the GPU
+    uint32_t m_cpuGeneratedMipChainCount{0}; // Box filtered on the CPU when the format can't be blitted
+    uint32_t m_cookedTextureCount{0}; // Uploaded straight from a KTX2 file with prebuilt mips
+    uint64_t m_textureMemorySize{0}; // Sum of every texture level, excluding render textures and driver padding
     std::unordered_map<std::string, GPUTextureId> m_texturesLoadedAlready; // std::string (or string_view?) required since doing const char* is comparing different pointers each time
     // TODO: It should really not using std:string as a key, since there is O(N) cost on the string length for both hashing and comparison...
 };
@@ -0,0 +1,60 @@
+#include "TextureDecoder.h"
+#include <Common/ThreadPool.h>
+#include <Common/Log.h>
+#include <Common/CpuProfiler.h>
+#include <Common/Compiler/DisableWarnings.h>
+PUSH_MSVC_WARNINGS
+DISABLE_MSVC_WARNING(4267) // conversion from 'size_t' to 'uint32_t', possible loss of data
+PUSH_CLANG_WARNINGS
+DISABLE_CLANG_WARNING("-Wmissing-field-initializers")
+DISABLE_CLANG_WARNING("-Wshorten-64-to-32")
+// Define these only in *one* .cpp file, this one is in magic-red-core so the renderer and the tools share it
+#define STB_IMAGE_IMPLEMENTATION
+#include <External/tinygltf/stb_image.h>
+POP_CLANG_WARNINGS
+POP_MSVC_WARNINGS
+#include <climits>
+
+static void decode_texture(TextureDecodeRequest& request) {
+    MR_PROFILE_ZONE("Decode texture");
+    int width, height, numberComponents;
+    stbi_uc* data = nullptr;
+    if (request.encodedData)
+    {
+        if (request.encodedSize > static_cast<size_t>(INT_MAX))
+        {
+            MRCERR("Embedded texture is too large to decode: " << request.textureName);
+            return;
+        }
+        data = stbi_load_from_memory(request.encodedData, static_cast<int>(request.encodedSize), &width, &height, &numberComponents, STBI_rgb_alpha);
+    }
+    else
+    {
+        data = stbi_load(request.filePath.string().c_str(), &width, &height, &numberComponents, STBI_rgb_alpha);
+    }
+
+    if (!data)
+    {
+        MRCERR("Failed to decode texture " << request.textureName << ": " << stbi_failure_reason());
+        return;
+    }
+    request.decoded = {
+        .data = data,
+        .texSize = {width, height, 4} // TODO: force all images to have 4 channels...ignoring numberComponents for now
+    };
+}
+
+void decode_textures(ThreadPool& threadPool, std::span<TextureDecodeRequest> requests) {
+    // stb_image keeps no shared state for plain loads, so each decode can run on its own worker
+    threadPool.parallel_for(requests.size(), [&](size_t i) {
+        decode_texture(requests[i]);
+    });
+}
+
+void free_decoded_textures(std::span<TextureDecodeRequest> requests) {
+    for (TextureDecodeRequest& request : requests)
+    {
+        stbi_image_free(request.decoded.data);
+        request.decoded.data = nullptr;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <Texture/TextureData.h>
+#include <filesystem>
+#include <string>
+#include <span>
+
+class ThreadPool;
+
+/*
+ * A single image waiting to be decoded, either from a file on disk or from compressed bytes embedded in a model (.glb)
+ */
+struct TextureDecodeRequest {
+    std::string textureName; // Key the decoded texture will be registered under in the TextureCache
+    std::filesystem::path filePath;
+    const unsigned char* encodedData{nullptr}; // Non-null for embedded textures
+    size_t encodedSize{0};
+    TextureLoadingData decoded; // Filled in by decode_textures(), always 4 channels
+};
+
+/* Decode every request into RGBA8 on the pool's worker threads, blocks until all are done */
+void decode_textures(ThreadPool& threadPool, std::span<TextureDecodeRequest> requests);
+
+/* Release the pixel data allocated by decode_textures() */
+void free_decoded_textures(std::span<TextureDecodeRequest> requests);
@@ -1,6 +1,7 @@
 #pragma once
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <cstdint>
 
 // https://github.com/eliasdaler/edbr/blob/master/edbr/include/edbr/Graphics/CPUMesh.h
 struct Vertex {
@@ -11,3 +12,26 @@ struct Vertex {
     glm::vec4 tangent;
     glm::vec4 color;
 };
+
+/* Which vertex layout meshes are uploaded in, chosen when a model is loaded. Pages in the MeshCache and G-buffer pipelines are per format */
+enum class VertexFormat : uint32_t {
+    Full, // Vertex
+    Compact // CompactVertex
+};
+
+/*
+ * Quantized vertex, a third of the size of Vertex. Matches get_compact_vertex_description() and triangle_mesh_compact.vert.
+ * Positions are relative to the mesh's AABB and are dequantized with it, normals and tangents are octahedral encoded.
+ * There is no per vertex color, the material's base color is all Vertex::color ever held.
+ */
+struct CompactVertex {
+    uint16_t position[4]; // unorm16 across [boundsMin, boundsMax], w unused
+    int16_t normal[2]; // snorm16 octahedral
+    int8_t tangent[4]; // snorm8, xy octahedral, z unused, w bitangent sign
+    uint16_t uv[2]; // Half floats
+};
+static_assert(sizeof(CompactVertex) == 20);
+
+[[nodiscard]] constexpr uint32_t vertex_stride(VertexFormat format) {
+    return format == VertexFormat::Compact ? sizeof(CompactVertex) : sizeof(Vertex);
+}
@@ -55,4 +55,49 @@
     description.attributes.push_back(tangentAttribute);
     description.attributes.push_back(colorAttribute);
     return description;
-}
\ No newline at end of file
+}
+
+[[nodiscard]] VertexInputDescription VertexInputDescription::get_compact_vertex_description() {
+    VertexInputDescription description;
+
+    VkVertexInputBindingDescription mainBindingDescription = {};
+    mainBindingDescription.binding = 0;
+    mainBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    mainBindingDescription.stride = sizeof(CompactVertex);
+
+    description.bindings.push_back(mainBindingDescription);
+
+    VkVertexInputAttributeDescription positionAttribute = {};
+    positionAttribute.binding = 0;
+    positionAttribute.location = 0;
+    positionAttribute.format = VK_FORMAT_R16G16B16A16_UNORM;
+    positionAttribute.offset = offsetof(CompactVertex, position);
+
+    VkVertexInputAttributeDescription normalAttribute = {};
+    normalAttribute.binding = 0;
+    normalAttribute.location = 1;
+    normalAttribute.format = VK_FORMAT_R16G16_SNORM;
+    normalAttribute.offset = offsetof(CompactVertex, normal);
+
+    VkVertexInputAttributeDescription tangentAttribute = {};
+    tangentAttribute.binding = 0;
+    tangentAttribute.location = 2;
+    tangentAttribute.format = VK_FORMAT_R8G8B8A8_SNORM;
+    tangentAttribute.offset = offsetof(CompactVertex, tangent);
+
+    VkVertexInputAttributeDescription uvAttribute = {};
+    uvAttribute.binding = 0;
+    uvAttribute.location = 3;
+    uvAttribute.format = VK_FORMAT_R16G16_SFLOAT;
+    uvAttribute.offset = offsetof(CompactVertex, uv);
+
+    description.attributes.push_back(positionAttribute);
+    description.attributes.push_back(normalAttribute);
+    description.attributes.push_back(tangentAttribute);
+    description.attributes.push_back(uvAttribute);
+    return description;
+}
+
+[[nodiscard]] VertexInputDescription VertexInputDescription::get_vertex_description(VertexFormat format) {
+    return format == VertexFormat::Compact ? get_compact_vertex_description() : get_default_vertex_description();
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <vulkan/vulkan.h>
+#include <Vertex/Vertex.h>
 
 /* 
  * A description that includes:
@@ -17,4 +18,7 @@ struct VertexInputDescription {
 
     /* Return VertexInputBinding and VertexInputAttribute descriptions for the Vertex type */
     static VertexInputDescription get_default_vertex_description();
+    /* Same for CompactVertex, the attributes come out as floats (unorm/snorm/half) but position and normal/tangent still need decoding in the shader */
+    static VertexInputDescription get_compact_vertex_description();
+    static VertexInputDescription get_vertex_description(VertexFormat format);
 };
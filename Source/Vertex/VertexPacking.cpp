@@ -0,0 +1,66 @@
+#include "VertexPacking.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cmath>
+
+// Octahedral mapping of a unit vector onto [-1, 1]^2 (Cigolle et al. 2014, "A Survey of Efficient Representations for Independent Unit Vectors")
+static glm::vec2 octahedral_encode(glm::vec3 direction) {
+    const float length = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+    if (length < 1e-12f)
+    {
+        return glm::vec2(1.0f, 0.0f); // No direction (e.g. the tangent before it is imported), pick +X
+    }
+    direction /= length;
+    glm::vec2 encoded(direction.x, direction.y);
+    if (direction.z < 0.0f)
+    {
+        // Fold the lower hemisphere over the diagonals
+        encoded = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * glm::vec2(encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return encoded;
+}
+
+static int16_t pack_snorm16(float value) {
+    return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static int8_t pack_snorm8(float value) {
+    return static_cast<int8_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+}
+
+static uint16_t pack_unorm16(float value) {
+    return static_cast<uint16_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+void pack_compact_vertices(std::span<const Vertex> vertices, const glm::vec3& boundsMin, const glm::vec3& boundsMax, std::vector<CompactVertex>& packedVertices) {
+    // Flat meshes have a zero extent along one axis, every vertex then packs to 0 on it
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const glm::vec3 inverseExtent(extent.x > 0.0f ? 1.0f / extent.x : 0.0f, extent.y > 0.0f ? 1.0f / extent.y : 0.0f, extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+    packedVertices.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const Vertex& vertex = vertices[i];
+        CompactVertex& packedVertex = packedVertices[i];
+
+        const glm::vec3 position = (vertex.position - boundsMin) * inverseExtent;
+        packedVertex.position[0] = pack_unorm16(position.x);
+        packedVertex.position[1] = pack_unorm16(position.y);
+        packedVertex.position[2] = pack_unorm16(position.z);
+        packedVertex.position[3] = 0;
+
+        const glm::vec2 normal = octahedral_encode(vertex.normal);
+        packedVertex.normal[0] = pack_snorm16(normal.x);
+        packedVertex.normal[1] = pack_snorm16(normal.y);
+
+        const glm::vec2 tangent = octahedral_encode(glm::vec3(vertex.tangent));
+        packedVertex.tangent[0] = pack_snorm8(tangent.x);
+        packedVertex.tangent[1] = pack_snorm8(tangent.y);
+        packedVertex.tangent[2] = 0;
+        packedVertex.tangent[3] = vertex.tangent.w < 0.0f ? -127 : 127;
+
+        packedVertex.uv[0] = glm::packHalf1x16(vertex.uv_x);
+        packedVertex.uv[1] = glm::packHalf1x16(vertex.uv_y);
+    }
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <Vertex/Vertex.h>
+#include <span>
+#include <vector>
+
+/* Quantize vertices into CompactVertex, positions relative to [boundsMin, boundsMax] which has to contain all of them */
+void pack_compact_vertices(std::span<const Vertex> vertices, const glm::vec3& boundsMin, const glm::vec3& boundsMax, std::vector<CompactVertex>& packedVertices);
+
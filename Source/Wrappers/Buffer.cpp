@@ -3,6 +3,82 @@
 #include <cassert>
 #include <Common/Log.h>
 #include <cstring>
+#include <Rendering/GfxDevice.h>
+
+void create_buffer(AllocatedBuffer& allocatedBuffer, size_t bufferSize, VkBufferUsageFlags bufferUsage, VmaMemoryUsage memoryUsage, VmaAllocator allocator) {
+
+    assert(bufferSize > 0);
+
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = bufferSize;
+    bufferCreateInfo.usage = bufferUsage;
+
+    VmaAllocationCreateInfo vmaAllocInfo = {};
+    vmaAllocInfo.usage = memoryUsage;
+
+    VkResult res = vmaCreateBuffer(allocator, &bufferCreateInfo, &vmaAllocInfo,
+        &allocatedBuffer.buffer,
+        &allocatedBuffer.allocation,
+        nullptr
+    );
+    if (res != VK_SUCCESS) {
+        MRCERR(string_VkResult(res));
+        MRCERR("Could not allocate buffer!");
+    }
+}
+
+void create_static_buffer(AllocatedBuffer& allocatedBuffer, size_t bufferSize, VkBufferUsageFlags bufferUsage, VmaAllocator allocator) {
+
+    assert(bufferSize > 0);
+
+    VkBufferCreateInfo bufferCreateInfo = {};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = bufferSize;
+    bufferCreateInfo.usage = bufferUsage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    // Ask for device local memory, but let VMA hand out device local + host visible memory (ReBAR / UMA) when it has some,
+    // otherwise it falls back to plain device local memory that we have to reach with a transfer
+    VmaAllocationCreateInfo vmaAllocInfo = {};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo = {};
+    VkResult res = vmaCreateBuffer(allocator, &bufferCreateInfo, &vmaAllocInfo,
+        &allocatedBuffer.buffer,
+        &allocatedBuffer.allocation,
+        &allocationInfo
+    );
+    if (res != VK_SUCCESS) {
+        MRCERR(string_VkResult(res));
+        MRCERR("Could not allocate static buffer!");
+        exit(1);
+    }
+
+    VkMemoryPropertyFlags memoryProperties;
+    vmaGetAllocationMemoryProperties(allocator, allocatedBuffer.allocation, &memoryProperties);
+    allocatedBuffer.mappedData = (memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) ? allocationInfo.pMappedData : nullptr;
+}
+
+void write_static_buffer(AllocatedBuffer& allocatedBuffer, size_t dstOffset, size_t size, const void* data, const GfxDevice& gfxDevice) {
+
+    assert(size > 0);
+
+    if (allocatedBuffer.mappedData != nullptr)
+    {
+        memcpy(static_cast<char*>(allocatedBuffer.mappedData) + dstOffset, data, size);
+        vmaFlushAllocation(gfxDevice.m_vmaAllocator, allocatedBuffer.allocation, dstOffset, size); // No-op for HOST_COHERENT memory
+    }
+    else
+    {
+        gfxDevice.get_upload_batcher().upload_buffer(allocatedBuffer.buffer, dstOffset, data, size);
+    }
+}
+
+void upload_static_buffer(AllocatedBuffer& allocatedBuffer, size_t bufferSize, const void* bufferData, VkBufferUsageFlags bufferUsage, const GfxDevice& gfxDevice) {
+    create_static_buffer(allocatedBuffer, bufferSize, bufferUsage, gfxDevice.m_vmaAllocator);
+    write_static_buffer(allocatedBuffer, 0, bufferSize, bufferData, gfxDevice);
+}
 
 void upload_buffer(AllocatedBuffer& allocatedBuffer, size_t bufferSize, const void* bufferData, VkBufferUsageFlags bufferUsage, VmaAllocator allocator) {
 
@@ -6,11 +6,28 @@ struct AllocatedBuffer {
     VkBuffer buffer;
     VmaAllocation allocation;
     VkDeviceAddress gpuAddress;
+    void* mappedData{nullptr}; // Only set for persistently mapped buffers
 
     void cleanup(VmaAllocator allocator);
 };
 
-/* Given the raw desired data, upload a buffer to the GPU */
+/* Create an empty buffer, data is expected to arrive later through the UploadBatcher or a mapping */
+void create_buffer(AllocatedBuffer& allocatedBuffer, size_t bufferSize, VkBufferUsageFlags bufferUsage, VmaMemoryUsage memoryUsage, VmaAllocator allocator);
+
+class GfxDevice;
+
+/* Create a device local buffer for data written once and read by the GPU many times (geometry, materials).
+ * If VMA picks memory that is also host visible (ReBAR / UMA) the buffer stays mapped and mappedData is set */
+void create_static_buffer(AllocatedBuffer& allocatedBuffer, size_t bufferSize, VkBufferUsageFlags bufferUsage, VmaAllocator allocator);
+
+/* Write into a buffer made by create_static_buffer, in place when it is mapped, otherwise through the UploadBatcher
+ * in which case the contents are only valid after the batcher is flushed */
+void write_static_buffer(AllocatedBuffer& allocatedBuffer, size_t dstOffset, size_t size, const void* data, const GfxDevice& gfxDevice);
+
+/* create_static_buffer + write_static_buffer of the whole buffer */
+void upload_static_buffer(AllocatedBuffer& allocatedBuffer, size_t bufferSize, const void* bufferData, VkBufferUsageFlags bufferUsage, const GfxDevice& gfxDevice);
+
+/* Given the raw desired data, upload a buffer to host visible memory. Only meant for data rewritten every frame, use upload_static_buffer otherwise */
 void upload_buffer(AllocatedBuffer& allocatedBuffer, size_t bufferSize, const void* bufferData, VkBufferUsageFlags bufferUsage, VmaAllocator allocator);
 
 /* Update a buffer's data */
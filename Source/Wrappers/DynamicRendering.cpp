@@ -24,6 +24,7 @@
 }
 
 [[nodiscard]] VkRenderingInfoKHR rendering_info_fullscreen(
+    VkExtent2D extent,
     uint32_t colorAttachmentCount,
     VkRenderingAttachmentInfoKHR* pColorAttachments,
     VkRenderingAttachmentInfoKHR* pDepthAttachment
@@ -32,7 +33,7 @@
         .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
         .pNext = nullptr,
         .flags = {},
-        .renderArea = VkRect2D{ {0, 0}, {WINDOW_WIDTH, WINDOW_HEIGHT}},
+        .renderArea = VkRect2D{ {0, 0}, extent},
         .layerCount = 1,
         .viewMask = 0,
         .colorAttachmentCount = colorAttachmentCount,
@@ -9,6 +9,7 @@
     );
 
 [[nodiscard]] VkRenderingInfoKHR rendering_info_fullscreen(
+    VkExtent2D extent,
     uint32_t colorAttachmentCount,
     VkRenderingAttachmentInfoKHR* pColorAttachments,
     VkRenderingAttachmentInfoKHR* pDepthAttachment
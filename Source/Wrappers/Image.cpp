@@ -78,36 +78,14 @@ void create_gpu_only_image(AllocatedImage& allocatedImage, VkImageCreateInfo ima
 void upload_image(const void *data, int numChannels, AllocatedImage& allocatedImage, VkImageCreateInfo imageCreateInfo, const GfxDevice& gfxDevice) {
 
     create_gpu_only_image(allocatedImage, imageCreateInfo, gfxDevice.m_vmaAllocator);
+    allocatedImage.imageExtent = imageCreateInfo.extent;
+    allocatedImage.mipLevels = imageCreateInfo.mipLevels;
 
     // TODO: HARDCODED FOR RGBA8, 4 bytes per pixel
     size_t bytes_per_channel = 1;
     size_t num_channels = numChannels;
     size_t data_size = imageCreateInfo.extent.width * imageCreateInfo.extent.height * num_channels * bytes_per_channel;
-    AllocatedBuffer imageStagingBuffer;
-    upload_buffer(imageStagingBuffer, data_size, data, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, gfxDevice.m_vmaAllocator);
-
-    gfxDevice.immediate_submit([&](VkCommandBuffer cmd) {
-        transition_image(cmd, allocatedImage.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-        VkBufferImageCopy copyRegion = {};
-        copyRegion.bufferOffset = 0;
-        copyRegion.bufferRowLength = 0;
-        copyRegion.bufferImageHeight = 0;
-
-        copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copyRegion.imageSubresource.mipLevel = 0;
-        copyRegion.imageSubresource.baseArrayLayer = 0;
-        copyRegion.imageSubresource.layerCount = 1;
-        copyRegion.imageExtent = imageCreateInfo.extent;
-
-        // copy the buffer into the image
-        vkCmdCopyBufferToImage(cmd, imageStagingBuffer.buffer, allocatedImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
-
-        transition_image(cmd, allocatedImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    });
-
-    imageStagingBuffer.cleanup(gfxDevice.m_vmaAllocator);
+    gfxDevice.get_upload_batcher().upload_image(allocatedImage, data, data_size);
 }
 
 void copy_image_to_image(VkCommandBuffer commandBuffer, VkImage source, VkImage destination, VkExtent2D srcSize, VkExtent2D dstSize) {
@@ -143,7 +121,7 @@ void copy_image_to_image(VkCommandBuffer commandBuffer, VkImage source, VkImage
 	vkCmdBlitImage2(commandBuffer, &blitInfo);
 }
 
-[[nodiscard]] VkImageCreateInfo image_create_info(VkFormat format, VkExtent3D extent, VkImageUsageFlags usageFlags, VkImageType imageType) {
+[[nodiscard]] VkImageCreateInfo image_create_info(VkFormat format, VkExtent3D extent, VkImageUsageFlags usageFlags, VkImageType imageType, uint32_t mipLevels) {
     VkImageCreateInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     info.pNext = nullptr;
@@ -153,7 +131,7 @@ void copy_image_to_image(VkCommandBuffer commandBuffer, VkImage source, VkImage
     info.format = format;
     info.extent = extent;
 
-    info.mipLevels = 1;
+    info.mipLevels = mipLevels;
     info.arrayLayers = 1;
 
     // For MSAA. we will not be using it by default, so default it to 1 sample per pixel.
@@ -170,7 +148,7 @@ void copy_image_to_image(VkCommandBuffer commandBuffer, VkImage source, VkImage
     return info;
 }
 
-[[nodiscard]] VkImageViewCreateInfo imageview_create_info(VkImage image, VkFormat format, VkComponentMapping componentMapping, VkImageAspectFlags aspectFlags) {
+[[nodiscard]] VkImageViewCreateInfo imageview_create_info(VkImage image, VkFormat format, VkComponentMapping componentMapping, VkImageAspectFlags aspectFlags, uint32_t levelCount) {
     VkImageViewCreateInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     info.pNext = nullptr;
@@ -181,7 +159,7 @@ void copy_image_to_image(VkCommandBuffer commandBuffer, VkImage source, VkImage
     info.components = componentMapping;
     info.subresourceRange.aspectMask = aspectFlags;
     info.subresourceRange.baseMipLevel = 0;
-    info.subresourceRange.levelCount = 1;
+    info.subresourceRange.levelCount = levelCount;
     info.subresourceRange.baseArrayLayer = 0;
     info.subresourceRange.layerCount = 1;
     
@@ -8,6 +8,7 @@ struct AllocatedImage {
     VmaAllocation allocation;
     VkExtent3D imageExtent;
     VkFormat imageFormat;
+    uint32_t mipLevels{1};
 };
 
 class GfxDevice;
@@ -20,13 +21,15 @@ void transition_image(VkCommandBuffer cmd, VkImage image, VkImageLayout currentL
 /* Upload an image to the GPU */
 void create_gpu_only_image(AllocatedImage& allocatedImage, VkImageCreateInfo imageCreateInfo, VmaAllocator allocator);
 
+/* Create the image and queue its data on the device's UploadBatcher, the contents are only valid once the batcher is flushed.
+ * If imageCreateInfo asks for more than one mip level, levels 1..N are generated with a GPU blit chain, the format must support linear blits */
 void upload_image(const void *data, int numChannels, AllocatedImage& allocatedImage, VkImageCreateInfo imageCreateInfo, const GfxDevice& gfxDevice);
 
 /* Copy one image to another */
 void copy_image_to_image(VkCommandBuffer commandBuffer, VkImage source, VkImage destination, VkExtent2D srcSize, VkExtent2D dstSize);
 
 /* Generate a sensible default image create info */
-[[nodiscard]] VkImageCreateInfo image_create_info(VkFormat format, VkExtent3D extent, VkImageUsageFlags usageFlags, VkImageType imageType);
+[[nodiscard]] VkImageCreateInfo image_create_info(VkFormat format, VkExtent3D extent, VkImageUsageFlags usageFlags, VkImageType imageType, uint32_t mipLevels = 1);
 
 /* Generate a sensible default image view create info */
-[[nodiscard]] VkImageViewCreateInfo imageview_create_info(VkImage image, VkFormat format, VkComponentMapping componentMapping, VkImageAspectFlags aspectFlags);
\ No newline at end of file
+[[nodiscard]] VkImageViewCreateInfo imageview_create_info(VkImage image, VkFormat format, VkComponentMapping componentMapping, VkImageAspectFlags aspectFlags, uint32_t levelCount = 1);
\ No newline at end of file
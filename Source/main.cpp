@@ -1,7 +1,7 @@
 #include <Rendering/Renderer.h>
 
-int main() {
-    Renderer renderer;
+int main(int argc, char* argv[]) {
+    Renderer renderer(parse_renderer_options(argc, argv));
 
     renderer.run();
 
@@ -0,0 +1,156 @@
+#include <Common/Compiler/DisableWarnings.h>
+PUSH_MSVC_WARNINGS
+DISABLE_MSVC_WARNING(4267) // conversion from 'size_t' to 'uint32_t', possible loss of data
+PUSH_CLANG_WARNINGS
+DISABLE_CLANG_WARNING("-Wmissing-field-initializers")
+DISABLE_CLANG_WARNING("-Wshorten-64-to-32")
+#include <External/tinygltf/stb_image.h>
+POP_CLANG_WARNINGS
+POP_MSVC_WARNINGS
+
+#include <Model/AssimpImport.h>
+#include <Model/CookedModel.h>
+#include <Texture/BlockCompression.h>
+#include <Texture/Ktx2.h>
+#include <Texture/MipChain.h>
+#include <Common/ThreadPool.h>
+#include <Common/Log.h>
+#include <Common/RootDir.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+/*
+ * Offline asset cooker, runs a model through Assimp once and writes the result next to it as a .mrmodel file.
+ * magic-red memory maps the cooked file at load time instead of importing the source again.
+ * Every texture the model references is also block compressed with a full mip chain into a .ktx2 file next to the model.
+ *
+ * Usage: asset-cooker [<model path> [--embedded]]
+ * With no arguments the models the renderer loads by default are cooked.
+ */
+
+struct CookJob {
+    std::filesystem::path path;
+    bool bTexturesEmbedded;
+};
+
+/*
+ * Block compressed format per texture role:
+ * - Diffuse: BC7, keeps alpha at 8 bits per texel
+ * - Normal: BC5, only X and Y are stored so Z has to be reconstructed when sampled
+ * - Metallic roughness: BC1, glTF keeps roughness in G and metallic in B which BC1 stores as is at 4 bits per texel
+ * - Emissive: BC1
+ */
+static VkFormat cooked_texture_format(CookedTextureRole role)
+{
+    switch (role)
+    {
+        case CookedTextureRole::Diffuse:
+            return VK_FORMAT_BC7_UNORM_BLOCK;
+        case CookedTextureRole::Normal:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case CookedTextureRole::MetallicRoughness:
+        case CookedTextureRole::Emissive:
+        default:
+            return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    }
+}
+
+static bool cook_texture(const std::filesystem::path& modelPath, const ImportedTexture& texture)
+{
+    const std::filesystem::path outputPath = cooked_texture_path(modelPath, texture.name);
+    const std::filesystem::path& sourcePath = texture.embeddedData.empty() ? texture.filePath : modelPath;
+    if (std::filesystem::exists(outputPath) && !is_cooked_file_stale(outputPath, sourcePath))
+    {
+        return true; // Already up to date
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    unsigned char* pixels = texture.embeddedData.empty()
+        ? stbi_load(texture.filePath.string().c_str(), &width, &height, &channels, STBI_rgb_alpha)
+        : stbi_load_from_memory(texture.embeddedData.data(), static_cast<int>(texture.embeddedData.size()), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels)
+    {
+        MRCERR("Failed to decode texture " << texture.name << ": " << stbi_failure_reason());
+        return false;
+    }
+
+    const VkFormat format = cooked_texture_format(texture.role);
+    const std::vector<MipLevel> mips = build_mip_chain_rgba8(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    std::vector<std::vector<unsigned char>> levels;
+    levels.reserve(mips.size() + 1);
+    levels.push_back(compress_rgba8(format, pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height)));
+    for (const MipLevel& mip : mips)
+    {
+        levels.push_back(compress_rgba8(format, mip.pixels.data(), mip.width, mip.height));
+    }
+    stbi_image_free(pixels);
+
+    return write_ktx2(outputPath, format, static_cast<uint32_t>(width), static_cast<uint32_t>(height), levels);
+}
+
+/* Compressing is by far the slowest part of cooking, so textures are spread across the pool */
+static bool cook_textures(ThreadPool& threadPool, const std::filesystem::path& modelPath, const ImportedModel& model)
+{
+    const auto cookStart = std::chrono::steady_clock::now();
+    std::atomic<bool> bSucceeded = true;
+    threadPool.parallel_for(model.textures.size(), [&](size_t textureIndex) {
+        if (!cook_texture(modelPath, model.textures[textureIndex]))
+        {
+            bSucceeded = false;
+        }
+    });
+    const auto cookEnd = std::chrono::steady_clock::now();
+    MRLOG("Compressed " << model.textures.size() << " textures for " << modelPath.filename().string() << " in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(cookEnd - cookStart).count() << "ms");
+    return bSucceeded;
+}
+
+static bool cook(ThreadPool& threadPool, const CookJob& job)
+{
+    const auto cookStart = std::chrono::steady_clock::now();
+    ImportedModel model;
+    if (!import_model_assimp(job.path, job.bTexturesEmbedded, model))
+    {
+        return false;
+    }
+    const std::filesystem::path outputPath = cooked_model_path(job.path);
+    if (!write_cooked_model(outputPath, job.path, model) || !cook_textures(threadPool, job.path, model))
+    {
+        return false;
+    }
+    const auto cookEnd = std::chrono::steady_clock::now();
+    MRLOG("Cooked " << job.path.string() << " -> " << outputPath.filename().string() << " (" << model.meshes.size() << " meshes, " << model.instances.size() << " instances, "
+        << model.materials.size() << " materials, " << model.textures.size() << " textures) in "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(cookEnd - cookStart).count() << "ms");
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<CookJob> jobs;
+    if (argc > 1)
+    {
+        const bool bTexturesEmbedded = argc > 2 && std::strcmp(argv[2], "--embedded") == 0;
+        jobs.push_back({argv[1], bTexturesEmbedded});
+    }
+    else
+    {
+        jobs.push_back({ROOT_DIR "/Assets/Meshes/sponza-gltf/Sponza.gltf", false});
+        jobs.push_back({ROOT_DIR "/Assets/Meshes/DamagedHelmet.glb", true});
+    }
+
+    ThreadPool threadPool;
+    bool bSucceeded = true;
+    for (const CookJob& job : jobs)
+    {
+        if (!cook(threadPool, job))
+        {
+            MRCERR("Failed to cook " << job.path.string());
+            bSucceeded = false;
+        }
+    }
+    return bSucceeded ? 0 : 1;
+}
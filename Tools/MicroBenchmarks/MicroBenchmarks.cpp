@@ -0,0 +1,544 @@
+#include <Common/Compiler/DisableWarnings.h>
+PUSH_MSVC_WARNINGS
+DISABLE_MSVC_WARNING(4267) // conversion from 'size_t' to 'uint32_t', possible loss of data
+PUSH_CLANG_WARNINGS
+DISABLE_CLANG_WARNING("-Wmissing-field-initializers")
+DISABLE_CLANG_WARNING("-Wshorten-64-to-32")
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <External/tinygltf/stb_image_write.h>
+POP_CLANG_WARNINGS
+POP_MSVC_WARNINGS
+
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <Camera/Frustum.h>
+#include <Camera/FrustumCull.h>
+#include <Common/ChunkedLinearAllocator.h>
+#include <Common/JobSystem.h>
+#include <Common/RangeAllocator.h>
+#include <Common/ThreadPool.h>
+#include <Common/Log.h>
+#include <Common/RootDir.h>
+#include <Model/AssimpImport.h>
+#include <Model/CookedModel.h>
+#include <Texture/BlockCompression.h>
+#include <Texture/MipChain.h>
+#include <Texture/TextureDecoder.h>
+#include <Vertex/VertexPacking.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * CPU micro benchmarks for magic-red-core, on synthetic data and on the engine's default assets when they are checked out.
+ * Each benchmark repeats its body until a sample has run for MIN_SAMPLE_SECONDS, the median of SAMPLE_COUNT samples is reported
+ * as a throughput (vertices/s, MB/s, objects/s, ops/s) so numbers can be tracked across builds and machines.
+ * Scheduling overhead is reported as jobs/s, 1e9 divided by it is the cost of one job in nanoseconds.
+ *
+ * Usage: micro-benchmarks [--filter <substring>] [--output <results.json>] [--pin-threads]
+ */
+
+static constexpr double MIN_SAMPLE_SECONDS = 0.25;
+static constexpr uint32_t SAMPLE_COUNT = 5;
+
+enum class BenchmarkUnit {
+    Vertices,
+    Bytes, // Reported as MB/s
+    Objects,
+    Ops,
+    Jobs
+};
+
+static const char* unit_name(BenchmarkUnit unit) {
+    switch (unit)
+    {
+        case BenchmarkUnit::Vertices:
+            return "vertices/s";
+        case BenchmarkUnit::Bytes:
+            return "MB/s";
+        case BenchmarkUnit::Objects:
+            return "objects/s";
+        case BenchmarkUnit::Jobs:
+            return "jobs/s";
+        case BenchmarkUnit::Ops:
+        default:
+            return "ops/s";
+    }
+}
+
+struct BenchmarkResult {
+    std::string name;
+    BenchmarkUnit unit;
+    double throughput; // In unit_name(unit)
+    double msPerIteration;
+    uint64_t iterations;
+};
+
+// Written to after every iteration so the work can't be optimized away
+static volatile uint64_t benchmarkSink = 0;
+
+class MicroBenchmarkRunner
+{
+public:
+    explicit MicroBenchmarkRunner(std::string _filter) : m_filter(std::move(_filter)) {}
+
+    /* iteration runs the body once and returns how many units it processed */
+    void run(const std::string& name, BenchmarkUnit unit, const std::function<uint64_t()>& iteration) {
+        if (!m_filter.empty() && name.find(m_filter) == std::string::npos)
+        {
+            return;
+        }
+        benchmarkSink = benchmarkSink + iteration(); // Warm up caches and lazily created state
+
+        std::vector<double> unitsPerSecond;
+        std::vector<double> msPerIteration;
+        uint64_t totalIterations = 0;
+        for (uint32_t sample = 0; sample < SAMPLE_COUNT; sample++)
+        {
+            uint64_t units = 0;
+            uint64_t iterations = 0;
+            const auto sampleStart = std::chrono::steady_clock::now();
+            double elapsedSeconds = 0.0;
+            do
+            {
+                units += iteration();
+                iterations++;
+                elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - sampleStart).count();
+            } while (elapsedSeconds < MIN_SAMPLE_SECONDS);
+            unitsPerSecond.push_back(static_cast<double>(units) / elapsedSeconds);
+            msPerIteration.push_back(elapsedSeconds * 1000.0 / static_cast<double>(iterations));
+            totalIterations += iterations;
+        }
+        std::sort(unitsPerSecond.begin(), unitsPerSecond.end());
+        std::sort(msPerIteration.begin(), msPerIteration.end());
+
+        BenchmarkResult result;
+        result.name = name;
+        result.unit = unit;
+        result.throughput = unitsPerSecond[SAMPLE_COUNT / 2] / (unit == BenchmarkUnit::Bytes ? 1.0e6 : 1.0);
+        result.msPerIteration = msPerIteration[SAMPLE_COUNT / 2];
+        result.iterations = totalIterations;
+        MRLOG(result.name << ": " << result.throughput << " " << unit_name(unit) << " (" << result.msPerIteration << "ms per iteration)");
+        m_results.push_back(std::move(result));
+    }
+
+    [[nodiscard]] bool write_json(const std::filesystem::path& path) const {
+        std::ofstream file(path);
+        if (!file)
+        {
+            MRWARN("Failed to open " << path.string() << " for writing");
+            return false;
+        }
+        file << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < m_results.size(); i++)
+        {
+            const BenchmarkResult& result = m_results[i];
+            file << "    {\"name\": \"" << result.name << "\", \"unit\": \"" << unit_name(result.unit) << "\", \"throughput\": " << result.throughput
+                << ", \"msPerIteration\": " << result.msPerIteration << ", \"iterations\": " << result.iterations << "}"
+                << (i + 1 == m_results.size() ? "\n" : ",\n");
+        }
+        file << "  ]\n}\n";
+        MRLOG("Results written to " << path.string());
+        return true;
+    }
+
+private:
+    std::string m_filter;
+    std::vector<BenchmarkResult> m_results;
+};
+
+/* Flat grid of gridSize x gridSize quads, written as an OBJ so it goes through the same Assimp path as real models */
+static std::filesystem::path write_synthetic_grid_obj(uint32_t gridSize) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / ("magic_red_grid_" + std::to_string(gridSize) + ".obj");
+    std::ofstream file(path);
+    for (uint32_t y = 0; y <= gridSize; y++)
+    {
+        for (uint32_t x = 0; x <= gridSize; x++)
+        {
+            const float u = static_cast<float>(x) / static_cast<float>(gridSize);
+            const float v = static_cast<float>(y) / static_cast<float>(gridSize);
+            file << "v " << u * 10.0f << " " << std::sin(u * 20.0f) * 0.25f << " " << v * 10.0f << "\n";
+            file << "vt " << u << " " << v << "\n";
+        }
+    }
+    file << "vn 0 1 0\n";
+    for (uint32_t y = 0; y < gridSize; y++)
+    {
+        for (uint32_t x = 0; x < gridSize; x++)
+        {
+            // OBJ indices are 1 based
+            const uint32_t i0 = y * (gridSize + 1) + x + 1;
+            const uint32_t i1 = i0 + 1;
+            const uint32_t i2 = i0 + gridSize + 1;
+            const uint32_t i3 = i2 + 1;
+            file << "f " << i0 << "/" << i0 << "/1 " << i2 << "/" << i2 << "/1 " << i1 << "/" << i1 << "/1\n";
+            file << "f " << i1 << "/" << i1 << "/1 " << i2 << "/" << i2 << "/1 " << i3 << "/" << i3 << "/1\n";
+        }
+    }
+    return path;
+}
+
+/* Noise over a gradient, so PNG compression has something to work with without being trivially compressible */
+static std::vector<unsigned char> make_synthetic_rgba8(uint32_t width, uint32_t height) {
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> noise(0, 31);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            unsigned char* texel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+            texel[0] = static_cast<unsigned char>((x * 255 / width + noise(random)) & 0xFF);
+            texel[1] = static_cast<unsigned char>((y * 255 / height + noise(random)) & 0xFF);
+            texel[2] = static_cast<unsigned char>(((x + y) * 127 / width) & 0xFF);
+            texel[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+static std::vector<unsigned char> encode_png(const std::vector<unsigned char>& rgba, uint32_t width, uint32_t height) {
+    std::vector<unsigned char> png;
+    stbi_write_png_to_func([](void* context, void* data, int size) {
+        std::vector<unsigned char>& output = *static_cast<std::vector<unsigned char>*>(context);
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        output.insert(output.end(), bytes, bytes + size);
+    }, &png, static_cast<int>(width), static_cast<int>(height), 4, rgba.data(), static_cast<int>(width * 4));
+    return png;
+}
+
+static uint64_t vertex_count(const ImportedModel& model) {
+    uint64_t count = 0;
+    for (const ImportedMesh& mesh : model.meshes)
+    {
+        count += mesh.vertices.size();
+    }
+    return count;
+}
+
+static void benchmark_import(MicroBenchmarkRunner& runner, const std::string& name, const std::filesystem::path& path, bool bTexturesEmbedded) {
+    if (!std::filesystem::exists(path))
+    {
+        MRWARN("Skipping " << name << ", " << path.string() << " is missing");
+        return;
+    }
+    runner.run("Import " + name, BenchmarkUnit::Vertices, [&]() -> uint64_t {
+        ImportedModel model;
+        if (!import_model_assimp(path, bTexturesEmbedded, model))
+        {
+            return 0;
+        }
+        return vertex_count(model);
+    });
+}
+
+static void benchmark_vertex_packing(MicroBenchmarkRunner& runner, const std::filesystem::path& sourcePath) {
+    ImportedModel model;
+    if (!import_model_assimp(sourcePath, false, model))
+    {
+        return;
+    }
+    std::vector<CompactVertex> packedVertices;
+    runner.run("Pack compact vertices", BenchmarkUnit::Vertices, [&]() -> uint64_t {
+        for (const ImportedMesh& mesh : model.meshes)
+        {
+            pack_compact_vertices(mesh.vertices, mesh.boundsMin, mesh.boundsMax, packedVertices);
+        }
+        return vertex_count(model);
+    });
+}
+
+static void benchmark_cooked_model(MicroBenchmarkRunner& runner, const std::filesystem::path& sourcePath) {
+    ImportedModel model;
+    if (!import_model_assimp(sourcePath, false, model))
+    {
+        return;
+    }
+    const std::filesystem::path cookedPath = std::filesystem::temp_directory_path() / "magic_red_benchmark.mrmodel";
+    if (!write_cooked_model(cookedPath, sourcePath, model))
+    {
+        return;
+    }
+    runner.run("Open cooked model and read vertices", BenchmarkUnit::Vertices, [&]() -> uint64_t {
+        CookedModelView cookedModel;
+        if (!cookedModel.open(cookedPath, sourcePath))
+        {
+            return 0;
+        }
+        uint64_t count = 0;
+        float sum = 0.0f;
+        for (const CookedMesh& mesh : cookedModel.get_meshes())
+        {
+            for (const Vertex& vertex : cookedModel.get_vertices(mesh))
+            {
+                sum += vertex.position.x + vertex.normal.y + vertex.uv_x;
+            }
+            count += cookedModel.get_vertices(mesh).size();
+        }
+        benchmarkSink = benchmarkSink + static_cast<uint64_t>(sum != 0.0f);
+        return count;
+    });
+    std::filesystem::remove(cookedPath);
+}
+
+/* Throughput is decoded RGBA8 bytes, the same measure the upload path sees */
+static void benchmark_decode(MicroBenchmarkRunner& runner, ThreadPool& threadPool, const std::string& name, std::vector<TextureDecodeRequest>& requests) {
+    if (requests.empty())
+    {
+        return;
+    }
+    runner.run(name, BenchmarkUnit::Bytes, [&]() -> uint64_t {
+        decode_textures(threadPool, requests);
+        uint64_t bytes = 0;
+        for (const TextureDecodeRequest& request : requests)
+        {
+            if (request.decoded.data)
+            {
+                bytes += static_cast<uint64_t>(request.decoded.texSize.x) * request.decoded.texSize.y * 4;
+            }
+        }
+        free_decoded_textures(requests);
+        return bytes;
+    });
+}
+
+static void benchmark_textures(MicroBenchmarkRunner& runner, ThreadPool& threadPool) {
+    constexpr uint32_t size = 1024;
+    const std::vector<unsigned char> rgba = make_synthetic_rgba8(size, size);
+    const std::vector<unsigned char> png = encode_png(rgba, size, size);
+
+    std::vector<TextureDecodeRequest> syntheticRequests(1);
+    syntheticRequests[0].textureName = "synthetic";
+    syntheticRequests[0].encodedData = png.data();
+    syntheticRequests[0].encodedSize = png.size();
+    benchmark_decode(runner, threadPool, "Decode synthetic 1024x1024 PNG", syntheticRequests);
+
+    ImportedModel sponza;
+    const std::filesystem::path sponzaPath = ROOT_DIR "/Assets/Meshes/sponza-gltf/Sponza.gltf";
+    if (std::filesystem::exists(sponzaPath) && import_model_assimp(sponzaPath, false, sponza))
+    {
+        std::vector<TextureDecodeRequest> sponzaRequests;
+        for (const ImportedTexture& texture : sponza.textures)
+        {
+            TextureDecodeRequest& request = sponzaRequests.emplace_back();
+            request.textureName = texture.name;
+            request.filePath = texture.filePath;
+        }
+        benchmark_decode(runner, threadPool, "Decode Sponza textures (parallel)", sponzaRequests);
+    }
+
+    runner.run("Build mip chain 1024x1024", BenchmarkUnit::Bytes, [&]() -> uint64_t {
+        const std::vector<MipLevel> levels = build_mip_chain_rgba8(rgba.data(), size, size);
+        benchmarkSink = benchmarkSink + levels.size();
+        return rgba.size();
+    });
+
+    constexpr uint32_t compressSize = 256;
+    const std::vector<unsigned char> compressRgba = make_synthetic_rgba8(compressSize, compressSize);
+    struct CompressFormat {
+        VkFormat format;
+        const char* name;
+    };
+    for (const CompressFormat compressFormat : {CompressFormat{VK_FORMAT_BC1_RGB_UNORM_BLOCK, "BC1"}, CompressFormat{VK_FORMAT_BC5_UNORM_BLOCK, "BC5"}, CompressFormat{VK_FORMAT_BC7_UNORM_BLOCK, "BC7"}})
+    {
+        const VkFormat format = compressFormat.format;
+        runner.run(std::string("Compress 256x256 ") + compressFormat.name, BenchmarkUnit::Bytes, [&]() -> uint64_t {
+            const std::vector<unsigned char> blocks = compress_rgba8(format, compressRgba.data(), compressSize, compressSize);
+            benchmarkSink = benchmarkSink + blocks.size();
+            return compressRgba.size();
+        });
+    }
+}
+
+static void benchmark_culling(MicroBenchmarkRunner& runner) {
+    constexpr uint32_t objectCount = 100000;
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 2.0f);
+    std::vector<glm::mat4> transforms(objectCount);
+    for (glm::mat4& transform : transforms)
+    {
+        transform = glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random), position(random)));
+    }
+    const glm::vec3 boundsMin(-size(random));
+    const glm::vec3 boundsMax(size(random));
+
+    // Looking across the middle of the field, so only part of it is inside and both the accept and reject paths run
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(1.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.0f / 9.0f, 0.1f, 200.0f);
+    const Frustum frustum = extract_frustum(projection * view);
+
+    CullBounds bounds;
+    bounds.resize(objectCount);
+    runner.run("Update cull bounds", BenchmarkUnit::Objects, [&]() -> uint64_t {
+        for (uint32_t i = 0; i < objectCount; i++)
+        {
+            bounds.set(i, transforms[i], boundsMin, boundsMax);
+        }
+        return objectCount;
+    });
+
+    std::vector<uint32_t> visibleIndices;
+    runner.run("Frustum cull", BenchmarkUnit::Objects, [&]() -> uint64_t {
+        frustum_cull(frustum, bounds, visibleIndices);
+        benchmarkSink = benchmarkSink + visibleIndices.size();
+        return objectCount;
+    });
+}
+
+static void benchmark_allocators(MicroBenchmarkRunner& runner) {
+    // Mix of what a frame pushes: scene data, light arrays and per draw data
+    constexpr uint64_t allocationSizes[] = {16, 64, 64, 256, 1024, 64, 16, 4096};
+    constexpr uint32_t allocationsPerFrame = 10000;
+    ChunkedLinearAllocator frameAllocator(4 * 1024 * 1024);
+    runner.run("Frame allocator allocate", BenchmarkUnit::Ops, [&]() -> uint64_t {
+        frameAllocator.reset();
+        uint64_t offsetSum = 0;
+        for (uint32_t i = 0; i < allocationsPerFrame; i++)
+        {
+            offsetSum += frameAllocator.allocate(allocationSizes[i % std::size(allocationSizes)], 16).offset;
+        }
+        benchmarkSink = benchmarkSink + offsetSum;
+        return allocationsPerFrame;
+    });
+
+    // Same pattern as MeshCache pages, meshes of varying size allocated then freed in a different order
+    constexpr uint32_t rangeCount = 1000;
+    std::vector<uint32_t> rangeSizes(rangeCount);
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<uint32_t> rangeSize(64, 16384);
+    for (uint32_t& count : rangeSizes)
+    {
+        count = rangeSize(random);
+    }
+    std::vector<uint32_t> freeOrder(rangeCount);
+    for (uint32_t i = 0; i < rangeCount; i++)
+    {
+        freeOrder[i] = i;
+    }
+    std::shuffle(freeOrder.begin(), freeOrder.end(), random);
+    std::vector<uint32_t> offsets(rangeCount);
+    runner.run("Range allocator allocate and free", BenchmarkUnit::Ops, [&]() -> uint64_t {
+        RangeAllocator rangeAllocator(rangeCount * 16384);
+        for (uint32_t i = 0; i < rangeCount; i++)
+        {
+            offsets[i] = rangeAllocator.allocate(rangeSizes[i]).value_or(0);
+        }
+        for (const uint32_t i : freeOrder)
+        {
+            rangeAllocator.free(offsets[i], rangeSizes[i]);
+        }
+        return rangeCount * 2;
+    });
+}
+
+static void benchmark_jobs(MicroBenchmarkRunner& runner, JobSystem& jobSystem, ThreadPool& threadPool) {
+    // Empty jobs, so only the cost of creating, queueing, stealing and retiring them is left
+    constexpr uint32_t jobCount = 1000;
+    runner.run("Job system empty jobs", BenchmarkUnit::Jobs, [&]() -> uint64_t {
+        JobCounter counter;
+        for (uint32_t i = 0; i < jobCount; i++)
+        {
+            jobSystem.run([]() {}, &counter);
+        }
+        jobSystem.wait(counter);
+        return jobCount;
+    });
+
+    // Each batch starts once the previous one is done, the cost of resolving dependencies on top of the above
+    constexpr uint32_t batchCount = 100;
+    constexpr uint32_t jobsPerBatch = 10;
+    runner.run("Job system dependent batches", BenchmarkUnit::Jobs, [&]() -> uint64_t {
+        std::vector<JobCounter> counters(batchCount);
+        for (uint32_t i = 0; i < jobsPerBatch; i++)
+        {
+            jobSystem.run([]() {}, &counters[0]);
+        }
+        for (uint32_t batch = 1; batch < batchCount; batch++)
+        {
+            for (uint32_t i = 0; i < jobsPerBatch; i++)
+            {
+                jobSystem.run_after(counters[batch - 1], []() {}, &counters[batch]);
+            }
+        }
+        // Every counter, not just the last, a batch's final job can still be releasing its continuations after the next batch finished
+        for (const JobCounter& counter : counters)
+        {
+            jobSystem.wait(counter);
+        }
+        return batchCount * jobsPerBatch;
+    });
+
+    // Fine grained loop, compared against the shared queue ThreadPool which hands out one index at a time
+    constexpr size_t elementCount = 1 << 20;
+    std::vector<float> values(elementCount, 1.0f);
+    runner.run("Job system parallel_for", BenchmarkUnit::Ops, [&]() -> uint64_t {
+        jobSystem.parallel_for(elementCount, [&values](size_t i) { values[i] = values[i] * 0.5f + 1.0f; });
+        return elementCount;
+    });
+    runner.run("ThreadPool parallel_for", BenchmarkUnit::Ops, [&]() -> uint64_t {
+        threadPool.parallel_for(elementCount, [&values](size_t i) { values[i] = values[i] * 0.5f + 1.0f; });
+        return elementCount;
+    });
+    benchmarkSink = benchmarkSink + static_cast<uint64_t>(values[0]);
+}
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    std::filesystem::path outputPath;
+    bool bPinThreads = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--pin-threads") == 0)
+        {
+            bPinThreads = true;
+        }
+        else
+        {
+            MRCERR("Usage: micro-benchmarks [--filter <substring>] [--output <results.json>] [--pin-threads]");
+            return 1;
+        }
+    }
+
+    MicroBenchmarkRunner runner(filter);
+    ThreadPool threadPool;
+    JobSystem jobSystem(std::max(std::thread::hardware_concurrency(), 2u) - 1, bPinThreads);
+
+    const std::filesystem::path gridPath = write_synthetic_grid_obj(256);
+    benchmark_import(runner, "synthetic 256x256 grid", gridPath, false);
+    benchmark_import(runner, "Sponza", ROOT_DIR "/Assets/Meshes/sponza-gltf/Sponza.gltf", false);
+    benchmark_import(runner, "DamagedHelmet", ROOT_DIR "/Assets/Meshes/DamagedHelmet.glb", true);
+    benchmark_cooked_model(runner, gridPath);
+    benchmark_vertex_packing(runner, gridPath);
+    std::filesystem::remove(gridPath);
+
+    benchmark_textures(runner, threadPool);
+    benchmark_culling(runner);
+    benchmark_allocators(runner);
+    benchmark_jobs(runner, jobSystem, threadPool);
+
+    if (!outputPath.empty() && !runner.write_json(outputPath))
+    {
+        return 1;
+    }
+    return 0;
+}